@@ -0,0 +1,342 @@
+/**
+ * @file   AttributeStore.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "AttributeStore.hpp"
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+#include "UUIDMapper.hpp"
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+namespace {
+
+struct AttributeRegistry
+{
+	std::vector<AttributeInfo> attributes;
+	std::unordered_map<std::string, int> slotsByPath;
+	// first components of the interned paths
+	std::vector<std::string> roots;
+};
+
+// function-local static so that file-static Attribute<T> instances
+// in other translation units may intern during static initialization
+AttributeRegistry &registry()
+{
+	static AttributeRegistry result;
+	return result;
+}
+
+pt::ptree::path_type attributePath(const std::string &path)
+{
+	return pt::ptree::path_type(path, '.');
+}
+
+struct PutAttribute: public boost::static_visitor<>
+{
+	pt::ptree &tree;
+	const pt::ptree::path_type &path;
+
+	PutAttribute(pt::ptree &tree, const pt::ptree::path_type &path)
+	: tree(tree)
+	, path(path)
+	{ }
+
+	void operator()(const boost::blank &) const { }
+
+	template <typename T>
+	void operator()(const T &value) const
+	{
+		tree.put(path, value);
+	}
+};
+
+struct PutAttributeValue: public boost::static_visitor<>
+{
+	pt::ptree &node;
+
+	PutAttributeValue(pt::ptree &node)
+	: node(node)
+	{ }
+
+	void operator()(const boost::blank &) const { }
+
+	template <typename T>
+	void operator()(const T &value) const
+	{
+		node.put_value(value);
+	}
+};
+
+/**
+ * Erases the first node at path (matching the lookup semantics of
+ * ptree::get_child()) and prunes any parents left empty by the removal.
+ */
+bool erasePath(pt::ptree &tree, const std::string &path)
+{
+	auto sep = path.find('.');
+	auto head = path.substr(0, sep);
+	auto it = tree.find(head);
+	if(it == tree.not_found())
+	{
+		return false;
+	}
+
+	auto child = tree.to_iterator(it);
+	if(sep == std::string::npos)
+	{
+		tree.erase(child);
+		return true;
+	}
+
+	if(!erasePath(child->second, path.substr(sep + 1)))
+	{
+		return false;
+	}
+
+	if(child->second.empty() && child->second.data().empty())
+	{
+		tree.erase(child);
+	}
+
+	return true;
+}
+
+}  // anonymous namespace
+
+int internAttribute(const std::string &path, AttributeParser parse)
+{
+	auto &reg = registry();
+	auto it = reg.slotsByPath.find(path);
+	if(it != reg.slotsByPath.end())
+	{
+		return it->second;
+	}
+
+	int slot = reg.attributes.size();
+	reg.attributes.push_back(AttributeInfo{path, parse});
+	reg.slotsByPath[path] = slot;
+
+	auto root = path.substr(0, path.find('.'));
+	if(std::find(reg.roots.begin(), reg.roots.end(), root) == reg.roots.end())
+	{
+		reg.roots.push_back(root);
+	}
+	return slot;
+}
+
+bool isAttributeRoot(const char *key, std::size_t size)
+{
+	for(const auto &root : registry().roots)
+	{
+		if(root.size() == size && std::memcmp(root.data(), key, size) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int findAttribute(const std::string &path)
+{
+	auto &reg = registry();
+	auto it = reg.slotsByPath.find(path);
+	return it == reg.slotsByPath.end()? -1 : it->second;
+}
+
+const AttributeInfo &attributeInfo(int slot)
+{
+	assert(slot >= 0 && slot < int(registry().attributes.size()));
+	return registry().attributes[slot];
+}
+
+KeyOrder keyOrder(const pt::ptree &node)
+{
+	KeyOrder result;
+	result.reserve(node.size());
+	for(const auto &child : node)
+	{
+		result.push_back(child.first);
+	}
+	return result;
+}
+
+void restoreKeyOrder(pt::ptree &node, const KeyOrder &order)
+{
+	pt::ptree rest;
+	rest.swap(node);
+	node.data().swap(rest.data());
+	for(const auto &key : order)
+	{
+		auto it = rest.find(key);
+		if(it != rest.not_found())
+		{
+			// moved by swapping, so no subtree is copied
+			auto restIt = rest.to_iterator(it);
+			node.push_back(pt::ptree::value_type(key, pt::ptree()))->second.swap(restIt->second);
+			rest.erase(restIt);
+		}
+	}
+	for(auto &child : rest)
+	{
+		node.push_back(pt::ptree::value_type(child.first, pt::ptree()))->second.swap(child.second);
+	}
+}
+
+namespace detail {
+
+void putAttributeValue(pt::ptree &node, const AttributeValue &value)
+{
+	boost::apply_visitor(PutAttributeValue(node), value);
+}
+
+void warnUnconvertible(int slot, const pt::ptree &node)
+{
+	DBWarning("Cannot set attribute ", attributeInfo(slot).path, " to '", node.data(), "'");
+}
+
+}  // namespace detail
+
+const AttributeValue &AttributeStore::at(int slot) const
+{
+	static const AttributeValue Empty;
+	return slot >= 0 && slot < int(_values.size())? _values[slot] : Empty;
+}
+
+bool AttributeStore::set(int slot, const AttributeValue &value)
+{
+	assert(slot >= 0);
+	if(slot >= int(_values.size()))
+	{
+		_values.resize(slot + 1);
+	}
+	else if(_values[slot] == value)
+	{
+		return false;
+	}
+
+	_values[slot] = value;
+	return true;
+}
+
+bool AttributeStore::remove(int slot)
+{
+	if(contains(slot))
+	{
+		_values[slot] = boost::blank();
+		return true;
+	}
+
+	return false;
+}
+
+void AttributeStore::load(const std::vector<int> &attributeSlots, pt::ptree &tree)
+{
+	std::vector<int> loaded;
+	for(int slot : attributeSlots)
+	{
+		const auto &info = attributeInfo(slot);
+		auto node = tree.get_child_optional(attributePath(info.path));
+
+		// leave subtrees where the kind expects a value alone
+		if(!node || !node->empty()) continue;
+
+		if(auto value = info.parse(*node))
+		{
+			set(slot, *value);
+			loaded.push_back(slot);
+		}
+		else
+		{
+			DBWarning("Cannot read attribute ", info.path, " from '", node->data(), "'");
+		}
+	}
+
+	if(loaded.empty())
+	{
+		return;
+	}
+
+	// the keys of each node above an attribute, taken before any is erased,
+	// so that save() can put the attributes back where they were
+	auto order = std::make_shared<std::vector<NodeOrder>>();
+	auto record = [&](const std::string &path) {
+		for(const auto &existing : *order)
+		{
+			if(existing.path == path) return;
+		}
+		const pt::ptree &node = path.empty()? tree : tree.get_child(attributePath(path));
+		order->push_back(NodeOrder{path, keyOrder(node)});
+	};
+	for(int slot : loaded)
+	{
+		const auto &path = attributeInfo(slot).path;
+		record(std::string());
+		for(auto sep = path.find('.'); sep != std::string::npos; sep = path.find('.', sep + 1))
+		{
+			record(path.substr(0, sep));
+		}
+	}
+	_order = order;
+
+	for(int slot : loaded)
+	{
+		erasePath(tree, attributeInfo(slot).path);
+	}
+}
+
+void AttributeStore::save(pt::ptree &tree) const
+{
+	for(int slot = 0; slot < int(_values.size()); ++slot)
+	{
+		if(_values[slot].which() != 0)
+		{
+			auto path = attributePath(attributeInfo(slot).path);
+			boost::apply_visitor(PutAttribute(tree, path), _values[slot]);
+		}
+	}
+
+	if(_order)
+	{
+		for(const auto &node : *_order)
+		{
+			if(node.path.empty())
+			{
+				restoreKeyOrder(tree, node.keys);
+			}
+			else if(auto child = tree.get_child_optional(attributePath(node.path)))
+			{
+				restoreKeyOrder(*child, node.keys);
+			}
+		}
+	}
+}
+
+void AttributeStore::mapUUIDs(UUIDMapper *mapper)
+{
+	for(auto &value : _values)
+	{
+		if(auto uuid = boost::get<QUuid>(&value))
+		{
+			value = mapper->map(*uuid);
+		}
+	}
+}
+
+bool AttributeStore::operator ==(const AttributeStore &other) const
+{
+	auto n = std::max(_values.size(), other._values.size());
+	for(size_t slot = 0; slot < n; ++slot)
+	{
+		if(!(at(slot) == other.at(slot))) return false;
+	}
+
+	return true;
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,238 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <sstream>
+#include <QString>
+#include <QUuid>
+#include <boost/variant.hpp>
+#include <boost/optional.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include "Util/UUIDTranslator.hpp"
+#include "Util/Translators.hpp"
+#include "CoreForward.hpp"
+/**
+ * @file   AttributeStore.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+namespace dbuilder {
+
+namespace pt = boost::property_tree;
+
+typedef boost::variant<boost::blank, bool, int, double, std::string, QString, QUuid> AttributeValue;
+
+typedef boost::optional<AttributeValue> (*AttributeParser)(const pt::ptree &);
+
+struct AttributeInfo
+{
+	std::string path;        /**< dotted path of the attribute within extraData */
+	AttributeParser parse;   /**< converts a ptree node to the declared type */
+};
+
+/**
+ * Interns an attribute path. Interning the same path more than once
+ * yields the same slot.
+ *
+ * @return the slot of the attribute
+ */
+int internAttribute(const std::string &path, AttributeParser parse);
+
+/**
+ * @return the slot of an interned path, or -1 if the path was never interned
+ */
+int findAttribute(const std::string &path);
+
+const AttributeInfo &attributeInfo(int slot);
+
+/**
+ * @return true if key is the first component of an interned path.
+ * Attributes are interned during static initialization, so this may be
+ * called from any thread once main() has started.
+ */
+bool isAttributeRoot(const char *key, std::size_t size);
+
+typedef std::vector<std::string> KeyOrder;
+
+/**
+ * @return the keys of the children of node, in order
+ */
+KeyOrder keyOrder(const pt::ptree &node);
+
+/**
+ * Reorders the children of node to follow order. Children whose keys are
+ * not in order keep their relative order after the rest.
+ */
+void restoreKeyOrder(pt::ptree &node, const KeyOrder &order);
+
+template <typename T>
+boost::optional<AttributeValue> parseAttribute(const pt::ptree &node)
+{
+	if(auto value = node.get_value_optional<T>())
+	{
+		return AttributeValue(*value);
+	}
+	else
+	{
+		return {};
+	}
+}
+
+/**
+ * A typed handle to an interned attribute slot. Components declare these
+ * once (usually as file statics) and register them with their kind.
+ */
+template <typename T>
+class Attribute
+{
+	int _slot;
+	T _defaultValue;
+public:
+	typedef T value_type;
+
+	Attribute(const char *path, const T &defaultValue=T())
+	: _slot(internAttribute(path, &parseAttribute<T>))
+	, _defaultValue(defaultValue)
+	{ }
+
+	int slot() const { return _slot; }
+	const T &defaultValue() const { return _defaultValue; }
+	const std::string &path() const { return attributeInfo(_slot).path; }
+};
+
+namespace detail {
+
+template <typename T>
+struct AttributeAs: public boost::static_visitor<boost::optional<T>>
+{
+	boost::optional<T> operator()(const T &value) const
+	{
+		return value;
+	}
+
+	template <typename U>
+	boost::optional<T> operator()(const U &) const
+	{
+		return {};
+	}
+};
+
+void putAttributeValue(pt::ptree &node, const AttributeValue &value);
+void warnUnconvertible(int slot, const pt::ptree &node);
+
+}  // namespace detail
+
+/**
+ * Slot-indexed storage for the attributes of a single DiagramItemModel.
+ *
+ * Values are kept in their declared types, so typed reads are a vector
+ * index and a type check. A ptree is only produced on save.
+ */
+class AttributeStore
+{
+	struct NodeOrder
+	{
+		std::string path;
+		KeyOrder keys;
+	};
+
+	std::vector<AttributeValue> _values;
+	// the order of the nodes that held attributes when they were loaded
+	std::shared_ptr<const std::vector<NodeOrder>> _order;
+public:
+	bool contains(int slot) const
+	{
+		return slot >= 0 && slot < int(_values.size()) && _values[slot].which() != 0;
+	}
+
+	template <typename T>
+	const T *find(int slot) const
+	{
+		return slot >= 0 && slot < int(_values.size())? boost::get<T>(&_values[slot]) : nullptr;
+	}
+
+	template <typename T>
+	const T &value(const Attribute<T> &attr) const
+	{
+		auto result = find<T>(attr.slot());
+		return result? *result : attr.defaultValue();
+	}
+
+	/**
+	 * Reads a slot as an arbitrary type, converting through the ptree
+	 * translators when the stored type does not match.
+	 */
+	template <typename T>
+	boost::optional<T> get(int slot) const
+	{
+		if(!contains(slot)) return {};
+
+		if(auto result = boost::apply_visitor(detail::AttributeAs<T>(), _values[slot]))
+		{
+			return result;
+		}
+
+		pt::ptree node;
+		detail::putAttributeValue(node, _values[slot]);
+		return node.get_value_optional<T>();
+	}
+
+	const AttributeValue &at(int slot) const;
+
+	/**
+	 * @return true if the stored value changed
+	 */
+	bool set(int slot, const AttributeValue &value);
+
+	/**
+	 * Converts the value to the declared type of the slot before storing it.
+	 * A value that does not convert is logged and leaves the slot as it was.
+	 *
+	 * @return true if the stored value changed
+	 */
+	template <typename T>
+	bool convertAndSet(int slot, T &&value)
+	{
+		pt::ptree node;
+		node.put_value(std::forward<T>(value));
+		if(auto parsed = attributeInfo(slot).parse(node))
+		{
+			return set(slot, *parsed);
+		}
+		else
+		{
+			detail::warnUnconvertible(slot, node);
+			return false;
+		}
+	}
+
+	bool remove(int slot);
+	void clear() { _values.clear(); _order.reset(); }
+
+	/**
+	 * Moves the given slots out of a freshly loaded extraData tree,
+	 * remembering the order of the nodes they were in.
+	 */
+	void load(const std::vector<int> &attributeSlots, pt::ptree &tree);
+
+	/**
+	 * Writes all present attributes into tree at their paths, in the order
+	 * they were loaded in.
+	 */
+	void save(pt::ptree &tree) const;
+
+	/**
+	 * @return true if save() reorders what it writes into, so attributes
+	 * cannot simply be written after the rest of extraData
+	 */
+	bool keepsOrder() const { return bool(_order); }
+
+	void mapUUIDs(UUIDMapper *mapper);
+
+	bool operator ==(const AttributeStore &other) const;
+	bool operator !=(const AttributeStore &other) const { return !(*this == other); }
+};
+
+}  // namespace dbuilder
@@ -9,6 +9,7 @@
 #include "UUIDMapper.hpp"
 #include "DiagramItemModel.hpp"
 #include "DiagramComponent.hpp"
+#include "DiagramIO/CompressedStream.hpp"
 
 
 /**
@@ -24,10 +25,15 @@ namespace dbuilder {
 void copyToClipboard(DiagramLoader *loader, const QList<DiagramItem *> &items)
 {
 	std::stringstream itemStream;
-	loader->save(itemStream, items);
+	{
+		CompressingStreamBuf compressor(itemStream);
+		std::ostream os(&compressor);
+		loader->save(os, items);
+	}
+	const auto payload = itemStream.str();
 
 	auto mimeData = new QMimeData;
-	mimeData->setData("application/vnd.saroth.dbuilder.document", itemStream.str().c_str());
+	mimeData->setData("application/vnd.saroth.dbuilder.document", QByteArray(payload.data(), payload.size()));
 
 	QApplication::clipboard()->setMimeData(mimeData);
 }
@@ -37,6 +43,11 @@ QList<DiagramItem *> pasteFromClipboard(DiagramLoader *loader, DiagramScene *sce
 	auto mimeData = QApplication::clipboard()->mimeData();
 	auto data = mimeData->data("application/vnd.saroth.dbuilder.document");
 	if(data.isNull()) return {};
+	// older versions put the document in as it is
+	if(compressed::detect(data.constData(), data.size()))
+	{
+		data = compressed::decompress(data.constData(), data.size());
+	}
 
 	std::stringstream itemStream(std::string(data.begin(), data.end()));
 	QObject parent;
@@ -0,0 +1,34 @@
+/**
+ * @file   DropDependencyCommand.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DropDependencyCommand.hpp"
+#include "DiagramScene.hpp"
+
+namespace dbuilder {
+DropDependencyCommand::DropDependencyCommand(DiagramScene *scene, DiagramItem *item,
+		const QUuid &dependency, QUndoCommand *parent)
+: QUndoCommand("drop dependency", parent)
+, _scene(scene)
+, _item(item)
+, _dependency(dependency)
+{
+}
+
+void DropDependencyCommand::undo()
+{
+	_scene->addDependency(_item, _dependency);
+}
+
+void DropDependencyCommand::redo()
+{
+	_scene->removeDependency(_item, _dependency);
+}
+
+DropDependencyCommand::~DropDependencyCommand()
+{
+}
+} // namespace dbuilder
@@ -0,0 +1,31 @@
+#pragma once
+/**
+ * @file   DropDependencyCommand.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <qundostack.h>
+#include <QUuid>
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+/**
+ * Removes one dependency of an item, for references that a document
+ * check found to be broken.
+ */
+class DropDependencyCommand: public QUndoCommand
+{
+	DiagramScene *_scene;
+	DiagramItem *_item;
+	QUuid _dependency;
+public:
+	DropDependencyCommand(DiagramScene *scene, DiagramItem *item, const QUuid &dependency, QUndoCommand *parent=nullptr);
+
+	void undo();
+	void redo();
+
+	virtual ~DropDependencyCommand();
+};
+} // namespace dbuilder
@@ -0,0 +1,152 @@
+/**
+ * @file   ComponentRegistry.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_ComponentRegistry.cpp"
+#include "DiagramComponent.hpp"
+#include "Util/Log.hpp"
+#include <QMap>
+
+
+namespace dbuilder {
+
+
+
+
+DP_DEFINE(ComponentRegistry)
+{
+	QMap<QString, DiagramComponent *> kinds;
+	QMap<QString, KindFactory> factories;
+};
+
+ComponentRegistry::ComponentRegistry(QObject *parent)
+: QObject(parent)
+, DP_INIT
+{
+
+}
+
+void ComponentRegistry::registerKind(DiagramComponent* kind)
+{
+	if(dat->kinds.count(kind->name()) || dat->factories.count(kind->name()))
+	{
+		throw KindAlreadyExistsException();
+	}
+
+	kind->setParent(this);
+	dat->kinds[kind->name()] = kind;
+}
+
+void ComponentRegistry::registerKindFactory(const QString &name, const KindFactory &factory)
+{
+	if(dat->kinds.count(name) || dat->factories.count(name))
+	{
+		throw KindAlreadyExistsException();
+	}
+
+	dat->factories[name] = factory;
+}
+
+bool ComponentRegistry::provideKind(DiagramComponent *kind)
+{
+	if(!dat->factories.remove(kind->name()))
+	{
+		return false;
+	}
+
+	kind->setParent(this);
+	dat->kinds[kind->name()] = kind;
+	return true;
+}
+
+DiagramComponent* ComponentRegistry::kind(const QString& name) const
+{
+	auto it = dat->kinds.find(name);
+	if(it != dat->kinds.end())
+	{
+		return it.value();
+	}
+
+	auto factory = dat->factories.find(name);
+	if(factory == dat->factories.end())
+	{
+		throw KindDoesNotExistException(("the type of diagram item " + name + " does not exist").toStdString());
+	}
+
+	DBDebug("Loading kind ", name);
+	auto create = factory.value();
+	dat->factories.erase(factory);
+
+	DiagramComponent *result = nullptr;
+	try
+	{
+		result = create();
+	}
+	catch(...)
+	{
+		dat->factories[name] = create;
+		throw;
+	}
+
+	if(!result || result->name() != name)
+	{
+		delete result;
+		dat->factories[name] = create;
+		throw KindDoesNotExistException(("the type of diagram item " + name + " could not be loaded").toStdString());
+	}
+
+	// creating a kind does not change what the registry offers
+	result->setParent(const_cast<ComponentRegistry *>(this));
+	dat->kinds[name] = result;
+	return result;
+}
+
+DiagramComponent *ComponentRegistry::findKind(const QString &name) const
+{
+	try
+	{
+		return kind(name);
+	}
+	catch(const std::exception &exc)
+	{
+		if(dat->factories.count(name))
+		{
+			DBError("Cannot load kind ", name, ": ", exc.what());
+		}
+		return nullptr;
+	}
+}
+
+const QMap<QString, DiagramComponent *> &ComponentRegistry::kinds() const
+{
+	// findKind() removes each factory it runs, so iterate over a copy
+	for(const auto &name : dat->factories.keys())
+	{
+		findKind(name);
+	}
+	return dat->kinds;
+}
+
+const QMap<QString, DiagramComponent *> &ComponentRegistry::createdKinds() const
+{
+	return dat->kinds;
+}
+
+QStringList ComponentRegistry::kindNames() const
+{
+	QStringList result = dat->kinds.keys();
+	result << dat->factories.keys();
+	result.sort();
+	return result;
+}
+
+ComponentRegistry::~ComponentRegistry()
+{
+}
+
+
+
+}  // namespace dbuilder
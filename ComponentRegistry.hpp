@@ -0,0 +1,88 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QMap>
+#include <QStringList>
+#include <functional>
+#include "DataPtr.hpp"
+#include "Exceptions.hpp"
+#include "CoreForward.hpp"
+
+/**
+ * @file   ComponentRegistry.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+
+namespace dbuilder {
+
+
+
+DBDefineException(KindAlreadyExistsException, "the kind of diagram item already exists");
+DBDefineException(KindDoesNotExistException, "the kind of diagram item does not exist");
+
+/**
+ * The kinds of diagram item for one library configuration.
+ *
+ * Application builds one and shares it with every DiagramContext it makes
+ * until the libraries change; each context holds a reference. Once built it
+ * is not changed, except that a kind registered with a factory is created,
+ * once, the first time it is used. kindNames() never changes.
+ *
+ * GUI thread only.
+ */
+class ComponentRegistry: public QObject
+{
+	Q_OBJECT
+	DP_DECLARE(ComponentRegistry);
+public:
+	/// Creates a kind the first time it is needed. The result is registered.
+	typedef std::function<DiagramComponent *()> KindFactory;
+
+	ComponentRegistry(QObject *parent=nullptr);
+
+	/**
+	 * @throws KindAlreadyExistsException
+	 */
+	void registerKind(DiagramComponent *kind);
+	/**
+	 * Registers a kind named name without creating it yet.
+	 *
+	 * @throws KindAlreadyExistsException
+	 */
+	void registerKindFactory(const QString &name, const KindFactory &factory);
+	/**
+	 * Registers kind, made ahead of time, in place of the factory for its
+	 * name.
+	 *
+	 * @return false if the name has no factory, because the kind was
+	 * already created or was never registered; kind is left to the caller
+	 */
+	bool provideKind(DiagramComponent *kind);
+
+	/**
+	 * @throws KindDoesNotExistException if name is not registered or its
+	 * factory fails
+	 */
+	DiagramComponent *kind(const QString &name) const;
+	/// @return the kind, or nullptr if it is not registered or cannot be created
+	DiagramComponent *findKind(const QString &name) const;
+	/**
+	 * @return all registered kinds, creating those not created yet; kinds
+	 * whose factories fail are logged and left out
+	 */
+	const QMap<QString, DiagramComponent *> &kinds() const;
+	/// @return the kinds created so far, without creating any
+	const QMap<QString, DiagramComponent *> &createdKinds() const;
+	/// @return the names of all registered kinds, created or not, sorted
+	QStringList kindNames() const;
+
+	virtual ~ComponentRegistry();
+};
+
+
+
+}  // namespace dbuilder
+
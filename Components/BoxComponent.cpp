@@ -429,6 +429,13 @@ void BoxComponent::configure(DiagramItem *item) const
 	item->setFlag(QGraphicsItem::ItemIsMovable);
 }
 
+boost::optional<int> BoxComponent::portCount(const pt::ptree &extraData) const
+{
+	// one port per child of "ports", as BoxKindItem::updateView() reads them
+	auto portsTree = extraData.get_child_optional("ports");
+	return portsTree? int(portsTree->size()) : 0;
+}
+
 BoxComponent::~BoxComponent()
 {
 }
@@ -17,6 +17,7 @@ class BoxComponent: public DiagramComponent
 public:
 	BoxComponent(QObject *parent=nullptr);
 	void configure(DiagramItem *) const;
+	boost::optional<int> portCount(const boost::property_tree::ptree &extraData) const;
 	virtual ~BoxComponent();
 
 	PropertyWidget *makePropertyWidget(QWidget *parent=nullptr) const;
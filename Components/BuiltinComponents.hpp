@@ -0,0 +1,62 @@
+#pragma once
+/**
+ * @file   BuiltinComponents.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QString>
+#include <QList>
+#include <QPointF>
+#include "DiagramIO/ComponentFile.hpp"
+
+namespace dbuilder {
+
+struct BuiltinPort
+{
+	double x, y;
+};
+
+/**
+ * A component of components.info, with what it extends already merged in.
+ * Exactly one of svgFile and svgData is set.
+ */
+struct BuiltinComponent
+{
+	const char *name;
+	const char *svgFile;
+	const char *svgData;
+	const BuiltinPort *ports;
+	int portCount;
+};
+
+/**
+ * The components of components.info, in file order. Generated at build time
+ * by Tools/CompileComponents.cpp; constant-initialized, so reading them
+ * costs nothing at startup.
+ */
+extern const BuiltinComponent BuiltinComponents[];
+extern const int BuiltinComponentCount;
+
+inline ComponentSpec builtinComponentSpec(const BuiltinComponent &builtin)
+{
+	ComponentSpec result;
+	result.name = QString::fromUtf8(builtin.name);
+	if(builtin.svgFile)
+	{
+		result.svgFile = QString::fromUtf8(builtin.svgFile);
+	}
+	else
+	{
+		result.svgData = QString::fromUtf8(builtin.svgData);
+	}
+
+	for(int i = 0; i < builtin.portCount; ++i)
+	{
+		result.ports << QPointF(builtin.ports[i].x, builtin.ports[i].y);
+	}
+	return result;
+}
+
+}  // namespace dbuilder
@@ -33,11 +33,11 @@
 
 namespace dbuilder {
 
-static const char *LineThicknessKey = "connector.style.lineThickness";
-static const char *ConnectorTypeKey = "connector.type";
-static const char *BusWidthKey      = "connector.busWidth";
-static const char *ArrowheadsKey    = "connector.arrowheads";
-static const char *StrokeColorKey   = "connector.style.strokeColor";
+static const Attribute<int>     LineThickness("connector.style.lineThickness", 1);
+static const Attribute<QString> ConnectorType("connector.type", "polyline");
+static const Attribute<int>     BusWidth("connector.busWidth", 1);
+static const Attribute<int>     Arrowheads("connector.arrowheads", 0);
+static const Attribute<QString> StrokeColor("connector.style.strokeColor", "#000");
 
 
 template <typename T>
@@ -72,6 +72,9 @@ class ConnectionGraphicsItem: public QObject, public QGraphicsPathItem
 
 	int _arrowhead;
 
+	// endpoint handles resolved on the last update
+	ItemHandle srcHandle, dstHandle;
+
 	Q_PROPERTY(bool leftArrow READ leftArrow WRITE setLeftArrow)
 	Q_PROPERTY(bool rightArrow READ rightArrow WRITE setRightArrow)
 	Q_PROPERTY(int busWidth READ busWidth WRITE setBusWidth)
@@ -90,6 +93,8 @@ public:
 	, rightArrowhead(nullptr)
 	, mode(PolylineMode)
 	, _arrowhead(NoArrowhead)
+	, srcHandle(InvalidItemHandle)
+	, dstHandle(InvalidItemHandle)
 	{
 		item->addExtension(this);
 
@@ -115,13 +120,13 @@ public:
 	void setArrowhead(int arrowhead)
 	{
 		DBDebug("Arrowheads set: ", std::hex, arrowhead);
-		item->model()->setData(ArrowheadsKey, arrowhead);
+		item->model()->setAttribute(Arrowheads, arrowhead);
 		updateLineType();
 	}
 
 	void setColor(QColor c)
 	{
-		item->model()->setData(StrokeColorKey, c.name());
+		item->model()->setAttribute(StrokeColor, c.name());
 		updateLineType();
 	}
 
@@ -132,18 +137,18 @@ public:
 public slots:
 	void setBusWidth(int w)
 	{
-		item->model()->setData(BusWidthKey, w);
+		item->model()->setAttribute(BusWidth, w);
 		updateLineType();
 	}
 
 	int busWidth() const
 	{
-		return item->model()->getData<int>(BusWidthKey).get_value_or(1);
+		return item->model()->attribute(BusWidth);
 	}
 
 	int lineThickness() const
 	{
-		return item->model()->getData<int>(LineThicknessKey).get_value_or(1);
+		return item->model()->attribute(LineThickness);
 	}
 
 	bool leftArrow() const
@@ -168,18 +173,18 @@ public slots:
 
 	void setLineThickness(int t)
 	{
-		item->model()->setData(LineThicknessKey, t);
+		item->model()->setAttribute(LineThickness, t);
 		updateLineType();
 	}
 
 	QString connectorType() const
 	{
-		return item->model()->getData<QString>(ConnectorTypeKey).get_value_or("polyline");
+		return item->model()->attribute(ConnectorType);
 	}
 
 	void setConnectorType(const QString &t)
 	{
-		item->model()->setData(ConnectorTypeKey, t);
+		item->model()->setAttribute(ConnectorType, t);
 		updateLineType();
 	}
 private slots:
@@ -187,7 +192,7 @@ private slots:
 	void showBusMenu()
 	{
 		QList<QAction *> pointers;
-		const int currentValue = item->model()->getData<int>(BusWidthKey).get_value_or(1);
+		const int currentValue = item->model()->attribute(BusWidth);
 		for(int i = 1; i <= 32; ++i)
 		{
 			auto iVariant = QVariant::fromValue(i);
@@ -204,7 +209,7 @@ private slots:
 
 		if(result)
 		{
-			item->model()->setData(BusWidthKey, result->data().toInt());
+			item->model()->setAttribute(BusWidth, result->data().toInt());
 			updateLineType();
 		}
 		qDeleteAll(pointers);
@@ -221,8 +226,7 @@ private slots:
 		actions[1] = &normal;
 		actions[3] = &thick;
 
-		auto lineThickness = item->model()->getData<int>(LineThicknessKey)
-		    .get_value_or(1);
+		auto lineThickness = item->model()->attribute(LineThickness);
 		if(actions.contains(lineThickness))
 		{
 			auto active = actions[lineThickness];
@@ -233,20 +237,20 @@ private slots:
 		auto actionSelected = QMenu::exec(actions.values(), QCursor::pos());
 
 		if(actionSelected)
-			item->model()->setData(LineThicknessKey,
-			                       actions.key(actionSelected));
+			item->model()->setAttribute(LineThickness,
+			                            actions.key(actionSelected));
 		updateLineType();
 	}
 
 	void setPolyline()
 	{
-		item->model()->setData(ConnectorTypeKey, "polyline");
+		item->model()->setAttribute(ConnectorType, "polyline");
 		updateLineType();
 	}
 
 	void setLine()
 	{
-		item->model()->setData(ConnectorTypeKey, "line");
+		item->model()->setAttribute(ConnectorType, "line");
 		updateLineType();
 	}
 
@@ -264,9 +268,8 @@ private slots:
 
 	void updateLineType()
 	{
-		auto connectorType = item->model()->getData<std::string>(
-		        ConnectorTypeKey).get_value_or("");
-		if(connectorType == "line")
+		const auto &model = *item->model();
+		if(model.attribute(ConnectorType) == "line")
 		{
 			mode = LineMode;
 			handle->setOrientation(0);
@@ -277,7 +280,7 @@ private slots:
 			handle->setOrientation(Qt::Horizontal);
 		}
 
-		_arrowhead = item->model()->getData<int>(ArrowheadsKey).get_value_or(NoArrowhead);
+		_arrowhead = model.attribute(Arrowheads);
 		DBDebug("Read arrowhead value from model: ", std::hex, _arrowhead);
 
 
@@ -307,7 +310,7 @@ private slots:
 			remove(rightArrowhead);
 		}
 
-		auto color = QColor(item->model()->getData<QString>(StrokeColorKey).get_value_or("#000"));
+		auto color = QColor(model.attribute(StrokeColor));
 
 		for(auto ah : {leftArrowhead, rightArrowhead})
 		{
@@ -322,8 +325,7 @@ private slots:
 			}
 		}
 
-		auto lineThickness = item->model()->getData<int>(LineThicknessKey)
-		    .get_value_or(1);
+		auto lineThickness = model.attribute(LineThickness);
 
 		auto pen = this->pen();
 		pen.setCapStyle(Qt::FlatCap);
@@ -331,7 +333,7 @@ private slots:
 		pen.setColor(color);
 		this->setPen(pen);
 
-		int busWidth = item->model()->getData<int>(BusWidthKey).get_value_or(1);
+		int busWidth = model.attribute(BusWidth);
 		if(busWidth > 1)
 		{
 			if(!leftHatchItem)
@@ -374,16 +376,16 @@ private slots:
 		{
 			auto scene = static_cast<DiagramScene *>(item->scene());
 			auto model = item->model();
-			if(!model->connection()) return;
-			auto conn = *model->connection();
+			const auto &conn = model->connection();
+			if(!conn) return;
 
-			auto p1 = scene->item(conn.src);
-			auto p2 = scene->item(conn.dst);
+			auto p1 = scene->item(conn->src, srcHandle);
+			auto p2 = scene->item(conn->dst, dstHandle);
 
 			if(p1 && p2)
 			{
-				auto srcPt = p1->scenePortLocation(conn.srcPort);
-				auto dstPt = p2->scenePortLocation(conn.dstPort);
+				auto srcPt = p1->scenePortLocation(conn->srcPort);
+				auto dstPt = p2->scenePortLocation(conn->dstPort);
 
 				if(srcPt.x() > dstPt.x())
 				{
@@ -429,7 +431,7 @@ private slots:
 					return;
 				}
 
-				qreal xc = conn.center * (dstPt.x() - srcPt.x());
+				qreal xc = conn->center * (dstPt.x() - srcPt.x());
 				if(abs(xc) > abs(dstPt.x() - srcPt.x()))
 				{
 					xc = dstPt.x() - srcPt.x();
@@ -898,6 +900,12 @@ ConnectorComponent::ConnectorComponent(QObject* parent)
 : DiagramComponent("connector", parent)
 {
 	setHidden(true);
+
+	for(int slot : {LineThickness.slot(), ConnectorType.slot(), BusWidth.slot(),
+	                Arrowheads.slot(), StrokeColor.slot()})
+	{
+		registerAttribute(slot);
+	}
 }
 
 void ConnectorComponent::configure(DiagramItem *item) const
@@ -19,12 +19,16 @@ class PathConnectorController: public QObject
 	Q_OBJECT
 	DiagramItem *item;
 	PathItem *view;
+	// endpoint handles resolved on the last update
+	ItemHandle srcHandle, dstHandle;
 public:
 
 	PathConnectorController(DiagramItem *item, PathItem *view)
 	: QObject(view)
 	, item(item)
 	, view(view)
+	, srcHandle(InvalidItemHandle)
+	, dstHandle(InvalidItemHandle)
 	{
 		view->setStartConstrained(true);
 		view->setEndConstrained(true);
@@ -74,16 +78,16 @@ public slots:
 		{
 			auto scene = static_cast<DiagramScene *>(item->scene());
 			auto model = item->model();
-			if(!model->connection()) return;
-			auto conn = *model->connection();
+			const auto &conn = model->connection();
+			if(!conn) return;
 
-			auto p1 = scene->item(conn.src);
-			auto p2 = scene->item(conn.dst);
+			auto p1 = scene->item(conn->src, srcHandle);
+			auto p2 = scene->item(conn->dst, dstHandle);
 
 			if(p1 && p2)
 			{
-				auto srcPt = p1->scenePortLocation(conn.srcPort);
-				auto dstPt = p2->scenePortLocation(conn.dstPort);
+				auto srcPt = p1->scenePortLocation(conn->srcPort);
+				auto dstPt = p2->scenePortLocation(conn->dstPort);
 
 				if(srcPt.x() > dstPt.x())
 				{
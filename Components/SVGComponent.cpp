@@ -13,16 +13,24 @@
 #include "Util/FixedWidthStroke.hpp"
 #include <QPainter>
 #include <QSvgRenderer>
+#include <QFile>
+#include "Main/Application.hpp"
+#include "Util/IconCache.hpp"
+#include "Components/SymbolCache.hpp"
+#include "Util/Log.hpp"
 namespace dbuilder {
 namespace {
 
-QIcon iconFromSVG(QSvgRenderer &renderer)
+const QSize IconSize(32, 32);
+/// the longer side of a glyph; glyphs are drawn at most this large
+const int GlyphExtent = 32;
+
+QImage iconFromSVG(QSvgRenderer &renderer)
 {
-	QImage img(QSize(32, 32), QImage::Format_ARGB32);
-	img.fill(QColor(0, 0, 0, 0));
+	QImage img(IconSize, QImage::Format_ARGB32_Premultiplied);
+	img.fill(0);
 
-	QPixmap pixmap = QPixmap::fromImage(img);
-	QPainter painter(&pixmap);
+	QPainter painter(&img);
 
 
 	auto viewBox = renderer.viewBoxF();
@@ -41,21 +49,40 @@ QIcon iconFromSVG(QSvgRenderer &renderer)
 
 	renderer.render(&painter, drawArea);
 
-	return QIcon(pixmap);
+	return img;
 
 }
 
+/**
+ * Draws the symbol of an SVGComponent as a child item, when items are not
+ * flattened.
+ */
+class SVGSymbolItem: public QGraphicsSvgItem
+{
+	const SVGComponent *_kind;
+	DiagramItem *_item;
+public:
+	SVGSymbolItem(const SVGComponent *kind, DiagramItem *item)
+	: QGraphicsSvgItem(item)
+	, _kind(kind)
+	, _item(item)
+	{ }
+
+	void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+	{
+		_kind->paintSymbol(_item, painter, _item->detailLevel(painter));
+	}
+};
+
 }  // anonymous namespace
 
 SVGComponent::SVGComponent(QString kindName, QString filename, QList<QPointF> ports, QObject* parent)
 : DiagramComponent(kindName, parent)
 , _filename(filename)
 , _ports(ports)
+, _sharedRenderer(nullptr)
+, _symbol(0)
 {
-	auto document = makeFixedWidthStroke(this->filename());
-	QSvgRenderer renderer(document.toAscii());
-	_icon = iconFromSVG(renderer);
-	_sharedRenderer = new QSvgRenderer(_filename, this);
 }
 
 SVGComponent::SVGComponent(QString kindName,
@@ -65,24 +92,151 @@ SVGComponent::SVGComponent(QString kindName,
 : DiagramComponent(kindName)
 , _ports(ports)
 , _svgData(svgData.data)
+, _sharedRenderer(nullptr)
+, _symbol(0)
+{
+}
+
+QByteArray SVGComponent::svgDocument() const
+{
+	if(_filename.isNull())
+	{
+		return _svgData.toUtf8();
+	}
+
+	QFile file(_filename);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		DBWarning("Cannot read ", _filename, ": ", file.errorString());
+		return QByteArray();
+	}
+	return file.readAll();
+}
+
+PreprocessedSVG SVGComponent::preprocess(const QByteArray &source, IconCache *cache)
+{
+	PreprocessedSVG result;
+	if(cache)
+	{
+		result.icon = cache->find(source, IconSize);
+		if(!result.icon.isNull())
+		{
+			return result;
+		}
+	}
+
+	QSvgRenderer renderer(makeFixedWidthStrokeWithData(source, result.error));
+	if(result.error.isNull() && !renderer.isValid())
+	{
+		result.error = "not an SVG document";
+	}
+	result.icon = iconFromSVG(renderer);
+
+	// a broken document is rendered again, so it is reported again
+	if(cache && result.error.isNull())
+	{
+		cache->insert(source, result.icon);
+	}
+	return result;
+}
+
+void SVGComponent::setPreprocessed(const PreprocessedSVG &svg)
 {
-	auto document = makeFixedWidthStrokeWithData(_svgData);
-	QSvgRenderer renderer(document.toAscii());
-	_icon = iconFromSVG(renderer);
-	_sharedRenderer = new QSvgRenderer(_svgData.toUtf8(), this);
+	if(!svg.error.isNull())
+	{
+		DBWarning("Invalid SVG for component ", name(), ": ", svg.error);
+	}
+	_icon = QIcon(QPixmap::fromImage(svg.icon));
 }
 
 QIcon SVGComponent::icon() const
 {
+	if(_icon.isNull())
+	{
+		auto cache = Application::instance()? Application::instance()->iconCache() : nullptr;
+		const_cast<SVGComponent *>(this)->setPreprocessed(preprocess(svgDocument(), cache));
+	}
 	return _icon;
 }
 
+const QPixmap &SVGComponent::glyph() const
+{
+	if(_glyph.isNull() && _sharedRenderer)
+	{
+		QSizeF size = _sharedRenderer->viewBoxF().size();
+		size.scale(GlyphExtent, GlyphExtent, Qt::KeepAspectRatio);
+
+		QImage img(size.toSize().expandedTo(QSize(1, 1)), QImage::Format_ARGB32_Premultiplied);
+		img.fill(0);
+		{
+			QPainter painter(&img);
+			painter.setRenderHint(QPainter::Antialiasing);
+			_sharedRenderer->render(&painter);
+		}
+		_glyph = QPixmap::fromImage(img);
+	}
+	return _glyph;
+}
+
+void SVGComponent::paintSymbol(const DiagramItem *item, QPainter *painter, DetailLevel level) const
+{
+	// a kind that was never configured, or whose SVG did not load, has no
+	// symbol; its items are drawn as blocks
+	const bool hasSymbol = _sharedRenderer && _sharedRenderer->isValid();
+	const QRectF bounds = hasSymbol?
+		  QRectF(QPointF(0, 0), _sharedRenderer->defaultSize())
+		: item->boundingRect();
+	if(!hasSymbol && level != DetailLevel::Hidden)
+	{
+		level = DetailLevel::Block;
+	}
+
+	switch(level)
+	{
+	case DetailLevel::Full:
+	{
+		// print and export get vectors
+		auto cache = Application::instance()? Application::instance()->symbolCache() : nullptr;
+		if(item->printMode() || !cache || !cache->draw(painter, _symbol, _sharedRenderer, bounds))
+		{
+			_sharedRenderer->render(painter, bounds);
+		}
+		break;
+	}
+	case DetailLevel::Glyph:
+		painter->drawPixmap(bounds, glyph(), glyph().rect());
+		break;
+	case DetailLevel::Block:
+		painter->fillRect(bounds, QColor(0, 0, 0, 96));
+		break;
+	case DetailLevel::Hidden:
+		break;
+	}
+}
+
 void SVGComponent::configure(DiagramItem *item) const
 {
 	item->setFlag(QGraphicsItem::ItemIsSelectable);
 	item->setFlag(QGraphicsItem::ItemIsMovable);
-	auto svgItem = new QGraphicsSvgItem(item);
-	svgItem->setSharedRenderer(_sharedRenderer);
+	if(!_sharedRenderer)
+	{
+		auto self = const_cast<SVGComponent *>(this);
+		_sharedRenderer = _filename.isNull()
+			? new QSvgRenderer(_svgData.toUtf8(), self)
+			: new QSvgRenderer(_filename, self);
+		_symbol = SymbolCache::newSymbol();
+	}
+
+	auto app = Application::instance();
+	if(app && app->flattenItems())
+	{
+		item->setFlattened(QRectF(QPointF(0, 0), _sharedRenderer->defaultSize()));
+	}
+	else
+	{
+		auto svgItem = new SVGSymbolItem(this, item);
+		svgItem->setSharedRenderer(_sharedRenderer);
+	}
 
 	for(auto port : _ports)
 	{
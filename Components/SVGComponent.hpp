@@ -10,31 +10,82 @@
 #include <QString>
 #include <QPoint>
 #include <QList>
+#include <QByteArray>
+#include <QImage>
+#include <QPixmap>
 
 class QSvgRenderer;
 
 namespace dbuilder {
 
+class IconCache;
+
 struct SVGData
 {
 	QString data;
 };
 
+/**
+ * What SVGComponent::preprocess() makes of an SVG document.
+ */
+struct PreprocessedSVG
+{
+	/// the icon, from the cache or rendered with non-scaling strokes
+	QImage icon;
+	/// why the document is not valid SVG, or a null string
+	QString error;
+};
+
 class SVGComponent: public DiagramComponent
 {
 	Q_OBJECT
 	QString _filename;
 	QList<QPointF> _ports;
-	QIcon _icon;
 	QString _svgData;
-	QSvgRenderer *_sharedRenderer;
+	// made the first time they are needed; most kinds are never drawn
+	mutable QIcon _icon;
+	mutable QSvgRenderer *_sharedRenderer;
+	mutable QPixmap _glyph;
+	/// identifies the renderer in the SymbolCache
+	mutable quint64 _symbol;
 public:
 	SVGComponent(QString kindName, QString filename, QList<QPointF> ports, QObject *parent=nullptr);
 	SVGComponent(QString kindName, const SVGData &svgData, const QList<QPointF> &ports, QObject *parent=nullptr);
 	void configure(DiagramItem *) const;
+	boost::optional<int> portCount(const boost::property_tree::ptree &) const { return _ports.size(); }
 
 	QIcon icon() const;
 
+	/// items draw from the application's SymbolCache
+	bool sharesRasters() const { return true; }
+	void paintSymbol(const DiagramItem *item, QPainter *painter, DetailLevel level) const;
+
+	/// @return the SVG document, read from the file if there is one
+	QByteArray svgDocument() const;
+
+	/**
+	 * Validates source and makes its icon, using cache if it is not null.
+	 * Only touches its arguments, so it may run on any thread.
+	 */
+	static PreprocessedSVG preprocess(const QByteArray &source, IconCache *cache);
+	/**
+	 * Takes the icon made by preprocess() from svgDocument(). GUI thread
+	 * only.
+	 */
+	void setPreprocessed(const PreprocessedSVG &svg);
+
+	/**
+	 * @return the symbol rendered small, for items drawn at
+	 * DetailLevel::Glyph; made the first time it is needed
+	 */
+	const QPixmap &glyph() const;
+
+	/// @return the SymbolCache identifier of the renderer items share
+	quint64 symbol() const
+	{
+		return _symbol;
+	}
+
 	const QString &filename() const { return _filename; }
 	virtual ~SVGComponent();
 };
@@ -0,0 +1,96 @@
+/**
+ * @file   SymbolCache.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "SymbolCache.hpp"
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QImage>
+#include <cmath>
+
+namespace dbuilder {
+
+const int SymbolCache::BucketsPerOctave;
+const int SymbolCache::MaxRasterPixels;
+const int SymbolCache::DefaultMaxKiB;
+
+SymbolCache::SymbolCache(int maxKiB)
+: _rasters(maxKiB)
+{
+}
+
+quint64 SymbolCache::newSymbol()
+{
+	// symbols are made on the GUI thread
+	static quint64 next = 0;
+	return ++next;
+}
+
+bool SymbolCache::draw(QPainter *painter, quint64 symbol, QSvgRenderer *renderer, const QRectF &bounds)
+{
+	const QTransform world = painter->worldTransform();
+	if(world.type() > QTransform::TxRotate
+		|| std::abs(world.m11() - world.m22()) > 1e-9
+		|| std::abs(world.m12() + world.m21()) > 1e-9)
+	{
+		return false;
+	}
+
+	const qreal scale = std::hypot(world.m11(), world.m12());
+	if(scale <= 0)
+	{
+		return false;
+	}
+
+	Key key;
+	key.symbol = symbol;
+	key.rotation = (qRound(std::atan2(world.m12(), world.m11()) * 180 / M_PI) + 360) % 360;
+	key.bucket = qRound(std::log2(scale) * BucketsPerOctave);
+
+	const qreal bucketScale = std::pow(2.0, qreal(key.bucket) / BucketsPerOctave);
+	const QTransform rasterTransform = QTransform().rotate(key.rotation).scale(bucketScale, bucketScale);
+
+	Raster *raster = _rasters.object(key);
+	if(!raster)
+	{
+		const QRectF device = rasterTransform.mapRect(bounds);
+		const QPoint topLeft(std::floor(device.left()), std::floor(device.top()));
+		const QSize size(std::ceil(device.right()) - topLeft.x(), std::ceil(device.bottom()) - topLeft.y());
+		if(size.isEmpty() || qint64(size.width()) * size.height() > MaxRasterPixels)
+		{
+			return false;
+		}
+
+		QImage image(size, QImage::Format_ARGB32_Premultiplied);
+		image.fill(0);
+		{
+			QPainter p(&image);
+			p.setRenderHint(QPainter::Antialiasing);
+			p.setTransform(rasterTransform * QTransform::fromTranslate(-topLeft.x(), -topLeft.y()));
+			renderer->render(&p, bounds);
+		}
+
+		raster = new Raster;
+		raster->pixmap = QPixmap::fromImage(image);
+		raster->offset = topLeft;
+		const int kiB = qMax(1, image.byteCount() / 1024);
+		if(!_rasters.insert(key, raster, kiB))
+		{
+			// larger than the whole cache
+			return false;
+		}
+	}
+
+	painter->save();
+	painter->setRenderHint(QPainter::SmoothPixmapTransform);
+	painter->setWorldTransform(QTransform::fromTranslate(raster->offset.x(), raster->offset.y())
+	                           * rasterTransform.inverted() * world);
+	painter->drawPixmap(0, 0, raster->pixmap);
+	painter->restore();
+	return true;
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,106 @@
+#pragma once
+/**
+ * @file   SymbolCache.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QCache>
+#include <QPixmap>
+#include <QPoint>
+#include <QRectF>
+
+class QPainter;
+class QSvgRenderer;
+
+namespace dbuilder {
+
+/**
+ * Symbols rasterized once per symbol, rotation and zoom bucket, and shared
+ * by every item that draws that symbol.
+ *
+ * Rotations are kept to the degree, and scales to a quarter of an octave; a
+ * raster is drawn with whatever transform remains, which is the identity
+ * when the view's zoom falls on a bucket. The least recently used rasters
+ * are dropped to keep within a memory bound.
+ */
+class SymbolCache
+{
+public:
+	/// zoom buckets in each doubling of the scale
+	static const int BucketsPerOctave = 4;
+	/// the largest raster, in pixels; larger symbols are drawn as vectors
+	static const int MaxRasterPixels = 1024 * 1024;
+	static const int DefaultMaxKiB = 64 * 1024;
+
+	struct Key
+	{
+		quint64 symbol;
+		int rotation;
+		int bucket;
+
+		bool operator==(const Key &other) const
+		{
+			return symbol == other.symbol && rotation == other.rotation && bucket == other.bucket;
+		}
+	};
+
+private:
+	struct Raster
+	{
+		QPixmap pixmap;
+		/// where the top left pixel is, in the rotated and scaled coordinates
+		QPoint offset;
+	};
+
+	QCache<Key, Raster> _rasters;
+
+public:
+	/**
+	 * @param maxKiB  how much memory the rasters may take
+	 */
+	SymbolCache(int maxKiB = DefaultMaxKiB);
+
+	/// @return a new identifier for a symbol, to pass to draw()
+	static quint64 newSymbol();
+
+	/**
+	 * Draws bounds of renderer with painter from the raster for its
+	 * current rotation and zoom bucket, rasterizing it first if needed.
+	 *
+	 * @param symbol  identifies renderer; from newSymbol()
+	 * @return false if the painter's transform is not a rotation and a
+	 * uniform scale, or the raster would be too large; the caller should
+	 * draw the vectors instead
+	 */
+	bool draw(QPainter *painter, quint64 symbol, QSvgRenderer *renderer, const QRectF &bounds);
+
+	int maxKiB() const
+	{
+		return _rasters.maxCost();
+	}
+
+	void setMaxKiB(int maxKiB)
+	{
+		_rasters.setMaxCost(maxKiB);
+	}
+
+	/// @return the memory taken by the rasters, in KiB
+	int totalKiB() const
+	{
+		return _rasters.totalCost();
+	}
+
+	void clear()
+	{
+		_rasters.clear();
+	}
+};
+
+inline uint qHash(const SymbolCache::Key &key)
+{
+	return ::qHash(key.symbol) ^ uint(key.rotation * 31 + key.bucket * 7919);
+}
+
+}  // namespace dbuilder
@@ -27,6 +27,7 @@
 #include "Util/FunctionSlot.hpp"
 #include <QAction>
 #include "BasicPropertyWidget.hpp"
+#include "Main/Application.hpp"
 
 
 namespace dbuilder {
@@ -65,7 +66,49 @@ public:
 			doubleClicked({});
 		}
 	}
+
+	void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+	{
+		if(item->detailLevel(painter) == DetailLevel::Hidden)
+		{
+			return;
+		}
+
+		const auto app = Application::instance();
+		const qreal greekBelow = (app? app->levelOfDetail() : LevelOfDetail()).greekTextBelow;
+		if(!item->printMode() && QFontMetricsF(font()).height() * LevelOfDetail::scale(painter) < greekBelow)
+		{
+			paintGreeked(painter);
+		}
+		else
+		{
+			QGraphicsTextItem::paint(painter, option, widget);
+		}
+	}
 protected:
+	/**
+	 * Draws a bar for each laid out line, without drawing any glyphs.
+	 */
+	void paintGreeked(QPainter *painter)
+	{
+		QColor color = defaultTextColor();
+		color.setAlpha(96);
+
+		painter->save();
+		painter->setPen(Qt::NoPen);
+		painter->setBrush(color);
+		for(auto block = document()->begin(); block.isValid(); block = block.next())
+		{
+			const auto layout = block.layout();
+			for(int i = 0; i < layout->lineCount(); ++i)
+			{
+				const QRectF line = layout->lineAt(i).naturalTextRect().translated(layout->position());
+				painter->drawRect(line.adjusted(0, line.height() * 0.3, 0, -line.height() * 0.2));
+			}
+		}
+		painter->restore();
+	}
+
 	QVariant itemChange(GraphicsItemChange change, const QVariant &value)
 	{
 		return QGraphicsTextItem::itemChange(change, value);
@@ -91,6 +134,7 @@ private slots:
 	void doubleClicked(QPointF)
 	{
 		this->setTextInteractionFlags(Qt::TextEditorInteraction);
+		item->setEditorOpen(true);
 
 		this->setFocus(Qt::MouseFocusReason);
 		this->setCacheMode(QGraphicsItem::NoCache);
@@ -102,6 +146,13 @@ private slots:
 	{
 		if(!focused)
 		{
+			// the text is written to the model when the editor closes
+			if(item->editorOpen())
+			{
+				updateModel();
+				item->setEditorOpen(false);
+			}
+
 			auto tc = this->textCursor();
 			tc.movePosition(QTextCursor::StartOfLine);
 			this->setTextCursor(tc);
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 /**
  * @file   CoreForward.hpp
  *
@@ -10,6 +11,7 @@ namespace dbuilder {
 
 class Application;
 class DiagramItemModel;
+struct ModelSnapshot;
 class DiagramContext;
 class DiagramComponent;
 class DiagramItem;
@@ -20,4 +22,10 @@ class PropertyWidget;
 class BasicPlugin;
 class DiagramComponentPlugin;
 
+/**
+ * Dense per-scene index of a DiagramItem, assigned by DiagramScene::addDiagramItem().
+ */
+typedef std::uint32_t ItemHandle;
+static const ItemHandle InvalidItemHandle = 0xffffffffu;
+
 }  // namespace dbuilder
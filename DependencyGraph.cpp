@@ -0,0 +1,274 @@
+/**
+ * @file   DependencyGraph.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DependencyGraph.hpp"
+#include <algorithm>
+#include <cassert>
+
+namespace dbuilder {
+
+namespace {
+
+bool eraseValue(DependencyGraph::NodeList &list, DependencyGraph::Node n)
+{
+	auto it = std::find(list.begin(), list.end(), n);
+	if(it == list.end()) return false;
+
+	// order within an adjacency list is not significant
+	*it = list.back();
+	list.pop_back();
+	return true;
+}
+
+}  // anonymous namespace
+
+DependencyGraph::DependencyGraph()
+: _generation(0)
+, _orderValid(false)
+{
+}
+
+void DependencyGraph::ensureNode(Node n)
+{
+	assert(n != InvalidItemHandle);
+	if(n >= _nodes.size())
+	{
+		_nodes.resize(n + 1);
+		_orderValid = false;
+	}
+}
+
+std::uint32_t DependencyGraph::nextGeneration() const
+{
+	if(_mark.size() < _nodes.size())
+	{
+		_mark.resize(_nodes.size(), 0);
+	}
+
+	// sort() also uses the generation after the one returned
+	if(_generation >= 0xfffffffdu)
+	{
+		std::fill(_mark.begin(), _mark.end(), 0);
+		_generation = 0;
+	}
+
+	return ++_generation;
+}
+
+bool DependencyGraph::addEdge(Node dependency, Node dependent)
+{
+	ensureNode(std::max(dependency, dependent));
+
+	auto &out = _nodes[dependency].dependents;
+	if(std::find(out.begin(), out.end(), dependent) != out.end())
+	{
+		return false;
+	}
+
+	out.push_back(dependent);
+	_nodes[dependent].dependencies.push_back(dependency);
+	_orderValid = false;
+	return true;
+}
+
+bool DependencyGraph::removeEdge(Node dependency, Node dependent)
+{
+	if(dependency >= _nodes.size() || dependent >= _nodes.size())
+	{
+		return false;
+	}
+
+	if(!eraseValue(_nodes[dependency].dependents, dependent))
+	{
+		return false;
+	}
+
+	eraseValue(_nodes[dependent].dependencies, dependency);
+	_orderValid = false;
+	return true;
+}
+
+void DependencyGraph::isolate(Node n)
+{
+	if(n >= _nodes.size()) return;
+
+	auto &adj = _nodes[n];
+	for(Node dependent : adj.dependents)
+	{
+		eraseValue(_nodes[dependent].dependencies, n);
+	}
+
+	for(Node dependency : adj.dependencies)
+	{
+		eraseValue(_nodes[dependency].dependents, n);
+	}
+
+	if(!adj.dependents.empty() || !adj.dependencies.empty())
+	{
+		adj.dependents.clear();
+		adj.dependencies.clear();
+		_orderValid = false;
+	}
+}
+
+void DependencyGraph::clear()
+{
+	_nodes.clear();
+	_mark.clear();
+	_pending.clear();
+	_allNodes.clear();
+	_order.clear();
+	_cyclic.clear();
+	_generation = 0;
+	_orderValid = false;
+}
+
+const DependencyGraph::NodeList &DependencyGraph::dependents(Node n) const
+{
+	static const NodeList Empty;
+	return n < _nodes.size()? _nodes[n].dependents : Empty;
+}
+
+const DependencyGraph::NodeList &DependencyGraph::dependencies(Node n) const
+{
+	static const NodeList Empty;
+	return n < _nodes.size()? _nodes[n].dependencies : Empty;
+}
+
+void DependencyGraph::reachable(Node root, NodeList &out) const
+{
+	out.clear();
+	if(root >= _nodes.size())
+	{
+		out.push_back(root);
+		return;
+	}
+
+	const auto generation = nextGeneration();
+	_mark[root] = generation;
+	out.push_back(root);
+
+	// out doubles as the BFS queue
+	for(size_t head = 0; head < out.size(); ++head)
+	{
+		for(Node dependent : _nodes[out[head]].dependents)
+		{
+			if(_mark[dependent] != generation)
+			{
+				_mark[dependent] = generation;
+				out.push_back(dependent);
+			}
+		}
+	}
+}
+
+void DependencyGraph::sort(const NodeList &nodes, NodeList &out, NodeList *cyclic) const
+{
+	out.clear();
+	if(cyclic) cyclic->clear();
+
+	const auto generation = nextGeneration();
+	// nodes without edges may lie beyond _nodes, but still need a mark
+	Node limit = _nodes.size();
+	for(Node n : nodes)
+	{
+		assert(n != InvalidItemHandle);
+		limit = std::max(limit, n + 1);
+	}
+	if(_mark.size() < limit)
+	{
+		_mark.resize(limit, 0);
+	}
+	if(_pending.size() < limit)
+	{
+		_pending.resize(limit, 0);
+	}
+
+	// mark membership, dropping duplicates so that each node counts once
+	_unique.clear();
+	for(Node n : nodes)
+	{
+		if(_mark[n] != generation)
+		{
+			_mark[n] = generation;
+			_pending[n] = 0;
+			_unique.push_back(n);
+		}
+	}
+
+	for(Node n : _unique)
+	{
+		if(n >= _nodes.size()) continue;
+		for(Node dependent : _nodes[n].dependents)
+		{
+			if(_mark[dependent] == generation)
+			{
+				++_pending[dependent];
+			}
+		}
+	}
+
+	// seed with nodes that have no dependencies within the set
+	for(Node n : _unique)
+	{
+		if(_pending[n] == 0)
+		{
+			_mark[n] = generation + 1;
+			out.push_back(n);
+		}
+	}
+
+	for(size_t head = 0; head < out.size(); ++head)
+	{
+		Node n = out[head];
+		if(n >= _nodes.size()) continue;
+
+		for(Node dependent : _nodes[n].dependents)
+		{
+			if(_mark[dependent] == generation && --_pending[dependent] == 0)
+			{
+				_mark[dependent] = generation + 1;
+				out.push_back(dependent);
+			}
+		}
+	}
+
+	if(out.size() < _unique.size())
+	{
+		for(Node n : _unique)
+		{
+			if(_mark[n] == generation)
+			{
+				_mark[n] = generation + 1;
+				out.push_back(n);
+				if(cyclic) cyclic->push_back(n);
+			}
+		}
+	}
+
+	// generation + 1 was used as a second mark value
+	++_generation;
+}
+
+const DependencyGraph::NodeList &DependencyGraph::topologicalOrder() const
+{
+	if(!_orderValid)
+	{
+		_allNodes.resize(_nodes.size());
+		for(Node n = 0; n < _nodes.size(); ++n)
+		{
+			_allNodes[n] = n;
+		}
+
+		sort(_allNodes, _order, &_cyclic);
+		_orderValid = true;
+	}
+
+	return _order;
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "CoreForward.hpp"
+/**
+ * @file   DependencyGraph.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+namespace dbuilder {
+
+/**
+ * Directed graph over item handles, with an edge from each dependency to
+ * each of its dependents.
+ *
+ * Every node keeps flat arrays of its dependents and its dependencies, so
+ * edges can be inserted and erased one at a time and a traversal reads
+ * contiguous memory. Traversals and sorts reuse internal scratch buffers
+ * and generation marks, so they do not allocate after warm-up.
+ */
+class DependencyGraph
+{
+public:
+	typedef ItemHandle Node;
+	typedef std::vector<Node> NodeList;
+
+private:
+	struct Adjacency
+	{
+		NodeList dependents;
+		NodeList dependencies;
+	};
+
+	std::vector<Adjacency> _nodes;
+
+	mutable std::vector<std::uint32_t> _mark;
+	mutable std::uint32_t _generation;
+	mutable std::vector<std::uint32_t> _pending;
+
+	mutable NodeList _unique;
+	mutable NodeList _allNodes;
+	mutable NodeList _order;
+	mutable NodeList _cyclic;
+	mutable bool _orderValid;
+
+	void ensureNode(Node n);
+	std::uint32_t nextGeneration() const;
+
+public:
+	DependencyGraph();
+
+	size_t size() const
+	{
+		return _nodes.size();
+	}
+
+	void addNode(Node n)
+	{
+		ensureNode(n);
+	}
+
+	/**
+	 * @return false if the edge already existed
+	 */
+	bool addEdge(Node dependency, Node dependent);
+
+	/**
+	 * @return false if there was no such edge
+	 */
+	bool removeEdge(Node dependency, Node dependent);
+
+	/**
+	 * Removes all edges into and out of n.
+	 */
+	void isolate(Node n);
+
+	void clear();
+
+	const NodeList &dependents(Node n) const;
+	const NodeList &dependencies(Node n) const;
+
+	/**
+	 * Collects root and everything that transitively depends on it, each
+	 * node once, in breadth-first order.
+	 */
+	void reachable(Node root, NodeList &out) const;
+
+	/**
+	 * Orders a set of nodes so that each node comes after all of its
+	 * dependencies that are also in the set (Kahn's algorithm). Ties are broken by
+	 * input order, and a node given more than once is output once. Nodes on a
+	 * cycle cannot be ordered. They are appended at the end in input order
+	 * and, if cyclic is given, also reported there.
+	 */
+	void sort(const NodeList &nodes, NodeList &out, NodeList *cyclic=nullptr) const;
+
+	/**
+	 * @return every node in dependency order; cached until the next edge change
+	 */
+	const NodeList &topologicalOrder() const;
+
+	/**
+	 * @return the nodes of topologicalOrder() that lie on or behind a cycle
+	 */
+	const NodeList &cyclicNodes() const
+	{
+		topologicalOrder();
+		return _cyclic;
+	}
+};
+
+}  // namespace dbuilder
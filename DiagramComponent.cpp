@@ -33,6 +33,11 @@ DiagramComponent::~DiagramComponent()
 {
 }
 
+boost::optional<int> DiagramComponent::portCount(const boost::property_tree::ptree &) const
+{
+	return boost::none;
+}
+
 void DiagramComponent::print(std::ostream& os) const
 {
 	os << name().toStdString();
@@ -2,8 +2,12 @@
 #include <QString>
 #include <QObject>
 #include <QIcon>
+#include <vector>
+#include <boost/optional.hpp>
+#include <boost/property_tree/ptree_fwd.hpp>
 #include "Util/Printable.hpp"
 #include "CoreForward.hpp"
+#include "LevelOfDetail.hpp"
 
 /**
  * @file   DiagramComponent.h
@@ -11,6 +15,7 @@
  * @date   Jan 2, 2013
  * @author Sam Roth <>
  */
+class QPainter;
 
 namespace dbuilder {
 
@@ -21,6 +26,7 @@ class DiagramComponent: public QObject, public Printable
 	Q_OBJECT
 	QString _name;
 	bool _hidden;
+	std::vector<int> _attributeSlots;
 public:
 	DiagramComponent(QString name, QObject *parent=nullptr);
 
@@ -47,10 +53,45 @@ public:
 
 	virtual void print(std::ostream &os) const;
 
+	/**
+	 * @return the attribute slots read from extraData when loading items of this kind
+	 */
+	const std::vector<int> &attributeSlots() const
+	{
+		return _attributeSlots;
+	}
+
+	/**
+	 * @return the number of ports an item of this kind with the given
+	 * extraData has, or none if that is only known once it is configured
+	 */
+	virtual boost::optional<int> portCount(const boost::property_tree::ptree &extraData) const;
+
 	DiagramItem *create(DiagramScene *scene) const;
 	virtual DiagramItem *createFromModel(DiagramItemModel *model) const;
 
 	virtual PropertyWidget *makePropertyWidget(QWidget *parent=nullptr) const;
+
+	/**
+	 * @return whether items of this kind draw from rasters shared between
+	 * items, so that neither they nor their children need a pixmap cache of
+	 * their own
+	 */
+	virtual bool sharesRasters() const { return false; }
+
+	/**
+	 * Draws the symbol of a flattened item (see DiagramItem::setFlattened())
+	 * in item coordinates.
+	 */
+	virtual void paintSymbol(const DiagramItem *item, QPainter *painter, DetailLevel level) const { }
+protected:
+	/**
+	 * Declares an attribute (see Attribute<T>::slot()) used by this kind.
+	 */
+	void registerAttribute(int slot)
+	{
+		_attributeSlots.push_back(slot);
+	}
 };
 
 
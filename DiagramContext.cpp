@@ -17,41 +17,88 @@ namespace dbuilder {
 
 DP_DEFINE(DiagramContext)
 {
-	QMap<QString, DiagramComponent *> kinds;
+	std::shared_ptr<ComponentRegistry> registry;
+	QMap<QString, DiagramComponent *> localKinds;
 };
 
-DiagramContext::DiagramContext(QObject *parent)
+DiagramContext::DiagramContext(const std::shared_ptr<ComponentRegistry> &registry, QObject *parent)
 : QObject(parent)
 , DP_INIT
 {
+	dat->registry = registry;
+}
 
+const std::shared_ptr<ComponentRegistry> &DiagramContext::registry() const
+{
+	return dat->registry;
 }
 
 void DiagramContext::registerKind(DiagramComponent* kind)
 {
-	if(dat->kinds.count(kind->name()))
+	if(dat->localKinds.count(kind->name()) || dat->registry->kindNames().contains(kind->name()))
 	{
 		throw KindAlreadyExistsException();
 	}
 
 	kind->setParent(this);
-	dat->kinds[kind->name()] = kind;
+	dat->localKinds[kind->name()] = kind;
 }
 
 DiagramComponent* DiagramContext::kind(const QString& name)
 {
-	auto it = dat->kinds.find(name);
-	if(it == dat->kinds.end())
+	auto it = dat->localKinds.find(name);
+	if(it != dat->localKinds.end())
+	{
+		return it.value();
+	}
+
+	return dat->registry->kind(name);
+}
+
+DiagramComponent *DiagramContext::findKind(const QString &name)
+{
+	auto it = dat->localKinds.find(name);
+	if(it != dat->localKinds.end())
 	{
-		throw KindDoesNotExistException(("the type of diagram item " + name + " does not exist").toStdString());
+		return it.value();
 	}
 
-	return it.value();
+	return dat->registry->findKind(name);
 }
 
-const QMap<QString, DiagramComponent *> &DiagramContext::kinds() const
+namespace {
+
+QMap<QString, DiagramComponent *> withLocalKinds(QMap<QString, DiagramComponent *> result,
+                                                  const QMap<QString, DiagramComponent *> &localKinds)
 {
-	return dat->kinds;
+	for(auto it = localKinds.begin(), end = localKinds.end(); it != end; ++it)
+	{
+		result.insert(it.key(), it.value());
+	}
+	return result;
+}
+
+}  // namespace
+
+QMap<QString, DiagramComponent *> DiagramContext::kinds() const
+{
+	return withLocalKinds(dat->registry->kinds(), dat->localKinds);
+}
+
+QMap<QString, DiagramComponent *> DiagramContext::createdKinds() const
+{
+	return withLocalKinds(dat->registry->createdKinds(), dat->localKinds);
+}
+
+QStringList DiagramContext::kindNames() const
+{
+	QStringList result = dat->registry->kindNames();
+	if(!dat->localKinds.isEmpty())
+	{
+		result << dat->localKinds.keys();
+		result.sort();
+	}
+	return result;
 }
 
 DiagramContext::~DiagramContext()
@@ -1,9 +1,11 @@
 #pragma once
 #include <QObject>
 #include "DataPtr.hpp"
-#include "Exceptions.hpp"
+#include "ComponentRegistry.hpp"
 #include <QString>
 #include <QMap>
+#include <QStringList>
+#include <memory>
 #include "CoreForward.hpp"
 
 /**
@@ -18,19 +20,40 @@ namespace dbuilder {
 
 
 
-DBDefineException(KindAlreadyExistsException, "the kind of diagram item already exists");
-DBDefineException(KindDoesNotExistException, "the kind of diagram item does not exist");
-
+/**
+ * The kinds of diagram item available to a scene: those of a
+ * ComponentRegistry shared with other contexts, and any registered on the
+ * context itself.
+ */
 class DiagramContext: public QObject
 {
 	Q_OBJECT
 	DP_DECLARE(DiagramContext);
 public:
-	DiagramContext(QObject *object=nullptr);
+	DiagramContext(const std::shared_ptr<ComponentRegistry> &registry, QObject *parent=nullptr);
 
+	const std::shared_ptr<ComponentRegistry> &registry() const;
+
+	/**
+	 * Registers a kind for this context only.
+	 *
+	 * @throws KindAlreadyExistsException
+	 */
 	void registerKind(DiagramComponent *kind);
+
+	/**
+	 * @throws KindDoesNotExistException if name is not registered or its
+	 * factory fails
+	 */
 	DiagramComponent *kind(const QString &name);
-	const QMap<QString, DiagramComponent *> &kinds() const;
+	/// @return the kind, or nullptr if it is not registered or cannot be created
+	DiagramComponent *findKind(const QString &name);
+	/// @return all kinds, creating those not created yet
+	QMap<QString, DiagramComponent *> kinds() const;
+	/// @return the kinds created so far, without creating any
+	QMap<QString, DiagramComponent *> createdKinds() const;
+	/// @return the names of all registered kinds, created or not, sorted
+	QStringList kindNames() const;
 
 	virtual ~DiagramContext();
 };
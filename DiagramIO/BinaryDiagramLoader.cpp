@@ -0,0 +1,662 @@
+/**
+ * @file   BinaryDiagramLoader.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_BinaryDiagramLoader.cpp"
+#include <boost/property_tree/ptree.hpp>
+#include <QtEndian>
+#include <unordered_map>
+#include <iterator>
+#include <memory>
+#include <cstring>
+#include "DiagramItem.hpp"
+#include "DiagramScene.hpp"
+#include "DiagramItemModel.hpp"
+#include "DiagramComponent.hpp"
+#include "DiagramContext.hpp"
+#include "DiagramItemRecord.hpp"
+#include "InfoReader.hpp"
+#include "RawTree.hpp"
+#include "Util/Log.hpp"
+
+using boost::property_tree::ptree;
+
+namespace dbuilder {
+
+const char BinaryDiagramLoader::Magic[8] = { 'D', 'B', 'D', 'O', 'C', '\r', '\n', '\x1a' };
+
+namespace {
+
+enum: quint32
+{
+	HeaderSize     = 40,
+	ItemRecordSize = 120,
+	UuidSize       = 16,
+	MaxTreeDepth   = 256
+};
+
+enum ItemFlags: quint32
+{
+	HasConnection = 1
+};
+
+// header field offsets
+enum: size_t
+{
+	VersionOffset        = 8,
+	ItemCountOffset      = 12,
+	StringCountOffset    = 16,
+	StringTableOffset    = 20,
+	ItemsOffset          = 24,
+	DependenciesOffset   = 28,
+	ExtraOffset          = 32,
+	FileSizeOffset       = 36
+};
+
+// item record field offsets
+enum: size_t
+{
+	RecUuid         = 0,
+	RecKind         = 16,
+	RecFlags        = 20,
+	RecPosX         = 24,
+	RecPosY         = 32,
+	RecRotation     = 40,
+	RecSceneZ       = 48,
+	RecDepFirst     = 56,
+	RecDepCount     = 60,
+	RecExtraOffset  = 64,
+	RecExtraSize    = 68,
+	RecConnSrc      = 72,
+	RecConnDst      = 88,
+	RecConnSrcPort  = 104,
+	RecConnDstPort  = 108,
+	RecConnCenter   = 112
+};
+
+quint32 readU32(const char *p)
+{
+	return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(p));
+}
+
+/**
+ * An encoded extraData tree left in a mapped document. The Reader has
+ * checked every string index and node in it.
+ */
+class BinaryRawTree: public RawTree
+{
+	BufferOwner _owner;
+	// the string table offsets and the bytes they refer to
+	const char *_offsets;
+	const char *_strings;
+	const char *_begin;
+
+	StringRef string(quint32 index) const
+	{
+		quint32 begin = readU32(_offsets + 4 * index);
+		quint32 end = readU32(_offsets + 4 * (index + 1));
+		return StringRef(_strings + begin, end - begin);
+	}
+
+	void walkChildren(const char *&p, quint32 count, InfoHandler &handler) const
+	{
+		for(quint32 i = 0; i < count; ++i)
+		{
+			handler.key(string(readU32(p)));
+			handler.data(string(readU32(p + 4)));
+			quint32 children = readU32(p + 8);
+			p += 12;
+			if(children > 0)
+			{
+				handler.open();
+				walkChildren(p, children, handler);
+				handler.close();
+			}
+		}
+	}
+
+	template <typename Intern>
+	void transcodeNode(const char *&p, std::string &out, Intern &intern) const
+	{
+		uchar bytes[8];
+		qToLittleEndian(intern(string(readU32(p))), bytes);
+		quint32 children = readU32(p + 4);
+		qToLittleEndian(children, bytes + 4);
+		out.append(reinterpret_cast<const char *>(bytes), 8);
+		p += 8;
+		for(quint32 i = 0; i < children; ++i)
+		{
+			qToLittleEndian(intern(string(readU32(p))), bytes);
+			out.append(reinterpret_cast<const char *>(bytes), 4);
+			p += 4;
+			transcodeNode(p, out, intern);
+		}
+	}
+
+public:
+	BinaryRawTree(const BufferOwner &owner, const char *offsets, const char *strings, const char *begin)
+	: _owner(owner)
+	, _offsets(offsets)
+	, _strings(strings)
+	, _begin(begin)
+	{ }
+
+	virtual void walk(InfoHandler &handler) const
+	{
+		// the data of the extraData node itself is not part of the tree
+		const char *p = _begin + 8;
+		walkChildren(p, readU32(_begin + 4), handler);
+	}
+
+	/**
+	 * Appends the encoded tree to out, with string indices from intern,
+	 * which maps a StringRef to its index in the document being written.
+	 */
+	template <typename Intern>
+	void transcode(std::string &out, Intern intern) const
+	{
+		const char *p = _begin;
+		transcodeNode(p, out, intern);
+	}
+};
+
+class Writer
+{
+	std::vector<const std::string *> _strings;
+	std::unordered_map<std::string, quint32> _stringIndex;
+	std::string _records, _dependencies, _extra;
+	quint32 _itemCount, _dependencyCount;
+
+	static void put32(std::string &buf, quint32 value)
+	{
+		uchar bytes[4];
+		qToLittleEndian(value, bytes);
+		buf.append(reinterpret_cast<const char *>(bytes), 4);
+	}
+
+	static void putDouble(std::string &buf, double value)
+	{
+		quint64 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		uchar bytes[8];
+		qToLittleEndian(bits, bytes);
+		buf.append(reinterpret_cast<const char *>(bytes), 8);
+	}
+
+	static void putUuid(std::string &buf, const QUuid &uuid)
+	{
+		uchar bytes[UuidSize];
+		qToLittleEndian(quint32(uuid.data1), bytes);
+		qToLittleEndian(quint16(uuid.data2), bytes + 4);
+		qToLittleEndian(quint16(uuid.data3), bytes + 6);
+		std::memcpy(bytes + 8, uuid.data4, 8);
+		buf.append(reinterpret_cast<const char *>(bytes), UuidSize);
+	}
+
+	quint32 intern(const std::string &s)
+	{
+		auto result = _stringIndex.insert({s, quint32(_strings.size())});
+		if(result.second)
+		{
+			_strings.push_back(&result.first->first);
+		}
+		return result.first->second;
+	}
+
+	void encodeTree(const ptree &node)
+	{
+		put32(_extra, intern(node.data()));
+		put32(_extra, quint32(node.size()));
+		for(const auto &child : node)
+		{
+			put32(_extra, intern(child.first));
+			encodeTree(child.second);
+		}
+	}
+
+public:
+	Writer()
+	: _itemCount(0)
+	, _dependencyCount(0)
+	{
+		intern("");
+	}
+
+	void add(const ModelSnapshot &model)
+	{
+		const auto extraStart = _extra.size();
+		if(auto raw = dynamic_cast<const BinaryRawTree *>(model.rawExtraData.get()))
+		{
+			raw->transcode(_extra, [&](StringRef s) { return intern(s.str()); });
+		}
+		else
+		{
+			ptree extraData;
+			model.saveExtraData(extraData);
+			encodeTree(extraData);
+		}
+
+		putUuid(_records, model.uuid);
+		put32(_records, intern(model.kind.toStdString()));
+		put32(_records, model.connection? HasConnection : 0);
+		putDouble(_records, model.scenePos.x());
+		putDouble(_records, model.scenePos.y());
+		putDouble(_records, model.rotation);
+		putDouble(_records, model.sceneZ);
+		put32(_records, _dependencyCount);
+		put32(_records, model.dependencies.size());
+		put32(_records, extraStart);
+		put32(_records, _extra.size() - extraStart);
+
+		const Connection conn = model.connection.get_value_or(Connection{QUuid(), 0, QUuid(), 0, 0.5});
+		putUuid(_records, conn.src);
+		putUuid(_records, conn.dst);
+		put32(_records, quint32(conn.srcPort));
+		put32(_records, quint32(conn.dstPort));
+		putDouble(_records, conn.center);
+
+		for(const auto &dep : model.dependencies)
+		{
+			putUuid(_dependencies, dep);
+			++_dependencyCount;
+		}
+
+		++_itemCount;
+	}
+
+	void write(std::ostream &os) const
+	{
+		std::string stringTable;
+		quint32 stringOffset = 0;
+		for(auto s : _strings)
+		{
+			put32(stringTable, stringOffset);
+			stringOffset += s->size();
+		}
+		put32(stringTable, stringOffset);
+		for(auto s : _strings)
+		{
+			stringTable += *s;
+		}
+
+		const quint32 stringsAt = HeaderSize;
+		const quint32 itemsAt = stringsAt + stringTable.size();
+		const quint32 dependenciesAt = itemsAt + _records.size();
+		const quint32 extraAt = dependenciesAt + _dependencies.size();
+		const quint32 fileSize = extraAt + _extra.size();
+
+		std::string header(BinaryDiagramLoader::Magic, sizeof(BinaryDiagramLoader::Magic));
+		put32(header, BinaryDiagramLoader::Version);
+		put32(header, _itemCount);
+		put32(header, _strings.size());
+		put32(header, stringsAt);
+		put32(header, itemsAt);
+		put32(header, dependenciesAt);
+		put32(header, extraAt);
+		put32(header, fileSize);
+
+		os.write(header.data(), header.size());
+		os.write(stringTable.data(), stringTable.size());
+		os.write(_records.data(), _records.size());
+		os.write(_dependencies.data(), _dependencies.size());
+		os.write(_extra.data(), _extra.size());
+	}
+};
+
+class Reader
+{
+	const char *_data;
+	size_t _size;
+	quint32 _itemCount, _stringCount;
+	size_t _stringsAt, _stringDataAt, _itemsAt, _dependenciesAt, _extraAt;
+	DiagramContext *_ctx;
+	mutable std::vector<const DiagramComponent *> _kinds;
+
+	static void fail(const char *what)
+	{
+		throw MalformedDocumentException(std::string("malformed binary document: ") + what);
+	}
+
+	void check(size_t offset, size_t length, const char *what) const
+	{
+		if(offset > _size || length > _size - offset)
+		{
+			fail(what);
+		}
+	}
+
+	quint32 u32(size_t offset) const
+	{
+		return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(_data + offset));
+	}
+
+	double f64(size_t offset) const
+	{
+		quint64 bits = qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(_data + offset));
+		double result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	QUuid uuid(size_t offset) const
+	{
+		auto p = reinterpret_cast<const uchar *>(_data + offset);
+		return QUuid(qFromLittleEndian<quint32>(p),
+		             qFromLittleEndian<quint16>(p + 4),
+		             qFromLittleEndian<quint16>(p + 6),
+		             p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15]);
+	}
+
+	StringRef stringRef(quint32 index) const
+	{
+		if(index >= _stringCount) fail("string index out of range");
+
+		size_t begin = u32(_stringsAt + 4 * index);
+		size_t end = u32(_stringsAt + 4 * (index + 1));
+		if(begin > end) fail("string table");
+		check(_stringDataAt + begin, end - begin, "string table");
+
+		return StringRef(_data + _stringDataAt + begin, end - begin);
+	}
+
+	std::string string(quint32 index) const
+	{
+		return stringRef(index).str();
+	}
+
+	const DiagramComponent *kind(quint32 index) const
+	{
+		if(index >= _stringCount) fail("kind index out of range");
+
+		if(!_kinds[index])
+		{
+			_kinds[index] = _ctx->kind(QString::fromStdString(string(index)));
+		}
+		return _kinds[index];
+	}
+
+	void decodeTree(size_t &pos, size_t end, ptree &node, int depth) const
+	{
+		if(depth > MaxTreeDepth) fail("extra data nested too deeply");
+		if(pos + 8 > end) fail("extra data truncated");
+
+		node.data() = string(u32(pos));
+		quint32 childCount = u32(pos + 4);
+		pos += 8;
+
+		for(quint32 i = 0; i < childCount; ++i)
+		{
+			if(pos + 4 > end) fail("extra data truncated");
+			auto key = string(u32(pos));
+			pos += 4;
+
+			auto &child = node.push_back(ptree::value_type(key, ptree()))->second;
+			decodeTree(pos, end, child, depth + 1);
+		}
+	}
+
+	/// Checks a node as decodeTree() would, without building it.
+	void skipTree(size_t &pos, size_t end, int depth) const
+	{
+		if(depth > MaxTreeDepth) fail("extra data nested too deeply");
+		if(pos + 8 > end) fail("extra data truncated");
+
+		stringRef(u32(pos));
+		quint32 childCount = u32(pos + 4);
+		pos += 8;
+
+		for(quint32 i = 0; i < childCount; ++i)
+		{
+			if(pos + 4 > end) fail("extra data truncated");
+			stringRef(u32(pos));
+			pos += 4;
+			skipTree(pos, end, depth + 1);
+		}
+	}
+
+	/**
+	 * Decodes the eager children of an extraData tree into node and checks
+	 * the rest, which is then read through the returned tree.
+	 */
+	RawTreePtr decodeLazyTree(size_t &pos, size_t end, ptree &node, const BufferOwner &owner) const
+	{
+		const size_t begin = pos;
+		if(pos + 8 > end) fail("extra data truncated");
+
+		node.data() = string(u32(pos));
+		quint32 childCount = u32(pos + 4);
+		pos += 8;
+
+		for(quint32 i = 0; i < childCount; ++i)
+		{
+			if(pos + 4 > end) fail("extra data truncated");
+			auto key = stringRef(u32(pos));
+			pos += 4;
+
+			if(isEagerExtraDataKey(key.data, key.size))
+			{
+				auto &child = node.push_back(ptree::value_type(key.str(), ptree()))->second;
+				decodeTree(pos, end, child, 1);
+			}
+			else
+			{
+				skipTree(pos, end, 1);
+			}
+		}
+
+		return std::make_shared<BinaryRawTree>(owner, _data + _stringsAt, _data + _stringDataAt, _data + begin);
+	}
+
+public:
+	Reader(const char *data, size_t size, DiagramContext *ctx)
+	: _data(data)
+	, _size(size)
+	, _ctx(ctx)
+	{
+		if(size < HeaderSize || std::memcmp(data, BinaryDiagramLoader::Magic, sizeof(BinaryDiagramLoader::Magic)) != 0)
+		{
+			fail("bad magic");
+		}
+
+		if(u32(VersionOffset) > BinaryDiagramLoader::Version)
+		{
+			throw MalformedDocumentException("the document was written by a newer version of the application");
+		}
+
+		if(u32(FileSizeOffset) != size) fail("size mismatch");
+
+		_itemCount = u32(ItemCountOffset);
+		_stringCount = u32(StringCountOffset);
+		_stringsAt = u32(StringTableOffset);
+		_itemsAt = u32(ItemsOffset);
+		_dependenciesAt = u32(DependenciesOffset);
+		_extraAt = u32(ExtraOffset);
+
+		check(_stringsAt, 4 * (size_t(_stringCount) + 1), "string table");
+		_stringDataAt = _stringsAt + 4 * (size_t(_stringCount) + 1);
+		check(_itemsAt, size_t(_itemCount) * ItemRecordSize, "item records");
+		check(_dependenciesAt, 0, "dependency table");
+		check(_extraAt, 0, "extra data");
+
+		_kinds.resize(_stringCount, nullptr);
+	}
+
+	quint32 itemCount() const
+	{
+		return _itemCount;
+	}
+
+	/**
+	 * Decodes item i without resolving its kind. Given an owner of the
+	 * document, the extraData is kept raw as far as it can be.
+	 */
+	void record(quint32 i, DiagramItemRecord &out, const BufferOwner &owner=BufferOwner()) const
+	{
+		const size_t rec = _itemsAt + size_t(i) * ItemRecordSize;
+
+		out.clear();
+		out.uuid = uuid(rec + RecUuid);
+		out.kind = string(u32(rec + RecKind));
+		out.scenePos = QPointF(f64(rec + RecPosX), f64(rec + RecPosY));
+		out.rotation = f64(rec + RecRotation);
+		out.sceneZ = f64(rec + RecSceneZ);
+
+		const size_t depFirst = u32(rec + RecDepFirst);
+		const size_t depCount = u32(rec + RecDepCount);
+		check(_dependenciesAt + depFirst * UuidSize, depCount * UuidSize, "dependency range");
+		out.dependencies.reserve(depCount);
+		for(size_t d = 0; d < depCount; ++d)
+		{
+			out.dependencies.push_back(uuid(_dependenciesAt + (depFirst + d) * UuidSize));
+		}
+
+		size_t extraPos = _extraAt + u32(rec + RecExtraOffset);
+		const size_t extraSize = u32(rec + RecExtraSize);
+		check(extraPos, extraSize, "extra data range");
+		if(owner)
+		{
+			out.rawExtraData = decodeLazyTree(extraPos, extraPos + extraSize, out.extraData, owner);
+			// the raw tree cannot carry the data of the root
+			if(!out.extraData.data().empty())
+			{
+				out.rawExtraData.reset();
+				out.extraData.clear();
+				extraPos = _extraAt + u32(rec + RecExtraOffset);
+				decodeTree(extraPos, extraPos + extraSize, out.extraData, 0);
+			}
+		}
+		else
+		{
+			decodeTree(extraPos, extraPos + extraSize, out.extraData, 0);
+		}
+
+		if(u32(rec + RecFlags) & HasConnection)
+		{
+			out.connection = Connection {
+				uuid(rec + RecConnSrc),
+				qint32(u32(rec + RecConnSrcPort)),
+				uuid(rec + RecConnDst),
+				qint32(u32(rec + RecConnDstPort)),
+				f64(rec + RecConnCenter)
+			};
+		}
+	}
+
+	DiagramItemModel *model(quint32 i, QObject *parent) const
+	{
+		const size_t rec = _itemsAt + size_t(i) * ItemRecordSize;
+
+		DiagramItemRecord item;
+		record(i, item);
+		return item.createModel(kind(u32(rec + RecKind)), _ctx, parent);
+	}
+};
+
+std::string readAll(std::istream &is)
+{
+	return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+}  // anonymous namespace
+
+BinaryDiagramLoader::BinaryDiagramLoader(DiagramContext *ctx, QObject* parent)
+: QObject(parent)
+, _ctx(ctx)
+{
+}
+
+QList<DiagramItem *> BinaryDiagramLoader::load(const char *data, size_t size, DiagramScene *scene) const
+{
+	QList<DiagramItem *> results;
+
+	Reader reader(data, size, scene->context());
+	for(quint32 i = 0; i < reader.itemCount(); ++i)
+	{
+		auto model = reader.model(i, nullptr);
+		auto item = model->kind()->createFromModel(model);
+		scene->addDiagramItem(item);
+
+		results << item;
+	}
+
+	return results;
+}
+
+QList<DiagramItemModel *> BinaryDiagramLoader::loadModels(const char *data, size_t size, QObject *parent) const
+{
+	QList<DiagramItemModel *> results;
+
+	Reader reader(data, size, _ctx);
+	for(quint32 i = 0; i < reader.itemCount(); ++i)
+	{
+		results << reader.model(i, parent);
+	}
+
+	return results;
+}
+
+void BinaryDiagramLoader::readRecords(const char *data, size_t size,
+                                      const std::function<void (DiagramItemRecord &)> &fn,
+                                      const BufferOwner &owner)
+{
+	Reader reader(data, size, nullptr);
+	DiagramItemRecord record;
+	for(quint32 i = 0; i < reader.itemCount(); ++i)
+	{
+		reader.record(i, record, owner);
+		fn(record);
+	}
+}
+
+QList<DiagramItem *> BinaryDiagramLoader::load(std::istream &is, DiagramScene *scene) const
+{
+	auto data = readAll(is);
+	return load(data.data(), data.size(), scene);
+}
+
+QList<DiagramItemModel *> BinaryDiagramLoader::loadModels(std::istream &is, QObject *parent) const
+{
+	auto data = readAll(is);
+	return loadModels(data.data(), data.size(), parent);
+}
+
+void BinaryDiagramLoader::save(std::ostream &os, const QList<DiagramItem *> &items) const
+{
+	Writer writer;
+	for(auto item : items)
+	{
+		writer.add(item->model()->snapshot());
+	}
+
+	writer.write(os);
+}
+
+void BinaryDiagramLoader::saveModels(std::ostream &os, const QList<DiagramItemModel *> &models) const
+{
+	Writer writer;
+	for(auto model : models)
+	{
+		writer.add(model->snapshot());
+	}
+
+	writer.write(os);
+}
+
+void BinaryDiagramLoader::saveSnapshots(std::ostream &os, const std::vector<ModelSnapshot> &models) const
+{
+	Writer writer;
+	for(const auto &model : models)
+	{
+		writer.add(model);
+	}
+
+	writer.write(os);
+}
+
+BinaryDiagramLoader::~BinaryDiagramLoader()
+{
+}
+} // namespace dbuilder
@@ -0,0 +1,87 @@
+#pragma once
+/**
+ * @file   BinaryDiagramLoader.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QObject>
+#include <functional>
+#include "DiagramLoader.hpp"
+#include "DiagramItemModel.hpp"
+#include "CoreForward.hpp"
+#include "Exceptions.hpp"
+
+
+namespace dbuilder {
+
+struct DiagramItemRecord;
+
+DBDefineException(MalformedDocumentException, "the document is malformed");
+
+/**
+ * Reads and writes the binary document format.
+ *
+ * All integers are little-endian. The file consists of:
+ *
+ *  - a 40-byte header: the 8-byte magic, format version, item count,
+ *    string count, and the offsets of the sections below
+ *  - the string table: (string count + 1) u32 offsets into the UTF-8
+ *    bytes that follow them
+ *  - the item records, ItemRecordSize bytes each, holding the raw 16-byte
+ *    UUID, kind (a string index), position, rotation, z, connection and
+ *    the ranges of the item's dependencies and extra data
+ *  - the dependency table: raw 16-byte UUIDs
+ *  - the extra data section: each item's extraData tree, encoded as
+ *    (data string, child count, then key string and node per child)
+ *
+ * The pointer overloads of load() and loadModels(), and readRecords(),
+ * read a document in place from any buffer, without copying it. Lazily
+ * decoded extraData keeps referring to that buffer, so DocumentOpener reads
+ * documents into a QByteArray rather than mapping them: a file overwritten
+ * in place would change, or fault, under items that still refer to it.
+ * Opening a binary document therefore costs one copy of the file.
+ */
+class BinaryDiagramLoader: public QObject, public DiagramLoader
+{
+	Q_OBJECT
+	DiagramContext *_ctx;
+public:
+	static const char Magic[8];
+	static const quint32 Version = 1;
+
+	BinaryDiagramLoader(DiagramContext *ctx, QObject *parent=nullptr);
+
+	virtual QList<DiagramItem *> load(std::istream &, DiagramScene *) const;
+	virtual void save(std::ostream &, const QList<DiagramItem *> &) const;
+
+	virtual QList<DiagramItemModel *> loadModels(std::istream &, QObject *parent=nullptr) const;
+	virtual void saveModels(std::ostream &, const QList<DiagramItemModel *> &) const;
+	virtual void saveSnapshots(std::ostream &, const std::vector<ModelSnapshot> &) const;
+
+	/**
+	 * @throws MalformedDocumentException
+	 */
+	QList<DiagramItem *> load(const char *data, size_t size, DiagramScene *) const;
+	/**
+	 * @throws MalformedDocumentException
+	 */
+	QList<DiagramItemModel *> loadModels(const char *data, size_t size, QObject *parent=nullptr) const;
+
+	/**
+	 * Decodes each item into a record without creating any QObjects, so it
+	 * may be called from any thread. The record passed to fn is reused.
+	 *
+	 * If owner is given, it must keep data alive, and each record's
+	 * extraData is left encoded in data except for its eager children.
+	 *
+	 * @throws MalformedDocumentException
+	 */
+	static void readRecords(const char *data, size_t size,
+	                        const std::function<void (DiagramItemRecord &)> &fn,
+	                        const BufferOwner &owner=BufferOwner());
+
+	virtual ~BinaryDiagramLoader();
+};
+} // namespace dbuilder
@@ -4,6 +4,7 @@
  */
 
 #include "ComponentFile.hpp"
+#include "InfoReader.hpp"
 #include <boost/property_tree/info_parser.hpp>
 #include <boost/timer.hpp>
 #include "Util/Log.hpp"
@@ -20,6 +21,11 @@ ComponentFile::ComponentFile(std::istream& is)
 	read(is);
 }
 
+ComponentFile::ComponentFile(const boost::property_tree::ptree &tree)
+: pt(tree)
+{
+}
+
 ComponentFile::ComponentFile()
 {
 	pt.put("resource-info.kind", "components");
@@ -147,7 +153,7 @@ ComponentSpec ComponentFile::component(const boost::property_tree::ptree &subtre
 
 void ComponentFile::read(std::istream &is)
 {
-	boost::property_tree::read_info(is, pt);
+	readInfo(is, pt);
 }
 
 boost::optional<const boost::property_tree::ptree&> ComponentFile::findAbstract(const std::string& name) const
@@ -25,6 +25,8 @@ class ComponentFile
 	boost::property_tree::ptree pt;
 public:
 	ComponentFile(std::istream &is);
+	/// Takes the entries of an already parsed file.
+	explicit ComponentFile(const boost::property_tree::ptree &tree);
 	ComponentFile();
 	virtual ~ComponentFile();
 
@@ -0,0 +1,476 @@
+/**
+ * @file   ComponentIndex.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "ComponentIndex.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QCryptographicHash>
+#include <sstream>
+#include <map>
+#include <boost/property_tree/info_parser.hpp>
+#include <boost/lexical_cast.hpp>
+#include "InfoReader.hpp"
+#include "DiagramContext.hpp"
+#include "Util/Log.hpp"
+#include "Util/Translators.hpp"
+
+namespace dbuilder {
+
+namespace {
+
+namespace pt = boost::property_tree;
+
+QByteArray sha1(const QByteArray &data)
+{
+	return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/**
+ * Finds the byte range of each top-level entry of an INFO document. An
+ * entry runs from the start of the line of its key to its closing brace,
+ * or to the line of the next top-level key if it has no children.
+ */
+class TopLevelScanner: public InfoHandler
+{
+public:
+	struct Entry
+	{
+		std::string key, data;
+		const char *begin, *end;
+	};
+
+	std::vector<Entry> entries;
+	/// whether the document #includes another; if so the ranges are useless
+	bool included;
+
+private:
+	const char *_begin, *_end;
+	const char *_line, *_brace;
+	int _depth;
+	bool _closed;
+
+public:
+	TopLevelScanner(const char *begin, const char *end)
+	: included(false)
+	, _begin(begin)
+	, _end(end)
+	, _line(begin)
+	, _brace(nullptr)
+	, _depth(0)
+	, _closed(false)
+	{ }
+
+	virtual void key(StringRef key)
+	{
+		if(_depth != 0) return;
+
+		const char *begin = _line;
+		if(!entries.empty())
+		{
+			if(!_closed)
+			{
+				entries.back().end = _line;
+			}
+			begin = std::max(begin, entries.back().end);
+		}
+		entries.push_back(Entry{key.str(), std::string(), begin, _end});
+		_closed = false;
+	}
+
+	virtual void data(StringRef data)
+	{
+		if(_depth == 0 && !entries.empty()) entries.back().data = data.str();
+	}
+
+	virtual void appendData(StringRef data)
+	{
+		if(_depth == 0 && !entries.empty()) entries.back().data += data.str();
+	}
+
+	virtual void open()
+	{
+		++_depth;
+	}
+
+	virtual void close()
+	{
+		if(--_depth == 0 && !entries.empty() && _brace)
+		{
+			entries.back().end = _brace + 1;
+			_closed = true;
+		}
+	}
+
+	virtual void beginLine(const char *line)
+	{
+		// lines of included files are somewhere else
+		if(line >= _begin && line <= _end) _line = line;
+	}
+
+	virtual void brace(const char *pos)
+	{
+		_brace = (pos >= _begin && pos < _end)? pos : nullptr;
+	}
+
+	virtual void beginInclude()
+	{
+		included = true;
+	}
+};
+
+QByteArray readRange(QFile &file, qint64 offset, qint64 length)
+{
+	if(offset < 0 || !file.seek(offset)) return QByteArray();
+	return file.read(length);
+}
+
+/// Parses the concatenated entries of a component and its abstract.
+ComponentSpec parseComponent(const QByteArray &entries)
+{
+	pt::ptree root;
+	readInfo(entries.constData(), entries.constData() + entries.size(), root);
+	auto specs = ComponentFile(root).components();
+	if(specs.isEmpty())
+	{
+		throw KindDoesNotExistException("the indexed range holds no component");
+	}
+	return specs.front();
+}
+
+std::string pointString(const QPointF &point)
+{
+	std::stringstream ss;
+	ss << point.x() << ' ' << point.y();
+	return ss.str();
+}
+
+}  // namespace
+
+const int ComponentIndex::Version;
+
+ComponentIndex::ComponentIndex(const QString &path)
+: _path(path)
+, _dirty(false)
+{
+}
+
+bool ComponentIndex::indexFile(const QString &file, const QByteArray &contents, SourceFile &result)
+{
+	const char *begin = contents.constData(), *end = begin + contents.size();
+	TopLevelScanner scanner(begin, end);
+	InfoReader().read(begin, end, scanner, file.toStdString());
+
+	result.entries.clear();
+	if(scanner.included)
+	{
+		// the ranges of included entries are not in contents
+		pt::ptree tree;
+		readInfo(begin, end, tree);
+		for(const auto &spec : ComponentFile(tree).components())
+		{
+			ComponentIndexEntry indexed;
+			indexed.name = spec.name;
+			indexed.file = file;
+			indexed.ports = spec.ports;
+			result.entries.push_back(indexed);
+		}
+		return false;
+	}
+
+	std::map<std::string, const TopLevelScanner::Entry *> abstracts;
+	for(const auto &entry : scanner.entries)
+	{
+		// ComponentFile::findAbstract() takes the first one
+		if(entry.key == "abstract") abstracts.insert({entry.data, &entry});
+	}
+
+	for(const auto &entry : scanner.entries)
+	{
+		if(entry.key != "component") continue;
+
+		ComponentIndexEntry indexed;
+		indexed.file = file;
+		indexed.offset = entry.begin - begin;
+		indexed.length = entry.end - entry.begin;
+
+		QByteArray bytes(entry.begin, entry.end - entry.begin);
+
+		pt::ptree own;
+		readInfo(entry.begin, entry.end, own);
+		if(auto extends = own.get_optional<std::string>("component.extends"))
+		{
+			auto abstract = abstracts.find(*extends);
+			if(abstract != abstracts.end())
+			{
+				indexed.abstractOffset = abstract->second->begin - begin;
+				indexed.abstractLength = abstract->second->end - abstract->second->begin;
+				bytes.append(abstract->second->begin, indexed.abstractLength);
+			}
+		}
+
+		const auto spec = parseComponent(bytes);
+		indexed.name = spec.name;
+		indexed.ports = spec.ports;
+		indexed.hash = sha1(bytes);
+		result.entries.push_back(indexed);
+	}
+
+	return true;
+}
+
+void ComponentIndex::load()
+{
+	QFile file(_path);
+	if(!file.open(QIODevice::ReadOnly)) return;
+	const auto data = file.readAll();
+
+	pt::ptree tree;
+	try
+	{
+		readInfo(data.constData(), data.constData() + data.size(), tree);
+	}
+	catch(const pt::ptree_error &exc)
+	{
+		DBWarning("Ignoring unreadable component index ", _path, ": ", exc.what());
+		return;
+	}
+
+	if(tree.get("version", 0) != Version)
+	{
+		DBInfo("Ignoring component index ", _path, " of another version");
+		return;
+	}
+
+	static const pt::ptree NoPorts;
+	_files.clear();
+	for(const auto &fileKV : tree)
+	{
+		if(fileKV.first != "file") continue;
+		const auto &fileTree = fileKV.second;
+
+		SourceFile source;
+		const auto path = fileTree.get_value<QString>();
+		source.size = fileTree.get<qint64>("size", -1);
+		source.modified = fileTree.get<qint64>("modified", -1);
+		source.hash = QByteArray::fromHex(fileTree.get<std::string>("hash", "").c_str());
+
+		for(const auto &componentKV : fileTree)
+		{
+			if(componentKV.first != "component") continue;
+			const auto &componentTree = componentKV.second;
+
+			ComponentIndexEntry entry;
+			entry.name = componentTree.get_value<QString>();
+			entry.file = path;
+			entry.offset = componentTree.get<qint64>("offset", -1);
+			entry.length = componentTree.get<qint64>("length", 0);
+			entry.abstractOffset = componentTree.get<qint64>("abstract-offset", -1);
+			entry.abstractLength = componentTree.get<qint64>("abstract-length", 0);
+			entry.hash = QByteArray::fromHex(componentTree.get<std::string>("hash", "").c_str());
+			for(const auto &port : componentTree.get_child("ports", NoPorts))
+			{
+				entry.ports << port.second.get_value<QPointF>(SimplePointFTranslator());
+			}
+			source.entries.push_back(entry);
+		}
+
+		_files[path] = source;
+	}
+	_dirty = false;
+	DBDebug("Read component index ", _path, " with ", _files.size(), " files");
+}
+
+bool ComponentIndex::save()
+{
+	if(!_dirty) return true;
+
+	pt::ptree tree;
+	tree.put("version", Version);
+	for(auto it = _files.begin(), end = _files.end(); it != end; ++it)
+	{
+		const SourceFile &source = *it;
+		pt::ptree fileTree;
+		fileTree.put_value(it.key().toStdString());
+		fileTree.put("size", source.size);
+		fileTree.put("modified", source.modified);
+		fileTree.put("hash", source.hash.toHex().constData());
+
+		for(const auto &entry : source.entries)
+		{
+			pt::ptree componentTree;
+			componentTree.put_value(entry.name.toStdString());
+			componentTree.put("offset", entry.offset);
+			componentTree.put("length", entry.length);
+			if(entry.abstractOffset >= 0)
+			{
+				componentTree.put("abstract-offset", entry.abstractOffset);
+				componentTree.put("abstract-length", entry.abstractLength);
+			}
+			componentTree.put("hash", entry.hash.toHex().constData());
+
+			pt::ptree portTree;
+			int i = 0;
+			for(const auto &port : entry.ports)
+			{
+				portTree.put(boost::lexical_cast<std::string>(i++), pointString(port));
+			}
+			componentTree.put_child("ports", portTree);
+			fileTree.add_child("component", componentTree);
+		}
+		tree.add_child("file", fileTree);
+	}
+
+	std::stringstream ss;
+	pt::info_parser::write_info(ss, tree);
+	const auto data = ss.str();
+
+	QDir().mkpath(QFileInfo(_path).absolutePath());
+	const QString tempPath = _path + ".tmp";
+	QFile file(tempPath);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+	   || file.write(data.data(), data.size()) != qint64(data.size()))
+	{
+		DBWarning("Cannot write component index ", tempPath, ": ", file.errorString());
+		return false;
+	}
+	file.close();
+
+	QFile::remove(_path);
+	if(!QFile::rename(tempPath, _path))
+	{
+		DBWarning("Cannot replace component index ", _path);
+		return false;
+	}
+
+	_dirty = false;
+	return true;
+}
+
+std::vector<ComponentIndexEntry> ComponentIndex::update(const QStringList &files)
+{
+	std::vector<ComponentIndexEntry> result;
+	QMap<QString, SourceFile> current;
+
+	auto keep = [&](const QString &path, const SourceFile &source) {
+		current[path] = source;
+		result.insert(result.end(), source.entries.begin(), source.entries.end());
+	};
+
+	for(const auto &path : files)
+	{
+		// resources have no modification time; they are in memory anyway
+		const bool resource = path.startsWith(':');
+		const QFileInfo info(path);
+		const qint64 size = info.size();
+		const qint64 modified = resource? -1 : info.lastModified().toMSecsSinceEpoch();
+
+		auto previous = _files.find(path);
+		if(!resource && previous != _files.end()
+		   && previous->size == size && previous->modified == modified)
+		{
+			keep(path, *previous);
+			continue;
+		}
+
+		QFile file(path);
+		if(!file.open(QIODevice::ReadOnly))
+		{
+			DBError("Cannot open '", path, "' for reading.");
+			continue;
+		}
+		const auto contents = file.readAll();
+		const auto hash = sha1(contents);
+
+		if(previous != _files.end() && previous->hash == hash)
+		{
+			SourceFile source = *previous;
+			if(source.size != size || source.modified != modified)
+			{
+				source.size = size;
+				source.modified = modified;
+				_dirty = true;
+			}
+			keep(path, source);
+			continue;
+		}
+
+		SourceFile source;
+		source.size = size;
+		source.modified = modified;
+		source.hash = hash;
+		try
+		{
+			if(!indexFile(path, contents, source))
+			{
+				DBDebug(path, " includes other files and will be read whole");
+			}
+		}
+		catch(const std::exception &exc)
+		{
+			DBError("Cannot read components from '", path, "': ", exc.what());
+			continue;
+		}
+
+		DBInfo("Indexed ", source.entries.size(), " components in ", path);
+		keep(path, source);
+		_dirty = true;
+	}
+
+	if(current.size() != _files.size())
+	{
+		_dirty = true;
+	}
+	_files.swap(current);
+	return result;
+}
+
+ComponentSpec ComponentIndex::loadComponent(const ComponentIndexEntry &entry)
+{
+	QFile file(entry.file);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		throw KindDoesNotExistException(("cannot open " + entry.file + ": " + file.errorString()).toStdString());
+	}
+
+	if(entry.offset >= 0)
+	{
+		auto bytes = readRange(file, entry.offset, entry.length);
+		if(entry.abstractOffset >= 0)
+		{
+			bytes += readRange(file, entry.abstractOffset, entry.abstractLength);
+		}
+
+		if(sha1(bytes) == entry.hash)
+		{
+			try
+			{
+				auto spec = parseComponent(bytes);
+				if(spec.name == entry.name) return spec;
+			}
+			catch(const std::exception &exc)
+			{
+				DBWarning("Cannot read indexed component ", entry.name, ": ", exc.what());
+			}
+		}
+		DBInfo(entry.file, " changed since it was indexed; reading all of it");
+	}
+
+	file.seek(0);
+	const auto contents = file.readAll();
+	pt::ptree tree;
+	readInfo(contents.constData(), contents.constData() + contents.size(), tree);
+	for(const auto &spec : ComponentFile(tree).components())
+	{
+		if(spec.name == entry.name) return spec;
+	}
+
+	throw KindDoesNotExistException(("the component " + entry.name + " is no longer in " + entry.file).toStdString());
+}
+
+}  // namespace dbuilder
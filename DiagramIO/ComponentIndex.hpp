@@ -0,0 +1,105 @@
+#pragma once
+/**
+ * @file   ComponentIndex.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QPointF>
+#include <QMap>
+#include <vector>
+#include "ComponentFile.hpp"
+
+namespace dbuilder {
+
+/**
+ * Where one component of a component file is, and what it looks like
+ * without reading it.
+ */
+struct ComponentIndexEntry
+{
+	QString name;
+	QString file;
+	/// the byte range of its entry in file, or -1 if the whole file must be read
+	qint64 offset, length;
+	/// the byte range of the abstract component it extends, if any
+	qint64 abstractOffset, abstractLength;
+	QList<QPointF> ports;
+	/// SHA-1 of the bytes of both ranges
+	QByteArray hash;
+
+	ComponentIndexEntry()
+	: offset(-1)
+	, length(0)
+	, abstractOffset(-1)
+	, abstractLength(0)
+	{ }
+};
+
+/**
+ * A persistent index of the components in a set of component files.
+ *
+ * Each file is indexed once, by scanning its top-level entries. It is
+ * scanned again only if its size or modification time changed and its
+ * SHA-1 did too. Components can then be loaded one at a time with
+ * loadComponent(), which reads only their own entries.
+ */
+class ComponentIndex
+{
+	struct SourceFile
+	{
+		qint64 size;
+		qint64 modified;
+		QByteArray hash;
+		std::vector<ComponentIndexEntry> entries;
+	};
+
+	QString _path;
+	QMap<QString, SourceFile> _files;
+	bool _dirty;
+
+	static bool indexFile(const QString &file, const QByteArray &contents, SourceFile &result);
+
+public:
+	static const int Version = 1;
+
+	/**
+	 * @param path  where the index is kept between runs
+	 */
+	ComponentIndex(const QString &path);
+
+	/**
+	 * Reads the index kept at path. A missing or unreadable index is empty.
+	 */
+	void load();
+	/**
+	 * Writes the index back to path if update() changed it.
+	 *
+	 * @return false if it could not be written
+	 */
+	bool save();
+
+	/**
+	 * Brings the entries for files up to date and forgets every other
+	 * file.
+	 *
+	 * @return the components of files, in file order and then in order of
+	 * appearance
+	 */
+	std::vector<ComponentIndexEntry> update(const QStringList &files);
+
+	/**
+	 * Reads the component entry describes. If the file no longer matches
+	 * the index, the whole file is read and searched by name.
+	 *
+	 * @throws KindDoesNotExistException if the component is not found
+	 */
+	static ComponentSpec loadComponent(const ComponentIndexEntry &entry);
+};
+
+}  // namespace dbuilder
@@ -0,0 +1,176 @@
+/**
+ * @file   CompressedStream.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "CompressedStream.hpp"
+#include <QtEndian>
+#include <istream>
+#include <ostream>
+#include <cstring>
+#include <limits>
+
+namespace dbuilder {
+
+namespace compressed {
+
+const char Magic[8] = { 'D', 'B', 'Z', '1', '\r', '\n', '\x1a', '\n' };
+
+namespace {
+
+// larger blocks are refused rather than allocated
+const quint32 MaxBlockSize = 64 << 20;
+// zlib's worst-case growth of a block of MaxBlockSize, and the size prefix
+const quint32 MaxCompressedBlockSize = MaxBlockSize + (MaxBlockSize >> 8) + 4;
+
+void fail(const char *what)
+{
+	throw CompressedStreamException(std::string("damaged compressed data: ") + what);
+}
+
+/// Checks the size prefix that qCompress() puts before the zlib stream.
+void checkBlock(const char *data, quint32 size)
+{
+	if(size < 4) fail("block too short");
+	const quint32 expanded = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(data));
+	if(expanded == 0 || expanded > MaxBlockSize) fail("bad block size");
+}
+
+QByteArray uncompressBlock(const char *data, quint32 size)
+{
+	checkBlock(data, size);
+	QByteArray result = qUncompress(reinterpret_cast<const uchar *>(data), int(size));
+	if(result.isEmpty()) fail("bad block");
+	return result;
+}
+
+}  // namespace
+
+bool detect(const char *data, std::size_t size)
+{
+	return size >= sizeof(Magic) && std::memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+QByteArray decompress(const char *data, std::size_t size)
+{
+	if(!detect(data, size)) fail("no header");
+
+	// the blocks record their sizes, so the result is allocated once
+	std::size_t total = 0;
+	std::size_t pos = sizeof(Magic);
+	for(;;)
+	{
+		if(size - pos < 4) fail("truncated");
+		const quint32 length = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data + pos));
+		pos += 4;
+		if(length == 0) break;
+		if(size - pos < length) fail("truncated");
+		checkBlock(data + pos, length);
+		total += qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(data + pos));
+		pos += length;
+	}
+	if(total > std::size_t(std::numeric_limits<int>::max())) fail("too large");
+
+	QByteArray result;
+	result.reserve(int(total));
+	pos = sizeof(Magic);
+	for(;;)
+	{
+		const quint32 length = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data + pos));
+		pos += 4;
+		if(length == 0) break;
+		result.append(uncompressBlock(data + pos, length));
+		pos += length;
+	}
+	return result;
+}
+
+QByteArray decompressBlocks(std::istream &is)
+{
+	QByteArray result, block;
+	for(;;)
+	{
+		uchar length[4];
+		if(!is.read(reinterpret_cast<char *>(length), 4)) fail("truncated");
+		const quint32 size = qFromLittleEndian<quint32>(length);
+		if(size == 0) break;
+		if(size > MaxCompressedBlockSize) fail("bad block length");
+
+		block.resize(int(size));
+		if(!is.read(block.data(), size)) fail("truncated");
+		result.append(uncompressBlock(block.constData(), size));
+	}
+	return result;
+}
+
+}  // namespace compressed
+
+CompressingStreamBuf::CompressingStreamBuf(std::ostream &sink, int level, std::size_t blockSize)
+: _sink(sink)
+, _block(blockSize)
+, _level(level)
+, _finished(false)
+{
+	setp(_block.data(), _block.data() + _block.size());
+	_sink.write(compressed::Magic, sizeof(compressed::Magic));
+}
+
+CompressingStreamBuf::~CompressingStreamBuf()
+{
+	finish();
+}
+
+bool CompressingStreamBuf::writeBlock()
+{
+	const int size = int(pptr() - pbase());
+	if(size > 0)
+	{
+		QByteArray block = qCompress(reinterpret_cast<const uchar *>(pbase()), size, _level);
+		uchar length[4];
+		qToLittleEndian(quint32(block.size()), length);
+		_sink.write(reinterpret_cast<const char *>(length), 4);
+		_sink.write(block.constData(), block.size());
+	}
+	setp(_block.data(), _block.data() + _block.size());
+	return bool(_sink);
+}
+
+CompressingStreamBuf::int_type CompressingStreamBuf::overflow(int_type c)
+{
+	if(_finished || !writeBlock())
+	{
+		return traits_type::eof();
+	}
+	if(!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+	return traits_type::not_eof(c);
+}
+
+int CompressingStreamBuf::sync()
+{
+	// a partial block would cost compression; blocks are only written full
+	return _sink? 0 : -1;
+}
+
+bool CompressingStreamBuf::finish()
+{
+	if(_finished)
+	{
+		return bool(_sink);
+	}
+	_finished = true;
+
+	writeBlock();
+	static const char End[4] = { 0, 0, 0, 0 };
+	_sink.write(End, sizeof(End));
+	// nothing more is accepted
+	setp(nullptr, nullptr);
+	return bool(_sink.flush());
+}
+
+}  // namespace dbuilder
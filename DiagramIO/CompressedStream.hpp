@@ -0,0 +1,93 @@
+#pragma once
+/**
+ * @file   CompressedStream.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <streambuf>
+#include <iosfwd>
+#include <QByteArray>
+#include "Exceptions.hpp"
+
+namespace dbuilder {
+
+DBDefineException(CompressedStreamException, "the compressed data is damaged");
+
+/**
+ * The compressed container for documents and clipboard payloads.
+ *
+ * It consists of the 8-byte Magic followed by blocks, each a little-endian
+ * u32 length and that many bytes of qCompress() output, which starts with
+ * the big-endian size of the block's uncompressed data. A block of length
+ * zero ends the stream. Blocks are compressed independently, so a writer
+ * only ever holds one block of the uncompressed data.
+ */
+namespace compressed {
+
+extern const char Magic[8];
+const std::size_t DefaultBlockSize = 256 << 10;
+
+/**
+ * @return true if data starts with Magic
+ */
+bool detect(const char *data, std::size_t size);
+
+/**
+ * Decompresses a whole stream held in memory.
+ *
+ * @throws CompressedStreamException
+ */
+QByteArray decompress(const char *data, std::size_t size);
+
+/**
+ * Decompresses the blocks that follow Magic, reading them from is one at a
+ * time, so the compressed stream is never held whole. Magic must already
+ * have been read.
+ *
+ * @throws CompressedStreamException
+ */
+QByteArray decompressBlocks(std::istream &is);
+
+}  // namespace compressed
+
+/**
+ * Compresses what is written through it into a sink, one block at a time.
+ * The magic is written before the first block.
+ */
+class CompressingStreamBuf: public std::streambuf
+{
+	std::ostream &_sink;
+	std::vector<char> _block;
+	int _level;
+	bool _finished;
+
+	bool writeBlock();
+
+protected:
+	virtual int_type overflow(int_type c);
+	virtual int sync();
+
+public:
+	/**
+	 * @param level  the zlib compression level, or -1 for its default
+	 */
+	CompressingStreamBuf(std::ostream &sink, int level=-1,
+	                     std::size_t blockSize=compressed::DefaultBlockSize);
+	/// Calls finish(), ignoring errors.
+	virtual ~CompressingStreamBuf();
+
+	/**
+	 * Writes the last block and the end of the stream. Nothing may be
+	 * written afterwards.
+	 *
+	 * @return false if the sink failed
+	 */
+	bool finish();
+};
+
+}  // namespace dbuilder
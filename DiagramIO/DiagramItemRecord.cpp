@@ -0,0 +1,47 @@
+/**
+ * @file   DiagramItemRecord.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DiagramItemRecord.hpp"
+#include <memory>
+#include "DiagramItemModel.hpp"
+#include "DiagramContext.hpp"
+
+namespace dbuilder {
+
+DiagramItemModel *DiagramItemRecord::createModel(DiagramContext *ctx, QObject *parent)
+{
+	return createModel(ctx->kind(kind.c_str()), ctx, parent);
+}
+
+DiagramItemModel *DiagramItemRecord::createModel(const DiagramComponent *kind, DiagramContext *ctx, QObject *parent)
+{
+	std::unique_ptr<DiagramItemModel> result(new DiagramItemModel(ctx, parent));
+	result->setUuid(uuid);
+	result->setKind(kind);
+	result->setScenePos(scenePos);
+	result->setRotation(rotation);
+	result->setSceneZ(sceneZ);
+
+	for(const auto &dep : dependencies)
+	{
+		result->addDependency(dep);
+	}
+
+	// before the extraData, which would be parsed if the connection changed
+	if(connection)
+	{
+		result->setConnection(connection);
+	}
+
+	pt::ptree extra;
+	extra.swap(extraData);
+	result->loadExtraData(std::move(extra), std::move(rawExtraData));
+
+	return result.release();
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <QUuid>
+#include <QPointF>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/optional.hpp>
+#include "DiagramItemModel.hpp"
+#include "RawTree.hpp"
+#include "CoreForward.hpp"
+/**
+ * @file   DiagramItemRecord.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+class QObject;
+
+namespace dbuilder {
+
+/**
+ * The serialized fields of one DiagramItemModel, decoded but not yet bound
+ * to a DiagramContext. Readers fill these without touching Qt objects, so
+ * they may be produced off the main thread.
+ */
+struct DiagramItemRecord
+{
+	QUuid uuid;
+	std::string kind;
+	QPointF scenePos;
+	double rotation;
+	double sceneZ;
+	std::vector<QUuid> dependencies;
+	boost::property_tree::ptree extraData;
+	/// Set by readers that store the connection outside of extraData.
+	boost::optional<Connection> connection;
+	/// Set by readers given a BufferOwner. extraData then holds only the
+	/// eager children; this holds all of them.
+	RawTreePtr rawExtraData;
+
+	DiagramItemRecord()
+	: rotation(0)
+	, sceneZ(0)
+	{ }
+
+	void clear()
+	{
+		uuid = QUuid();
+		kind.clear();
+		scenePos = QPointF();
+		rotation = sceneZ = 0;
+		dependencies.clear();
+		extraData.clear();
+		connection = boost::none;
+		rawExtraData.reset();
+	}
+
+	/// Exchanges contents without copying extraData.
+	void swap(DiagramItemRecord &other)
+	{
+		std::swap(uuid, other.uuid);
+		kind.swap(other.kind);
+		std::swap(scenePos, other.scenePos);
+		std::swap(rotation, other.rotation);
+		std::swap(sceneZ, other.sceneZ);
+		dependencies.swap(other.dependencies);
+		extraData.swap(other.extraData);
+		std::swap(connection, other.connection);
+		rawExtraData.swap(other.rawExtraData);
+	}
+
+	/**
+	 * Creates a model from this record, moving extraData out of it.
+	 *
+	 * @throws KindDoesNotExistException if the kind is not registered with ctx
+	 */
+	DiagramItemModel *createModel(DiagramContext *ctx, QObject *parent=nullptr);
+	/**
+	 * Creates a model of an already resolved kind, ignoring the kind name.
+	 */
+	DiagramItemModel *createModel(const DiagramComponent *kind, DiagramContext *ctx, QObject *parent=nullptr);
+};
+
+}  // namespace dbuilder
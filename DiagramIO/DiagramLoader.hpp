@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include <vector>
 #include <QList>
 #include "CoreForward.hpp"
 /**
@@ -22,6 +23,12 @@ public:
 	virtual QList<DiagramItemModel *> loadModels(std::istream &, QObject *parent=nullptr) const = 0;
 	virtual void saveModels(std::ostream &, const QList<DiagramItemModel *> &) const = 0;
 
+	/**
+	 * Writes a document from snapshots taken with DiagramItemModel::snapshot().
+	 * Touches no QObjects, so it may be called from any thread.
+	 */
+	virtual void saveSnapshots(std::ostream &, const std::vector<ModelSnapshot> &) const = 0;
+
 	virtual ~DiagramLoader() { }
 };
 } // namespace dbuilder
@@ -0,0 +1,599 @@
+/**
+ * @file   DocumentChecker.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DocumentChecker.hpp"
+#include <ostream>
+#include <sstream>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include "DiagramContext.hpp"
+#include "DiagramComponent.hpp"
+#include "DiagramItemModel.hpp"
+#include "Util/UUIDIndex.hpp"
+#include "Util/UUIDTranslator.hpp"
+#include "DocumentReader.hpp"
+
+namespace dbuilder {
+
+namespace {
+
+/// A resolved reference into an item, from the item it depends on.
+struct Edge
+{
+	std::uint32_t item;
+	bool connection;
+};
+
+const int PortsUnknown = -1;
+const int PortsUncounted = -2;
+
+/**
+ * @return the connection of record, wherever the reader left it
+ */
+optional<Connection> connectionOf(const DiagramItemRecord &record, bool &malformed)
+{
+	malformed = false;
+	if(record.connection)
+	{
+		return record.connection;
+	}
+
+	auto tree = record.extraData.get_child_optional("connection");
+	if(!tree)
+	{
+		return boost::none;
+	}
+
+	auto src = tree->get_optional<QUuid>("src");
+	auto dst = tree->get_optional<QUuid>("dst");
+	auto srcPort = tree->get_optional<int>("srcPort");
+	auto dstPort = tree->get_optional<int>("dstPort");
+	if(!src || !dst || !srcPort || !dstPort)
+	{
+		malformed = true;
+		return boost::none;
+	}
+
+	return Connection{*src, *srcPort, *dst, *dstPort, tree->get("center", 0.5)};
+}
+
+void writeJsonString(std::ostream &os, const std::string &str)
+{
+	static const char hex[] = "0123456789abcdef";
+	os << '"';
+	for(unsigned char c : str)
+	{
+		switch(c)
+		{
+		case '"':  os << "\\\""; break;
+		case '\\': os << "\\\\"; break;
+		case '\n': os << "\\n"; break;
+		case '\r': os << "\\r"; break;
+		case '\t': os << "\\t"; break;
+		default:
+			if(c < 0x20)
+			{
+				os << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+			}
+			else
+			{
+				os << c;
+			}
+		}
+	}
+	os << '"';
+}
+
+std::string uuidString(const QUuid &uuid)
+{
+	return uuid.toString().toStdString();
+}
+
+/**
+ * The state of one check, with the items in CSR form: the edges into item
+ * i are incoming[incomingStart[i] .. incomingStart[i + 1]) and the edges
+ * out of it are outgoing[outgoingStart[i] .. outgoingStart[i + 1]).
+ */
+class Checker
+{
+	const std::vector<DiagramItemRecord> &_records;
+	DiagramContext *_ctx;
+	DocumentCheckReport &_report;
+
+	UUIDIndex _index;
+	std::unordered_map<std::string, const DiagramComponent *> _kindCache;
+	std::vector<const DiagramComponent *> _kinds;
+	std::vector<int> _portCounts;
+	std::vector<bool> _removed;
+
+	std::vector<std::uint32_t> _incomingStart, _outgoingStart;
+	std::vector<Edge> _incoming, _outgoing;
+
+	void issue(DocumentIssue::Kind kind, DocumentIssue::Repair repair, size_t i,
+	           const QUuid &reference=QUuid(), int port=-1)
+	{
+		_report.issues.push_back(DocumentIssue(kind, repair, i, _records[i].uuid, reference, port));
+	}
+
+	void remove(DocumentIssue::Kind kind, size_t i, const QUuid &reference=QUuid(), int port=-1)
+	{
+		_removed[i] = true;
+		issue(kind, DocumentIssue::RemoveItem, i, reference, port);
+	}
+
+	const DiagramComponent *kindOf(const std::string &name)
+	{
+		auto it = _kindCache.find(name);
+		if(it == _kindCache.end())
+		{
+			// kind names are few, so each is looked up (and loaded) once
+			auto kind = _ctx->findKind(QString(name.c_str()));
+			it = _kindCache.emplace(name, kind).first;
+		}
+		return it->second;
+	}
+
+	int portCount(size_t i)
+	{
+		if(_portCounts[i] == PortsUncounted)
+		{
+			auto count = _kinds[i]? _kinds[i]->portCount(_records[i].extraData) : boost::none;
+			_portCounts[i] = count? *count : PortsUnknown;
+		}
+		return _portCounts[i];
+	}
+
+	bool portInRange(size_t end, int port)
+	{
+		const int count = portCount(end);
+		return port >= 0 && (count == PortsUnknown || port < count);
+	}
+
+	void indexItems();
+	void resolveReferences();
+	void buildOutgoing();
+	void cascade(std::vector<std::uint32_t> &queue, const std::vector<bool> *skip);
+	void breakCycles();
+
+public:
+	Checker(const std::vector<DiagramItemRecord> &records, DiagramContext *ctx, DocumentCheckReport &report)
+	: _records(records)
+	, _ctx(ctx)
+	, _report(report)
+	, _kinds(records.size(), nullptr)
+	, _portCounts(records.size(), PortsUncounted)
+	, _removed(records.size(), false)
+	{ }
+
+	void run()
+	{
+		_report.itemCount = _records.size();
+		indexItems();
+		resolveReferences();
+		buildOutgoing();
+
+		std::vector<std::uint32_t> queue;
+		for(size_t i = 0; i < _records.size(); ++i)
+		{
+			if(_removed[i]) queue.push_back(i);
+		}
+		cascade(queue, nullptr);
+		breakCycles();
+	}
+};
+
+void Checker::indexItems()
+{
+	_index.reserve(_records.size());
+	for(size_t i = 0; i < _records.size(); ++i)
+	{
+		const auto &record = _records[i];
+		if(_index.contains(record.uuid))
+		{
+			// references resolve to the first item with the UUID
+			remove(DocumentIssue::DuplicateItem, i);
+			continue;
+		}
+		_index.insert(record.uuid, i);
+
+		_kinds[i] = kindOf(record.kind);
+		if(!_kinds[i])
+		{
+			remove(DocumentIssue::UnknownKind, i);
+		}
+	}
+}
+
+void Checker::resolveReferences()
+{
+	_incomingStart.reserve(_records.size() + 1);
+	for(size_t i = 0; i < _records.size(); ++i)
+	{
+		_incomingStart.push_back(_incoming.size());
+		if(_removed[i])
+		{
+			continue;
+		}
+
+		const auto &record = _records[i];
+		bool malformed;
+		const auto conn = connectionOf(record, malformed);
+		UUIDIndex::value_type src = UUIDIndex::NotFound, dst = UUIDIndex::NotFound;
+		if(malformed)
+		{
+			remove(DocumentIssue::MalformedConnection, i);
+			continue;
+		}
+		else if(conn)
+		{
+			src = _index.find(conn->src);
+			dst = _index.find(conn->dst);
+			if(src == UUIDIndex::NotFound)
+			{
+				remove(DocumentIssue::DanglingConnection, i, conn->src);
+				continue;
+			}
+			if(dst == UUIDIndex::NotFound)
+			{
+				remove(DocumentIssue::DanglingConnection, i, conn->dst);
+				continue;
+			}
+			if(!portInRange(src, conn->srcPort))
+			{
+				remove(DocumentIssue::PortOutOfRange, i, conn->src, conn->srcPort);
+				continue;
+			}
+			if(!portInRange(dst, conn->dstPort))
+			{
+				remove(DocumentIssue::PortOutOfRange, i, conn->dst, conn->dstPort);
+				continue;
+			}
+		}
+
+		// the model adds both ends of its connection to its dependencies
+		bool srcListed = false, dstListed = false;
+		for(const auto &dep : record.dependencies)
+		{
+			const auto d = _index.find(dep);
+			if(d == UUIDIndex::NotFound)
+			{
+				issue(DocumentIssue::DanglingDependency, DocumentIssue::DropDependency, i, dep);
+				continue;
+			}
+			const bool isEnd = d == src || d == dst;
+			srcListed = srcListed || d == src;
+			dstListed = dstListed || d == dst;
+			_incoming.push_back(Edge{d, isEnd});
+		}
+		if(conn && !srcListed)
+		{
+			_incoming.push_back(Edge{src, true});
+		}
+		if(conn && !dstListed && dst != src)
+		{
+			_incoming.push_back(Edge{dst, true});
+		}
+	}
+	_incomingStart.push_back(_incoming.size());
+}
+
+void Checker::buildOutgoing()
+{
+	const size_t n = _records.size();
+	_outgoingStart.assign(n + 1, 0);
+	for(const auto &e : _incoming)
+	{
+		++_outgoingStart[e.item + 1];
+	}
+	for(size_t i = 0; i < n; ++i)
+	{
+		_outgoingStart[i + 1] += _outgoingStart[i];
+	}
+
+	_outgoing.resize(_incoming.size());
+	std::vector<std::uint32_t> fill(_outgoingStart.begin(), _outgoingStart.end() - 1);
+	for(size_t i = 0; i < n; ++i)
+	{
+		for(auto k = _incomingStart[i]; k < _incomingStart[i + 1]; ++k)
+		{
+			const auto &e = _incoming[k];
+			_outgoing[fill[e.item]++] = Edge{std::uint32_t(i), e.connection};
+		}
+	}
+}
+
+/**
+ * Follows removals in queue to their dependents: a connection to a removed
+ * item is removed with it, and any other dependency on it is dropped.
+ */
+void Checker::cascade(std::vector<std::uint32_t> &queue, const std::vector<bool> *skip)
+{
+	while(!queue.empty())
+	{
+		const auto r = queue.back();
+		queue.pop_back();
+		for(auto k = _outgoingStart[r]; k < _outgoingStart[r + 1]; ++k)
+		{
+			const auto &e = _outgoing[k];
+			if(_removed[e.item] || (skip && (*skip)[e.item]))
+			{
+				continue;
+			}
+
+			if(e.connection)
+			{
+				remove(DocumentIssue::Orphaned, e.item, _records[r].uuid);
+				queue.push_back(e.item);
+			}
+			else
+			{
+				issue(DocumentIssue::Orphaned, DocumentIssue::DropDependency, e.item, _records[r].uuid);
+			}
+		}
+	}
+}
+
+/**
+ * Kahn's algorithm leaves the items on cycles and everything behind them.
+ * Peeling off those with no dependents left among them keeps only the
+ * items on a cycle or between two. Every reference between those is then
+ * cut, which leaves the rest acyclic.
+ */
+void Checker::breakCycles()
+{
+	const size_t n = _records.size();
+	std::vector<std::uint32_t> pending(n, 0), queue;
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(_removed[i]) continue;
+		for(auto k = _incomingStart[i]; k < _incomingStart[i + 1]; ++k)
+		{
+			if(!_removed[_incoming[k].item]) ++pending[i];
+		}
+		if(pending[i] == 0) queue.push_back(i);
+	}
+
+	std::vector<bool> blocked(n, false);
+	for(size_t i = 0; i < n; ++i)
+	{
+		blocked[i] = !_removed[i];
+	}
+	while(!queue.empty())
+	{
+		const auto i = queue.back();
+		queue.pop_back();
+		blocked[i] = false;
+		for(auto k = _outgoingStart[i]; k < _outgoingStart[i + 1]; ++k)
+		{
+			const auto d = _outgoing[k].item;
+			if(!_removed[d] && --pending[d] == 0) queue.push_back(d);
+		}
+	}
+
+	// the same, against the edges, within what is left
+	std::fill(pending.begin(), pending.end(), 0);
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(!blocked[i]) continue;
+		for(auto k = _outgoingStart[i]; k < _outgoingStart[i + 1]; ++k)
+		{
+			if(blocked[_outgoing[k].item]) ++pending[i];
+		}
+		if(pending[i] == 0) queue.push_back(i);
+	}
+	while(!queue.empty())
+	{
+		const auto i = queue.back();
+		queue.pop_back();
+		blocked[i] = false;
+		for(auto k = _incomingStart[i]; k < _incomingStart[i + 1]; ++k)
+		{
+			const auto s = _incoming[k].item;
+			if(blocked[s] && --pending[s] == 0) queue.push_back(s);
+		}
+	}
+
+	std::vector<std::uint32_t> removedHere;
+	for(size_t i = 0; i < n; ++i)
+	{
+		if(!blocked[i]) continue;
+
+		// a connection cannot lose an end, so the item goes instead
+		auto begin = _incoming.begin() + _incomingStart[i], end = _incoming.begin() + _incomingStart[i + 1];
+		auto conn = std::find_if(begin, end, [&](const Edge &e) { return e.connection && blocked[e.item]; });
+		if(conn != end)
+		{
+			remove(DocumentIssue::Cycle, i, _records[conn->item].uuid);
+			removedHere.push_back(i);
+			continue;
+		}
+		for(auto it = begin; it != end; ++it)
+		{
+			if(blocked[it->item])
+			{
+				issue(DocumentIssue::Cycle, DocumentIssue::DropDependency, i, _records[it->item].uuid);
+			}
+		}
+	}
+
+	// references among the cycle are already cut
+	cascade(removedHere, &blocked);
+}
+
+}  // namespace
+
+const char *DocumentIssue::kindName(Kind kind)
+{
+	switch(kind)
+	{
+	case DuplicateItem:       return "duplicate-item";
+	case UnknownKind:         return "unknown-kind";
+	case DanglingDependency:  return "dangling-dependency";
+	case DanglingConnection:  return "dangling-connection";
+	case MalformedConnection: return "malformed-connection";
+	case PortOutOfRange:      return "port-out-of-range";
+	case Cycle:               return "cycle";
+	case Orphaned:            return "orphaned";
+	}
+	return "unknown";
+}
+
+const char *DocumentIssue::repairName(Repair repair)
+{
+	switch(repair)
+	{
+	case RemoveItem:     return "remove-item";
+	case DropDependency: return "drop-dependency";
+	default:             return "none";
+	}
+}
+
+std::string DocumentIssue::describe() const
+{
+	std::ostringstream os;
+	os << uuidString(item) << ": ";
+	switch(kind)
+	{
+	case DuplicateItem:
+		os << "duplicates an earlier item";
+		break;
+	case UnknownKind:
+		os << "has a kind that is not installed";
+		break;
+	case DanglingDependency:
+		os << "depends on unknown item " << uuidString(reference);
+		break;
+	case DanglingConnection:
+		os << "is connected to unknown item " << uuidString(reference);
+		break;
+	case MalformedConnection:
+		os << "has an incomplete connection";
+		break;
+	case PortOutOfRange:
+		os << "is connected to port " << port << ", which " << uuidString(reference) << " does not have";
+		break;
+	case Cycle:
+		os << "depends on itself through " << uuidString(reference);
+		break;
+	case Orphaned:
+		os << "depends on " << uuidString(reference) << ", which is removed";
+		break;
+	}
+
+	switch(repair)
+	{
+	case RemoveItem:
+		os << "; removing the item";
+		break;
+	case DropDependency:
+		os << "; dropping the dependency";
+		break;
+	default:
+		break;
+	}
+	return os.str();
+}
+
+size_t DocumentCheckReport::removedCount() const
+{
+	return std::count_if(issues.begin(), issues.end(),
+	                     [](const DocumentIssue &i) { return i.repair == DocumentIssue::RemoveItem; });
+}
+
+void DocumentCheckReport::writeJson(std::ostream &os, const std::string &path) const
+{
+	os << "{\"path\": ";
+	writeJsonString(os, path);
+	os << ", \"items\": " << itemCount
+	   << ", \"removed\": " << removedCount()
+	   << ", \"issues\": [";
+	bool first = true;
+	for(const auto &i : issues)
+	{
+		os << (first? "" : ",") << "\n  {\"kind\": \"" << DocumentIssue::kindName(i.kind) << "\""
+		   << ", \"index\": " << i.index
+		   << ", \"item\": \"" << uuidString(i.item) << "\"";
+		if(!i.reference.isNull())
+		{
+			os << ", \"reference\": \"" << uuidString(i.reference) << "\"";
+		}
+		if(i.port >= 0 || i.kind == DocumentIssue::PortOutOfRange)
+		{
+			os << ", \"port\": " << i.port;
+		}
+		os << ", \"repair\": \"" << DocumentIssue::repairName(i.repair) << "\"}";
+		first = false;
+	}
+	os << (first? "" : "\n") << "]}";
+}
+
+DocumentCheckReport checkDocument(const std::vector<DiagramItemRecord> &records, DiagramContext *ctx)
+{
+	DocumentCheckReport report;
+	Checker(records, ctx, report).run();
+	return report;
+}
+
+void repairDocument(std::vector<DiagramItemRecord> &records, const DocumentCheckReport &report)
+{
+	std::vector<bool> removed(records.size(), false);
+	for(const auto &i : report.issues)
+	{
+		if(i.repair == DocumentIssue::RemoveItem)
+		{
+			removed[i.index] = true;
+		}
+	}
+
+	for(const auto &i : report.issues)
+	{
+		if(i.repair == DocumentIssue::DropDependency && !removed[i.index])
+		{
+			auto &deps = records[i.index].dependencies;
+			deps.erase(std::remove(deps.begin(), deps.end(), i.reference), deps.end());
+		}
+	}
+
+	size_t kept = 0;
+	for(size_t i = 0; i < records.size(); ++i)
+	{
+		if(!removed[i])
+		{
+			if(kept != i) records[kept].swap(records[i]);
+			++kept;
+		}
+	}
+	records.resize(kept);
+}
+
+std::vector<DiagramItemRecord> readDocumentRecords(const char *data, size_t size)
+{
+	std::vector<DiagramItemRecord> records;
+	JournalReplay none;
+	readDocument(data, size, none, [&](DiagramItemRecord &record) {
+		records.emplace_back();
+		records.back().swap(record);
+	});
+	return records;
+}
+
+DiagramItemRecord recordFromSnapshot(const ModelSnapshot &snapshot)
+{
+	DiagramItemRecord record;
+	record.uuid = snapshot.uuid;
+	record.kind = snapshot.kind.toStdString();
+	record.scenePos = snapshot.scenePos;
+	record.rotation = snapshot.rotation;
+	record.sceneZ = snapshot.sceneZ;
+	record.dependencies.assign(snapshot.dependencies.begin(), snapshot.dependencies.end());
+	snapshot.saveExtraData(record.extraData);
+	record.connection = snapshot.connection;
+	return record;
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,132 @@
+#pragma once
+/**
+ * @file   DocumentChecker.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <vector>
+#include <string>
+#include <iosfwd>
+#include <QUuid>
+#include "DiagramItemRecord.hpp"
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+
+/**
+ * One problem found in a document, and what repairing it does.
+ */
+struct DocumentIssue
+{
+	enum Kind
+	{
+		/// a second item with the UUID of an earlier one
+		DuplicateItem,
+		/// the kind is not registered
+		UnknownKind,
+		/// a dependency names no item in the document
+		DanglingDependency,
+		/// an end of the connection names no item in the document
+		DanglingConnection,
+		/// the connection lacks an end or a port
+		MalformedConnection,
+		/// a port of the connection is not one of its item's ports
+		PortOutOfRange,
+		/// the item depends on itself through other items
+		Cycle,
+		/// reference is an item that repair removes
+		Orphaned
+	};
+
+	enum Repair
+	{
+		NoRepair,
+		RemoveItem,
+		DropDependency
+	};
+
+	Kind kind;
+	Repair repair;
+	/// the position of the item in the document
+	size_t index;
+	QUuid item;
+	/// the dependency, end or item on the cycle concerned, if any
+	QUuid reference;
+	/// the port out of range, or -1
+	int port;
+
+	DocumentIssue(Kind kind, Repair repair, size_t index, const QUuid &item,
+	              const QUuid &reference=QUuid(), int port=-1)
+	: kind(kind)
+	, repair(repair)
+	, index(index)
+	, item(item)
+	, reference(reference)
+	, port(port)
+	{ }
+
+	/// @return a lowercase, hyphenated name such as "dangling-dependency"
+	static const char *kindName(Kind kind);
+	static const char *repairName(Repair repair);
+
+	/// @return one line for people
+	std::string describe() const;
+};
+
+struct DocumentCheckReport
+{
+	size_t itemCount;
+	std::vector<DocumentIssue> issues;
+
+	DocumentCheckReport()
+	: itemCount(0)
+	{ }
+
+	bool clean() const
+	{
+		return issues.empty();
+	}
+
+	/// @return the number of items repair removes
+	size_t removedCount() const;
+
+	/**
+	 * Writes the report as one JSON object: path, items, removed and an
+	 * array of issues with kind, item, reference, port and repair.
+	 */
+	void writeJson(std::ostream &os, const std::string &path) const;
+};
+
+/**
+ * Validates references between items: duplicate UUIDs, unknown kinds,
+ * dependencies and connection ends that name no item, ports outside what
+ * the kind reports through DiagramComponent::portCount(), and cycles.
+ *
+ * Takes time linear in the number of items and references. The repairs
+ * in the report leave a document that loads without warnings: items that
+ * cannot be kept are removed along with connections to them, and other
+ * bad references, including those closing a cycle, are dropped.
+ */
+DocumentCheckReport checkDocument(const std::vector<DiagramItemRecord> &records, DiagramContext *ctx);
+
+/**
+ * Applies the repairs of report to the records it was made from. The
+ * records that remain keep their order.
+ */
+void repairDocument(std::vector<DiagramItemRecord> &records, const DocumentCheckReport &report);
+
+/**
+ * Reads the records of a document in any DocumentFormat.
+ *
+ * @throws boost::property_tree::ptree_error
+ * @throws MalformedDocumentException
+ * @throws CompressedStreamException
+ */
+std::vector<DiagramItemRecord> readDocumentRecords(const char *data, size_t size);
+
+/// @return a record with the fields of snapshot, its connection included
+DiagramItemRecord recordFromSnapshot(const ModelSnapshot &snapshot);
+
+}  // namespace dbuilder
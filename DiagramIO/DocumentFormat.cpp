@@ -0,0 +1,46 @@
+/**
+ * @file   DocumentFormat.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DocumentFormat.hpp"
+#include "BinaryDiagramLoader.hpp"
+#include "CompressedStream.hpp"
+#include <QFile>
+#include <cstring>
+
+namespace dbuilder {
+
+DocumentFormat detectDocumentFormat(const char *data, size_t size)
+{
+	if(size >= sizeof(BinaryDiagramLoader::Magic)
+	   && std::memcmp(data, BinaryDiagramLoader::Magic, sizeof(BinaryDiagramLoader::Magic)) == 0)
+	{
+		return DocumentFormat::Binary;
+	}
+
+	if(compressed::detect(data, size))
+	{
+		return DocumentFormat::CompressedInfo;
+	}
+
+	return DocumentFormat::Info;
+}
+
+DocumentFormat detectDocumentFormat(const QString &path)
+{
+	QFile file(path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return DocumentFormat::Info;
+	}
+
+	static_assert(sizeof(compressed::Magic) == sizeof(BinaryDiagramLoader::Magic), "header size");
+	char header[sizeof(BinaryDiagramLoader::Magic)];
+	auto n = file.read(header, sizeof(header));
+	return detectDocumentFormat(header, n < 0? 0 : size_t(n));
+}
+
+}  // namespace dbuilder
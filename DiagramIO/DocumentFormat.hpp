@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <QString>
+/**
+ * @file   DocumentFormat.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+namespace dbuilder {
+
+enum class DocumentFormat
+{
+	Info,           ///< boost::property_tree INFO text (InfoDiagramLoader)
+	Binary,         ///< memory-mappable binary (BinaryDiagramLoader)
+	CompressedInfo  ///< INFO text in the container of CompressedStream.hpp
+};
+
+/**
+ * Determines the format of a document from its first bytes. Anything
+ * that is not recognized is assumed to be INFO.
+ */
+DocumentFormat detectDocumentFormat(const char *data, size_t size);
+
+/**
+ * Determines the format of the document at path by reading its header.
+ */
+DocumentFormat detectDocumentFormat(const QString &path);
+
+}  // namespace dbuilder
@@ -0,0 +1,538 @@
+/**
+ * @file   DocumentJournal.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DocumentJournal.hpp"
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtEndian>
+#include <cstring>
+#include "InfoReader.hpp"
+#include "Util/Log.hpp"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace dbuilder {
+
+const char DocumentJournal::Magic[8] = { 'D', 'B', 'J', 'R', 'N', 'L', '\r', '\n' };
+
+namespace {
+
+enum: std::size_t
+{
+	HeaderSize      = 32,
+	FrameHeaderSize = 8,
+	ChecksumSize    = 4,
+	UuidSize        = 16,
+	MoveSize        = UuidSize + 24
+};
+
+// header field offsets
+enum: std::size_t
+{
+	VersionOffset      = 8,
+	BaseSizeOffset     = 16,
+	BaseModifiedOffset = 24
+};
+
+enum FrameType: char
+{
+	PutFrame    = 1,
+	MoveFrame   = 2,
+	RemoveFrame = 3,
+	CommitFrame = 4
+};
+
+struct Crc32Table
+{
+	quint32 entries[256];
+
+	Crc32Table()
+	{
+		for(quint32 i = 0; i < 256; ++i)
+		{
+			quint32 c = i;
+			for(int k = 0; k < 8; ++k)
+			{
+				c = (c & 1)? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			entries[i] = c;
+		}
+	}
+};
+
+quint32 crc32(const char *data, std::size_t size, quint32 crc=0)
+{
+	// initialized once, even when journals are read on several threads
+	static const Crc32Table table;
+
+	crc = ~crc;
+	for(std::size_t i = 0; i < size; ++i)
+	{
+		crc = table.entries[(crc ^ uchar(data[i])) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+quint32 get32(const char *p)
+{
+	return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(p));
+}
+
+quint64 get64(const char *p)
+{
+	return qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(p));
+}
+
+void put32(char *p, quint32 value)
+{
+	qToLittleEndian(value, reinterpret_cast<uchar *>(p));
+}
+
+void put64(char *p, quint64 value)
+{
+	qToLittleEndian(value, reinterpret_cast<uchar *>(p));
+}
+
+double getDouble(const char *p)
+{
+	quint64 bits = get64(p);
+	double value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void putDouble(char *p, double value)
+{
+	quint64 bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	put64(p, bits);
+}
+
+QUuid getUuid(const char *p)
+{
+	auto bytes = reinterpret_cast<const uchar *>(p);
+	return QUuid(qFromLittleEndian<quint32>(bytes),
+	             qFromLittleEndian<quint16>(bytes + 4),
+	             qFromLittleEndian<quint16>(bytes + 6),
+	             bytes[8], bytes[9], bytes[10], bytes[11],
+	             bytes[12], bytes[13], bytes[14], bytes[15]);
+}
+
+void putUuid(char *p, const QUuid &uuid)
+{
+	auto bytes = reinterpret_cast<uchar *>(p);
+	qToLittleEndian(quint32(uuid.data1), bytes);
+	qToLittleEndian(quint16(uuid.data2), bytes + 4);
+	qToLittleEndian(quint16(uuid.data3), bytes + 6);
+	std::memcpy(bytes + 8, uuid.data4, 8);
+}
+
+struct BaseIdentity
+{
+	quint64 size;
+	qint64 modified;
+};
+
+BaseIdentity identify(const QString &documentPath)
+{
+	QFileInfo info(documentPath);
+	return BaseIdentity{quint64(info.size()), info.lastModified().toMSecsSinceEpoch()};
+}
+
+/**
+ * Calls fn(type, payload, payloadSize, end) for each intact frame of
+ * data[begin, size), where end is the offset just past the frame.
+ * @return the offset just past the last intact frame
+ */
+template <typename Fn>
+std::size_t forEachFrame(const char *data, std::size_t size, std::size_t begin, Fn &&fn)
+{
+	std::size_t pos = begin;
+	while(size - pos >= FrameHeaderSize + ChecksumSize)
+	{
+		const char *frame = data + pos;
+		const std::size_t payloadSize = get32(frame);
+		if(payloadSize > size - pos - FrameHeaderSize - ChecksumSize)
+		{
+			break;
+		}
+
+		const char *payload = frame + FrameHeaderSize;
+		quint32 crc = crc32(frame + 4, 1);
+		crc = crc32(payload, payloadSize, crc);
+		if(crc != get32(payload + payloadSize))
+		{
+			break;
+		}
+
+		pos += FrameHeaderSize + payloadSize + ChecksumSize;
+		fn(frame[4], payload, payloadSize, pos);
+	}
+	return pos;
+}
+
+/**
+ * @return journalPath with ".stale" appended, and a number if that is taken
+ */
+QString stalePathFor(const QString &journalPath)
+{
+	QString result = journalPath + ".stale";
+	for(int i = 1; QFile::exists(result); ++i)
+	{
+		result = journalPath + ".stale." + QString::number(i);
+	}
+	return result;
+}
+
+}  // namespace
+
+QString DocumentJournal::pathFor(const QString &documentPath)
+{
+	return documentPath + ".journal";
+}
+
+DocumentJournal::DocumentJournal()
+: _committedSize(0)
+, _validSize(0)
+{
+}
+
+DocumentJournal::~DocumentJournal()
+{
+}
+
+bool DocumentJournal::scan(const QString &documentPath)
+{
+	close();
+	_documentPath = documentPath;
+	_contents.clear();
+	_stalePath.clear();
+	_committedSize = _validSize = 0;
+
+	QFile file(pathFor(documentPath));
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+
+	const QByteArray bytes = file.readAll();
+	const BaseIdentity base = identify(documentPath);
+	if(std::size_t(bytes.size()) < HeaderSize
+	   || std::memcmp(bytes.constData(), Magic, sizeof(Magic)) != 0
+	   || get32(bytes.constData() + VersionOffset) != Version
+	   || get64(bytes.constData() + BaseSizeOffset) != base.size
+	   || qint64(get64(bytes.constData() + BaseModifiedOffset)) != base.modified)
+	{
+		if(std::size_t(bytes.size()) > HeaderSize)
+		{
+			// it may hold saves that never reached the document; open() keeps it
+			_stalePath = stalePathFor(pathFor(documentPath));
+			DBWarning("Journal of ", documentPath.toStdString(), " does not match the document; ",
+			          "it will be kept as ", _stalePath.toStdString());
+		}
+		else
+		{
+			DBWarning("Ignoring journal that does not match ", documentPath.toStdString());
+		}
+		return false;
+	}
+
+	_contents.assign(bytes.constData(), bytes.size());
+	_committedSize = HeaderSize;
+	_validSize = forEachFrame(_contents.data(), _contents.size(), HeaderSize, [&](char type, const char *, std::size_t, std::size_t end) {
+		if(type == CommitFrame)
+		{
+			_committedSize = end;
+		}
+	});
+
+	if(std::size_t(_validSize) < _contents.size())
+	{
+		DBWarning("Journal of ", documentPath.toStdString(), " has ",
+		          _contents.size() - _validSize, " bytes of incomplete or damaged frames");
+	}
+	return true;
+}
+
+void DocumentJournal::replay(JournalReplay &replay, bool includeUnsaved) const
+{
+	const std::size_t limit = includeUnsaved? _validSize : _committedSize;
+	forEachFrame(_contents.data(), limit, HeaderSize, [&](char type, const char *payload, std::size_t size, std::size_t) {
+		switch(type)
+		{
+		case PutFrame:
+			try
+			{
+				readDiagramItemRecords(payload, payload + size, [&](DiagramItemRecord &record) {
+					auto &entry = replay.entry(record.uuid);
+					entry.change = JournalReplay::Change::Put;
+					entry.record.swap(record);
+				});
+			}
+			catch(const std::exception &exc)
+			{
+				DBError("Skipping unreadable journal item: ", exc.what());
+			}
+			break;
+
+		case MoveFrame:
+			if(size == MoveSize)
+			{
+				auto &entry = replay.entry(getUuid(payload));
+				const QPointF pos(getDouble(payload + UuidSize), getDouble(payload + UuidSize + 8));
+				const double rotation = getDouble(payload + UuidSize + 16);
+				if(entry.change == JournalReplay::Change::Put)
+				{
+					entry.record.scenePos = pos;
+					entry.record.rotation = rotation;
+				}
+				else if(entry.change == JournalReplay::Change::Move)
+				{
+					entry.scenePos = pos;
+					entry.rotation = rotation;
+				}
+			}
+			break;
+
+		case RemoveFrame:
+			if(size == UuidSize)
+			{
+				auto &entry = replay.entry(getUuid(payload));
+				entry.change = JournalReplay::Change::Remove;
+				entry.record.clear();
+			}
+			break;
+
+		default:
+			break;
+		}
+	});
+}
+
+bool DocumentJournal::open(const QString &documentPath, bool keepUnsaved)
+{
+	if(documentPath != _documentPath || _contents.empty())
+	{
+		if(documentPath == _documentPath && !_stalePath.isNull())
+		{
+			// never truncated: a journal that does not match may be all that
+			// is left of saves made before the document was copied or touched
+			if(!QFile::rename(pathFor(documentPath), _stalePath))
+			{
+				DBError("Failed to move journal ", pathFor(documentPath).toStdString(),
+				        " to ", _stalePath.toStdString(), "; not journaling");
+				return false;
+			}
+			_stalePath.clear();
+		}
+		_documentPath = documentPath;
+		return reset();
+	}
+
+	_contents.clear();
+	_file.close();
+	_file.setFileName(pathFor(documentPath));
+	if(!_file.open(QIODevice::ReadWrite) || !_file.resize(keepUnsaved? _validSize : _committedSize))
+	{
+		DBError("Failed to open journal ", _file.fileName().toStdString(), ": ", _file.errorString().toStdString());
+		_file.close();
+		return false;
+	}
+	_validSize = _file.size();
+	return _file.seek(_validSize);
+}
+
+void DocumentJournal::close()
+{
+	_file.close();
+}
+
+bool DocumentJournal::reset()
+{
+	_contents.clear();
+	_file.close();
+	_file.setFileName(pathFor(_documentPath));
+	if(!_file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writeHeader())
+	{
+		DBError("Failed to create journal ", _file.fileName().toStdString(), ": ", _file.errorString().toStdString());
+		_file.close();
+		return false;
+	}
+	_committedSize = _validSize = HeaderSize;
+	return true;
+}
+
+bool DocumentJournal::writeHeader()
+{
+	const BaseIdentity base = identify(_documentPath);
+	char header[HeaderSize] = { };
+	std::memcpy(header, Magic, sizeof(Magic));
+	put32(header + VersionOffset, Version);
+	put64(header + BaseSizeOffset, base.size);
+	put64(header + BaseModifiedOffset, quint64(base.modified));
+	return _file.write(header, HeaderSize) == qint64(HeaderSize) && _file.flush();
+}
+
+bool DocumentJournal::append(char type, const char *payload, std::size_t size)
+{
+	_frame.resize(FrameHeaderSize + size + ChecksumSize);
+	char *frame = &_frame[0];
+	put32(frame, quint32(size));
+	frame[4] = type;
+	frame[5] = frame[6] = frame[7] = 0;
+	std::memcpy(frame + FrameHeaderSize, payload, size);
+	quint32 crc = crc32(frame + 4, 1);
+	put32(frame + FrameHeaderSize + size, crc32(payload, size, crc));
+
+	if(!_file.isOpen())
+	{
+		return false;
+	}
+
+	// flushed frame by frame so that a crash loses at most the frame being written
+	if(_file.write(_frame.data(), _frame.size()) != qint64(_frame.size()) || !_file.flush())
+	{
+		DBError("Failed to write journal ", _file.fileName().toStdString(), ": ", _file.errorString().toStdString());
+		return false;
+	}
+	_validSize += _frame.size();
+	return true;
+}
+
+bool DocumentJournal::put(const std::string &infoText)
+{
+	return append(PutFrame, infoText.data(), infoText.size());
+}
+
+bool DocumentJournal::move(const QUuid &uuid, const QPointF &scenePos, double rotation)
+{
+	char payload[MoveSize];
+	putUuid(payload, uuid);
+	putDouble(payload + UuidSize, scenePos.x());
+	putDouble(payload + UuidSize + 8, scenePos.y());
+	putDouble(payload + UuidSize + 16, rotation);
+	return append(MoveFrame, payload, MoveSize);
+}
+
+bool DocumentJournal::remove(const QUuid &uuid)
+{
+	char payload[UuidSize];
+	putUuid(payload, uuid);
+	return append(RemoveFrame, payload, UuidSize);
+}
+
+bool DocumentJournal::commit()
+{
+	if(!append(CommitFrame, nullptr, 0))
+	{
+		return false;
+	}
+
+#ifdef Q_OS_WIN
+	bool synced = ::_commit(_file.handle()) == 0;
+#else
+	bool synced = ::fsync(_file.handle()) == 0;
+#endif
+	if(!synced)
+	{
+		DBError("Failed to sync journal ", _file.fileName().toStdString());
+		return false;
+	}
+
+	_committedSize = _validSize;
+	return true;
+}
+
+bool DocumentJournal::discardUnsaved()
+{
+	if(!_file.isOpen() || !_file.resize(_committedSize) || !_file.seek(_committedSize))
+	{
+		return false;
+	}
+	_validSize = _committedSize;
+	return true;
+}
+
+bool DocumentJournal::appendRaw(const std::string &frames)
+{
+	if(!_file.isOpen()
+	   || _file.write(frames.data(), frames.size()) != qint64(frames.size())
+	   || !_file.flush())
+	{
+		return false;
+	}
+
+	forEachFrame(frames.data(), frames.size(), 0, [&](char type, const char *, std::size_t, std::size_t end) {
+		if(type == CommitFrame)
+		{
+			_committedSize = _validSize + end;
+		}
+	});
+	_validSize += frames.size();
+	return true;
+}
+
+JournalReplay::Entry &JournalReplay::entry(const QUuid &uuid)
+{
+	auto it = _entries.find(uuid);
+	if(it == _entries.end())
+	{
+		it = _entries.insert(uuid, Entry{Change::Move, DiagramItemRecord(), QPointF(), 0, false});
+		_order << uuid;
+	}
+	return *it;
+}
+
+bool JournalReplay::patch(DiagramItemRecord &record)
+{
+	auto it = _entries.find(record.uuid);
+	if(it == _entries.end())
+	{
+		return true;
+	}
+
+	auto &entry = *it;
+	if(entry.seen)
+	{
+		// a second item with the same UUID; leave it to the scene to complain
+		return true;
+	}
+	entry.seen = true;
+
+	switch(entry.change)
+	{
+	case Change::Remove:
+		return false;
+	case Change::Put:
+		record.swap(entry.record);
+		return true;
+	case Change::Move:
+		record.scenePos = entry.scenePos;
+		record.rotation = entry.rotation;
+		return true;
+	}
+	return true;
+}
+
+void JournalReplay::takeAdded(const std::function<void (DiagramItemRecord &)> &fn)
+{
+	for(const auto &uuid : _order)
+	{
+		auto &entry = _entries[uuid];
+		if(!entry.seen && entry.change == Change::Put)
+		{
+			entry.seen = true;
+			fn(entry.record);
+		}
+	}
+}
+
+}  // namespace dbuilder
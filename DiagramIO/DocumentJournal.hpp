@@ -0,0 +1,191 @@
+#pragma once
+/**
+ * @file   DocumentJournal.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QUuid>
+#include <QPointF>
+#include <QString>
+#include "DiagramItemRecord.hpp"
+
+namespace dbuilder {
+
+class JournalReplay;
+
+/**
+ * An append-only log of changes to a saved document, kept beside it as
+ * "<document>.journal".
+ *
+ * Little-endian throughout. The 32-byte header holds the 8-byte magic, the
+ * format version and the size and modification time of the document the
+ * journal applies to, so that a journal left behind by a document that was
+ * since replaced is ignored. Each frame that follows is
+ *
+ *  - u32 payload size, u8 frame type, three zero bytes
+ *  - the payload
+ *  - u32 CRC-32 of the type byte and the payload
+ *
+ * Put frames hold one item as InfoDiagramLoader writes it, Move frames the
+ * raw UUID, position and rotation, and Remove frames the raw UUID. Commit
+ * frames mark a save; frames after the last one are changes that were never
+ * saved, recoverable after a crash. Reading stops at the first frame that is
+ * truncated or fails its checksum.
+ */
+class DocumentJournal
+{
+	QFile _file;
+	QString _documentPath;
+	QString _stalePath;
+	std::string _contents;
+	qint64 _committedSize;
+	qint64 _validSize;
+	std::string _frame;
+
+	bool writeHeader();
+	bool append(char type, const char *payload, std::size_t size);
+
+public:
+	static const char Magic[8];
+	static const quint32 Version = 1;
+
+	/**
+	 * @return the path of the journal kept for documentPath
+	 */
+	static QString pathFor(const QString &documentPath);
+
+	DocumentJournal();
+	~DocumentJournal();
+
+	/**
+	 * Reads the journal of documentPath, if there is one that applies to the
+	 * document as it is on disk. Does not open it for writing.
+	 *
+	 * @return false if there is no usable journal
+	 */
+	bool scan(const QString &documentPath);
+
+	/**
+	 * @return where open() will move a journal that scan() found but that
+	 * does not apply to the document, or a null string. Such a journal has
+	 * frames that may never have reached the document, so it is not
+	 * overwritten.
+	 */
+	const QString &stalePath() const { return _stalePath; }
+
+	/**
+	 * @return true if the journal read by scan() has frames after its last
+	 * commit, i.e. the application stopped without saving or discarding them
+	 */
+	bool hasUnsavedChanges() const { return _validSize > _committedSize; }
+
+	/**
+	 * Folds the frames read by scan() into replay. Unsaved frames are
+	 * included only if includeUnsaved is set.
+	 */
+	void replay(JournalReplay &replay, bool includeUnsaved) const;
+
+	/**
+	 * Opens the journal of documentPath for appending. A journal read by
+	 * scan() is kept, without its unsaved frames unless keepUnsaved is set;
+	 * otherwise a new one is started for the document as it is on disk,
+	 * after moving a journal that did not apply to stalePath().
+	 *
+	 * @return false if the journal could not be opened, or a journal that
+	 * did not apply could not be moved aside
+	 */
+	bool open(const QString &documentPath, bool keepUnsaved=false);
+	bool isOpen() const { return _file.isOpen(); }
+	void close();
+
+	/**
+	 * Starts over with an empty journal for the document as it is on disk,
+	 * after the document has been rewritten.
+	 */
+	bool reset();
+
+	/**
+	 * @param infoText  one item, as InfoDiagramLoader writes it
+	 */
+	bool put(const std::string &infoText);
+	bool move(const QUuid &uuid, const QPointF &scenePos, double rotation);
+	bool remove(const QUuid &uuid);
+
+	/**
+	 * Marks everything written so far as saved and flushes it to disk.
+	 */
+	bool commit();
+
+	/**
+	 * Drops the frames written since the last commit.
+	 */
+	bool discardUnsaved();
+
+	/**
+	 * Appends frames exactly as returned by lastFrame().
+	 */
+	bool appendRaw(const std::string &frames);
+
+	/**
+	 * @return the bytes of the frame written by the last call to put(),
+	 * move(), remove() or commit()
+	 */
+	const std::string &lastFrame() const { return _frame; }
+
+	qint64 size() const { return _file.isOpen()? _file.size() : 0; }
+	const QString &documentPath() const { return _documentPath; }
+};
+
+/**
+ * The net effect of a journal on the items of its document, applied to the
+ * records of the document as they are read.
+ *
+ * Not bound to any thread; DocumentOpener uses it on its worker.
+ */
+class JournalReplay
+{
+	enum class Change { Put, Move, Remove };
+
+	struct Entry
+	{
+		Change change;
+		DiagramItemRecord record;
+		QPointF scenePos;
+		double rotation;
+		bool seen;
+	};
+
+	QHash<QUuid, Entry> _entries;
+	// in order of first appearance, for items the document does not have
+	QList<QUuid> _order;
+
+	Entry &entry(const QUuid &uuid);
+	friend class DocumentJournal;
+
+public:
+	bool empty() const { return _entries.isEmpty(); }
+	int size() const { return _entries.size(); }
+
+	/**
+	 * Brings a record read from the document up to date.
+	 *
+	 * @return false if the journal removed the item
+	 */
+	bool patch(DiagramItemRecord &record);
+
+	/**
+	 * Calls fn for each item put by the journal but not patched into the
+	 * document, in the order they were first journaled.
+	 */
+	void takeAdded(const std::function<void (DiagramItemRecord &)> &fn);
+};
+
+}  // namespace dbuilder
@@ -0,0 +1,98 @@
+/**
+ * @file   DocumentReader.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "DocumentReader.hpp"
+#include <QFile>
+#include <QByteArray>
+#include <exception>
+#include <memory>
+#include "CompressedStream.hpp"
+#include "InfoReader.hpp"
+#include "BinaryDiagramLoader.hpp"
+
+namespace dbuilder {
+
+DocumentFormat readDocument(const char *data, std::size_t size, JournalReplay &replay,
+                            const std::function<void (DiagramItemRecord &)> &fn,
+                            BufferOwner owner)
+{
+	const DocumentFormat format = detectDocumentFormat(data, size);
+
+	std::shared_ptr<QByteArray> expanded;
+	if(format == DocumentFormat::CompressedInfo)
+	{
+		expanded = std::make_shared<QByteArray>(compressed::decompress(data, size));
+		data = expanded->constData();
+		size = expanded->size();
+		if(owner)
+		{
+			owner = expanded;
+		}
+	}
+
+	auto patched = [&](DiagramItemRecord &record) {
+		if(replay.empty() || replay.patch(record))
+		{
+			fn(record);
+		}
+	};
+
+	if(detectDocumentFormat(data, size) == DocumentFormat::Binary)
+	{
+		BinaryDiagramLoader::readRecords(data, size, patched, owner);
+	}
+	else
+	{
+		readDiagramItemRecordsParallel(data, data + size, patched, owner);
+	}
+	replay.takeAdded(fn);
+	return format;
+}
+
+JournalReplay readJournal(const QString &documentPath, bool includeUnsaved)
+{
+	JournalReplay replay;
+	DocumentJournal journal;
+	if(journal.scan(documentPath))
+	{
+		journal.replay(replay, includeUnsaved);
+	}
+	return replay;
+}
+
+QString readDocumentFile(const QString &path, std::vector<DiagramItemRecord> &records, DocumentFormat *format)
+{
+	QFile file(path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		return file.errorString();
+	}
+	const QByteArray contents = file.readAll();
+	file.close();
+
+	JournalReplay replay = readJournal(path);
+	records.clear();
+	try
+	{
+		const auto detected = readDocument(contents.constData(), contents.size(), replay,
+			[&](DiagramItemRecord &record) {
+				records.emplace_back();
+				records.back().swap(record);
+			});
+		if(format)
+		{
+			*format = detected;
+		}
+	}
+	catch(const std::exception &exc)
+	{
+		return QString::fromLocal8Bit(exc.what());
+	}
+	return QString();
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,54 @@
+#pragma once
+/**
+ * @file   DocumentReader.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <functional>
+#include <vector>
+#include <cstddef>
+#include <QString>
+#include "DiagramItemRecord.hpp"
+#include "DocumentFormat.hpp"
+#include "DocumentJournal.hpp"
+#include "RawTree.hpp"
+
+namespace dbuilder {
+
+/**
+ * Reads the records of a document in any DocumentFormat, brings each up to
+ * date with replay, and passes them to fn in document order, followed by
+ * the items replay adds. Items replay removes are skipped.
+ *
+ * If owner is given, it must keep data alive, and extraData may be left
+ * encoded in the buffer (see DiagramItemRecord::raw).
+ *
+ * @return the format of the document
+ * @throws boost::property_tree::ptree_error
+ * @throws MalformedDocumentException
+ * @throws CompressedStreamException
+ */
+DocumentFormat readDocument(const char *data, std::size_t size, JournalReplay &replay,
+                            const std::function<void (DiagramItemRecord &)> &fn,
+                            BufferOwner owner=BufferOwner());
+
+/**
+ * @return the changes in the journal of documentPath, or none if there is
+ * no journal or it no longer matches the document
+ * @param includeUnsaved  whether frames after its last commit are included
+ */
+JournalReplay readJournal(const QString &documentPath, bool includeUnsaved=false);
+
+/**
+ * Reads the document at path with the saved changes in its journal, which
+ * is what a window opening it shows.
+ *
+ * @param format  set to the format of the document, if not null
+ * @return a description of the failure, or a null string on success
+ */
+QString readDocumentFile(const QString &path, std::vector<DiagramItemRecord> &records,
+                         DocumentFormat *format=nullptr);
+
+}  // namespace dbuilder
@@ -13,27 +13,111 @@
 #include "DiagramItemModel.hpp"
 #include "UUIDMapper.hpp"
 #include "DiagramComponent.hpp"
+#include "InfoReader.hpp"
+#include "InfoWriter.hpp"
+#include "DiagramItemRecord.hpp"
+#include "CompressedStream.hpp"
 
 using boost::property_tree::ptree;
 using namespace boost::property_tree::info_parser;
 
 namespace dbuilder {
+
+namespace {
+
+/**
+ * Reads a whole document from is, decompressing it on the way if it is
+ * compressed, so that only the expanded text is ever held.
+ */
+QByteArray readAll(std::istream &is)
+{
+	char head[sizeof(compressed::Magic)];
+	is.read(head, sizeof(head));
+	const std::size_t headSize = is.gcount();
+	if(compressed::detect(head, headSize))
+	{
+		return compressed::decompressBlocks(is);
+	}
+
+	QByteArray result(head, int(headSize));
+	char chunk[64 << 10];
+	while(is.read(chunk, sizeof(chunk)) || is.gcount() > 0)
+	{
+		result.append(chunk, int(is.gcount()));
+	}
+	return result;
+}
+
+QList<DiagramItemModel *> readModels(DiagramContext *ctx, const char *data, size_t size, QObject *parent)
+{
+	QByteArray expanded;
+	if(compressed::detect(data, size))
+	{
+		expanded = compressed::decompress(data, size);
+		data = expanded.constData();
+		size = expanded.size();
+	}
+
+	QList<DiagramItemModel *> results;
+	try
+	{
+		readDiagramItemRecordsParallel(data, data + size, [&](DiagramItemRecord &record) {
+			results << record.createModel(ctx, parent);
+		});
+	}
+	catch(...)
+	{
+		qDeleteAll(results);
+		throw;
+	}
+
+	return results;
+}
+
+/**
+ * Calls write with os, or with a stream compressing into it.
+ */
+template <typename Write>
+void writeCompressible(std::ostream &os, bool compress, Write write)
+{
+	if(!compress)
+	{
+		write(os);
+		return;
+	}
+
+	CompressingStreamBuf buf(os);
+	std::ostream compressing(&buf);
+	write(compressing);
+	if(!buf.finish())
+	{
+		throw info_parser_error("write error", "", 0);
+	}
+}
+
+}  // namespace
+
 InfoDiagramLoader::InfoDiagramLoader(DiagramContext *ctx, QObject* parent)
 : QObject(parent)
 , _ctx(ctx)
+, _compressed(false)
 {
 }
 
 QList<DiagramItem *> InfoDiagramLoader::load(std::istream &is, DiagramScene *scene) const
 {
-	QList<DiagramItem *> results;
+	const auto data = readAll(is);
+	return load(data.constData(), data.size(), scene);
+}
 
-	ptree pt;
-	read_info(is, pt);
+QList<DiagramItem *> InfoDiagramLoader::load(const char *data, size_t size, DiagramScene *scene) const
+{
+	// parse everything before touching the scene, as read_info() did
+	auto models = readModels(scene->context(), data, size, nullptr);
 
-	for(const auto &pv : pt)
+	QList<DiagramItem *> results;
+	for(auto model : models)
 	{
-		auto model = new DiagramItemModel(scene->context(), pv);
 		auto item = model->kind()->createFromModel(model);
 		scene->addDiagramItem(item);
 
@@ -47,42 +131,54 @@ QList<DiagramItem *> InfoDiagramLoader::load(std::istream &is, DiagramScene *sce
 
 void InfoDiagramLoader::save(std::ostream &os, const QList<DiagramItem *> &items) const
 {
-	ptree pt;
-	for(auto item : items)
-	{
-		item->model()->save(pt);
-	}
-
-	write_info(os, pt);
+	writeCompressible(os, _compressed, [&](std::ostream &out) {
+		InfoWriter writer(out);
+		for(auto item : items)
+		{
+			item->model()->save(writer);
+		}
+
+		writer.finish();
+	});
 }
 
 
 
 QList<DiagramItemModel *> InfoDiagramLoader::loadModels(std::istream &is, QObject *parent) const
 {
-	ptree pt;
-	read_info(is, pt);
-
-	QList<DiagramItemModel *> results;
-	for(const ptree::value_type &pv : pt)
-	{
-		auto model = new DiagramItemModel(_ctx, pv, parent);
-
-		results << model;
-	}
+	const auto data = readAll(is);
+	return loadModels(data.constData(), data.size(), parent);
+}
 
-	return results;
+QList<DiagramItemModel *> InfoDiagramLoader::loadModels(const char *data, size_t size, QObject *parent) const
+{
+	return readModels(_ctx, data, size, parent);
 }
 
 void InfoDiagramLoader::saveModels(std::ostream &os, const QList<DiagramItemModel *> &models) const
 {
-	ptree pt;
-	for(auto model : models)
-	{
-		model->save(pt);
-	}
+	writeCompressible(os, _compressed, [&](std::ostream &out) {
+		InfoWriter writer(out);
+		for(auto model : models)
+		{
+			model->save(writer);
+		}
+
+		writer.finish();
+	});
+}
 
-	write_info(os, pt);
+void InfoDiagramLoader::saveSnapshots(std::ostream &os, const std::vector<ModelSnapshot> &models) const
+{
+	writeCompressible(os, _compressed, [&](std::ostream &out) {
+		InfoWriter writer(out);
+		for(const auto &model : models)
+		{
+			model.save(writer);
+		}
+
+		writer.finish();
+	});
 }
 
 InfoDiagramLoader::~InfoDiagramLoader()
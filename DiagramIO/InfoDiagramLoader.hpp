@@ -13,18 +13,43 @@
 
 
 namespace dbuilder {
+/**
+ * Reads and writes INFO text documents.
+ *
+ * Documents in the compressed container of CompressedStream.hpp are
+ * recognized and read by every loader. Only loaders with compressed() set
+ * write them.
+ */
 class InfoDiagramLoader: public QObject, public DiagramLoader
 {
 	Q_OBJECT
 	DiagramContext *_ctx;
+	bool _compressed;
 public:
 	InfoDiagramLoader(DiagramContext *ctx, QObject *parent=nullptr);
 
+	bool compressed() const { return _compressed; }
+	void setCompressed(bool compressed) { _compressed = compressed; }
+
 	virtual QList<DiagramItem *> load(std::istream &, DiagramScene *) const;
 	virtual void save(std::ostream &, const QList<DiagramItem *> &) const;
 
 	virtual QList<DiagramItemModel *> loadModels(std::istream &, QObject *parent=nullptr) const;
 	virtual void saveModels(std::ostream &, const QList<DiagramItemModel *> &) const;
+	virtual void saveSnapshots(std::ostream &, const std::vector<ModelSnapshot> &) const;
+
+	/**
+	 * Reads a document already in memory, such as a mapped file.
+	 *
+	 * @throws boost::property_tree::ptree_error
+	 * @throws CompressedStreamException
+	 */
+	QList<DiagramItem *> load(const char *data, size_t size, DiagramScene *) const;
+	/**
+	 * @throws boost::property_tree::ptree_error
+	 * @throws CompressedStreamException
+	 */
+	QList<DiagramItemModel *> loadModels(const char *data, size_t size, QObject *parent=nullptr) const;
 
 	virtual ~InfoDiagramLoader();
 };
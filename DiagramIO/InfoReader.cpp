@@ -0,0 +1,1115 @@
+/**
+ * @file   InfoReader.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "InfoReader.hpp"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <locale>
+#include <exception>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/info_parser.hpp>
+#include "DiagramItemRecord.hpp"
+
+using boost::property_tree::ptree;
+using boost::property_tree::info_parser::info_parser_error;
+
+namespace dbuilder {
+
+namespace {
+
+/// Same as boost's is_ascii_space(): isspace() restricted to ASCII.
+inline bool isSpace(char c)
+{
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/// Messages thrown from inside a line; parse() adds the filename and line.
+struct LineError
+{
+	const char *message;
+};
+
+}  // namespace
+
+/**
+ * One line of input, as read_info() sees it after getline(): the line
+ * ends at the newline or at the first NUL, whichever comes first.
+ */
+class InfoReader::Line
+{
+	std::string &_scratch;
+public:
+	const char *p;
+	const char *end;
+
+	Line(std::string &scratch, const char *begin, const char *end)
+	: _scratch(scratch)
+	, p(begin)
+	, end(end)
+	{
+		auto nul = begin == end? nullptr
+			: static_cast<const char *>(std::memchr(begin, '\0', end - begin));
+		if(nul)
+		{
+			this->end = nul;
+		}
+	}
+
+	char peek() const
+	{
+		return p < end? *p : '\0';
+	}
+
+	void skipWhitespace()
+	{
+		while(p < end && isSpace(*p))
+		{
+			++p;
+		}
+	}
+
+	StringRef expandEscapes(const char *b, const char *e)
+	{
+		auto backslash = b == e? nullptr
+			: static_cast<const char *>(std::memchr(b, '\\', e - b));
+		if(!backslash)
+		{
+			return StringRef(b, e - b);
+		}
+
+		_scratch.assign(b, backslash);
+		for(b = backslash; b != e; ++b)
+		{
+			if(*b != '\\')
+			{
+				_scratch += *b;
+				continue;
+			}
+
+			if(++b == e)
+			{
+				throw LineError{"character expected after backslash"};
+			}
+
+			switch(*b)
+			{
+			case '0':  _scratch += '\0'; break;
+			case 'a':  _scratch += '\a'; break;
+			case 'b':  _scratch += '\b'; break;
+			case 'f':  _scratch += '\f'; break;
+			case 'n':  _scratch += '\n'; break;
+			case 'r':  _scratch += '\r'; break;
+			case 't':  _scratch += '\t'; break;
+			case 'v':  _scratch += '\v'; break;
+			case '"':  _scratch += '"';  break;
+			case '\'': _scratch += '\''; break;
+			case '\\': _scratch += '\\'; break;
+			default:
+				throw LineError{"unknown escape sequence"};
+			}
+		}
+
+		return StringRef(_scratch.data(), _scratch.size());
+	}
+
+	StringRef readWord()
+	{
+		skipWhitespace();
+		auto start = p;
+		while(p < end && !isSpace(*p) && *p != ';')
+		{
+			++p;
+		}
+		return expandEscapes(start, p);
+	}
+
+	StringRef readString(bool *needMoreLines)
+	{
+		skipWhitespace();
+		if(peek() != '"')
+		{
+			throw LineError{"expected \""};
+		}
+
+		auto start = ++p;
+		bool escaped = false;
+		while(p < end && (escaped || *p != '"'))
+		{
+			escaped = !escaped && *p == '\\';
+			++p;
+		}
+
+		if(p == end)
+		{
+			throw LineError{"unexpected end of line"};
+		}
+
+		auto result = expandEscapes(start, p++);
+		skipWhitespace();
+		if(peek() == '\\')
+		{
+			if(!needMoreLines)
+			{
+				throw LineError{"unexpected \\"};
+			}
+			++p;
+			skipWhitespace();
+			if(peek() == '\0' || peek() == ';')
+			{
+				*needMoreLines = true;
+			}
+			else
+			{
+				throw LineError{"expected end of line after \\"};
+			}
+		}
+		else if(needMoreLines)
+		{
+			*needMoreLines = false;
+		}
+
+		return result;
+	}
+
+	StringRef readKey()
+	{
+		skipWhitespace();
+		return peek() == '"'? readString(nullptr) : readWord();
+	}
+
+	StringRef readData(bool *needMoreLines)
+	{
+		skipWhitespace();
+		if(peek() == '"')
+		{
+			return readString(needMoreLines);
+		}
+		*needMoreLines = false;
+		return readWord();
+	}
+};
+
+InfoReader::InfoReader()
+: _includeDepth(0)
+{
+}
+
+void InfoReader::read(const char *begin, const char *end, InfoHandler &handler,
+                      const std::string &filename)
+{
+	read(begin, end, handler, filename, 0);
+}
+
+void InfoReader::read(const char *begin, const char *end, InfoHandler &handler,
+                      const std::string &filename, unsigned long linesBefore)
+{
+	_filename = filename;
+	_includeDepth = 0;
+	parse(begin, end, handler, linesBefore);
+}
+
+void InfoReader::include(const std::string &filename, InfoHandler &handler, unsigned long lineNo)
+{
+	std::ifstream stream(filename.c_str());
+	if(!stream.good())
+	{
+		throw info_parser_error("cannot open include file " + filename, _filename, lineNo);
+	}
+
+	std::string contents((std::istreambuf_iterator<char>(stream)),
+	                     std::istreambuf_iterator<char>());
+
+	auto outerFilename = _filename;
+	_filename = filename;
+	++_includeDepth;
+
+	handler.beginInclude();
+	parse(contents.data(), contents.data() + contents.size(), handler);
+	handler.endInclude();
+
+	--_includeDepth;
+	_filename = outerFilename;
+}
+
+void InfoReader::parse(const char *begin, const char *end, InfoHandler &handler, unsigned long firstLine)
+{
+	enum State { Key, Data, DataCont };
+
+	State state = Key;
+	bool haveLast = false;
+	std::size_t depth = 0;
+	unsigned long lineNo = firstLine;
+	bool needMoreLines = false;
+
+	// mirrors read_info()'s getline() loop, including the empty line it
+	// reads after a trailing newline
+	const char *lineStart = begin;
+	bool moreLines = true;
+	try
+	{
+		while(moreLines)
+		{
+			++lineNo;
+			auto newline = lineStart == end? nullptr
+				: static_cast<const char *>(std::memchr(lineStart, '\n', end - lineStart));
+			auto lineEnd = newline? newline : end;
+			moreLines = newline != nullptr;
+
+			handler.beginLine(lineStart);
+			Line line(_scratch, lineStart, lineEnd);
+			lineStart = lineEnd + 1;
+
+			line.skipWhitespace();
+			if(line.peek() == '#')
+			{
+				++line.p;
+				if(line.readWord() == "include")
+				{
+					if(_includeDepth > 100)
+					{
+						throw LineError{"include depth too large, probably recursive include"};
+					}
+					include(line.readString(nullptr).str(), handler, lineNo);
+				}
+				else
+				{
+					throw LineError{"unknown directive"};
+				}
+
+				line.skipWhitespace();
+				if(line.peek() != '\0')
+				{
+					throw LineError{"expected end of line"};
+				}
+				continue;
+			}
+
+			while(true)
+			{
+				line.skipWhitespace();
+				char c = line.peek();
+				if(c == '\0' || c == ';')
+				{
+					if(state == Data)
+					{
+						state = Key;
+					}
+					break;
+				}
+
+				switch(state)
+				{
+				case Key:
+				case Data:
+					if(c == '{')
+					{
+						if(!haveLast)
+						{
+							throw LineError{"unexpected {"};
+						}
+						handler.brace(line.p);
+						handler.open();
+						++depth;
+						haveLast = false;
+						++line.p;
+						state = Key;
+					}
+					else if(c == '}')
+					{
+						if(depth == 0)
+						{
+							throw LineError{"unmatched }"};
+						}
+						handler.brace(line.p);
+						handler.close();
+						--depth;
+						haveLast = false;
+						++line.p;
+						state = Key;
+					}
+					else if(state == Key)
+					{
+						handler.key(line.readKey());
+						haveLast = true;
+						state = Data;
+					}
+					else
+					{
+						handler.data(line.readData(&needMoreLines));
+						state = needMoreLines? DataCont : Key;
+					}
+					break;
+
+				case DataCont:
+					if(c != '"')
+					{
+						throw LineError{"expected \" after \\ in previous line"};
+					}
+					handler.appendData(line.readString(&needMoreLines));
+					state = needMoreLines? DataCont : Key;
+					break;
+				}
+			}
+		}
+
+		if(depth != 0)
+		{
+			throw LineError{"unmatched {"};
+		}
+	}
+	catch(const LineError &e)
+	{
+		throw info_parser_error(e.message, _filename, lineNo);
+	}
+}
+
+PtreeBuilder::PtreeBuilder(ptree &root)
+: _last(nullptr)
+{
+	_stack.push_back(&root);
+}
+
+void PtreeBuilder::key(StringRef key)
+{
+	_last = &_stack.back()->push_back(std::make_pair(key.str(), ptree()))->second;
+}
+
+void PtreeBuilder::data(StringRef data)
+{
+	_last->data().assign(data.data, data.size);
+}
+
+void PtreeBuilder::appendData(StringRef data)
+{
+	_last->data().append(data.data, data.size);
+}
+
+void PtreeBuilder::open()
+{
+	_stack.push_back(_last);
+	_last = nullptr;
+}
+
+void PtreeBuilder::close()
+{
+	_stack.pop_back();
+	_last = nullptr;
+}
+
+void PtreeBuilder::beginInclude()
+{
+	_includeLast.push_back(_last);
+}
+
+void PtreeBuilder::endInclude()
+{
+	_last = _includeLast.back();
+	_includeLast.pop_back();
+}
+
+namespace {
+
+/**
+ * Parses a double exactly as ptree::get<double>() does, skipping the
+ * stream for plain integers.
+ */
+class NumberParser
+{
+	std::istringstream _stream;
+	std::string _buffer;
+public:
+	NumberParser()
+	{
+		_stream.imbue(std::locale());
+	}
+
+	double parse(const std::string &text, double defaultValue)
+	{
+		auto p = text.data(), end = p + text.size();
+		bool negative = false;
+		if(p != end && (*p == '-' || *p == '+'))
+		{
+			negative = *p++ == '-';
+		}
+
+		if(p != end && end - p <= 15)
+		{
+			long long value = 0;
+			auto digits = p;
+			while(p != end && *p >= '0' && *p <= '9')
+			{
+				value = value * 10 + (*p++ - '0');
+			}
+			if(p == end && digits != end)
+			{
+				return negative? -double(value) : double(value);
+			}
+		}
+
+		_stream.clear();
+		_stream.str(text);
+		double result;
+		_stream >> result;
+		if(!_stream.eof())
+		{
+			_stream >> std::ws;
+		}
+		if(_stream.fail() || _stream.bad() || _stream.get() != std::char_traits<char>::eof())
+		{
+			return defaultValue;
+		}
+		return result;
+	}
+};
+
+/**
+ * Reads a QUuid the way UUIDTranslator does, without the temporary string.
+ *
+ * @throws ptree_bad_data if the text is not of the form QUuid(...)
+ */
+QUuid parseUuid(const char *data, std::size_t size)
+{
+	static const char prefix[] = "QUuid(";
+	const std::size_t prefixSize = sizeof(prefix) - 1;
+	if(size < prefixSize + 1
+	   || std::memcmp(data, prefix, prefixSize) != 0
+	   || data[size - 1] != ')')
+	{
+		throw boost::property_tree::ptree_bad_data(
+			"conversion of data to type \"QUuid\" failed", std::string(data, size));
+	}
+
+	char buffer[64];
+	std::size_t innerSize = size - prefixSize - 1;
+	if(innerSize >= sizeof(buffer))
+	{
+		return QUuid(std::string(data + prefixSize, innerSize).c_str());
+	}
+
+	std::memcpy(buffer, data + prefixSize, innerSize);
+	buffer[innerSize] = '\0';
+	return QUuid(buffer);
+}
+
+/**
+ * Fills DiagramItemRecords from the events of a document of items.
+ *
+ * Item fields are recognized by comparing the key in place; as with
+ * ptree::get(), the first occurrence of each field wins. Only extraData is
+ * built as a tree, and given a BufferOwner only its eager children are;
+ * the rest is kept as an InfoRawTree.
+ */
+class RecordBuilder: public InfoHandler
+{
+	enum Field
+	{
+		Kind,
+		ScenePosX,
+		ScenePosY,
+		Rotation,
+		SceneZ,
+		Dependencies,
+		ExtraData,
+		FieldCount,
+		Ignored = FieldCount
+	};
+
+	enum Mode
+	{
+		ItemFields,
+		DependencyList,
+		ExtraDataTree,
+		Skip
+	};
+
+	std::function<void (DiagramItemRecord &)> _fn;
+	DiagramItemRecord _record;
+	NumberParser _numbers;
+
+	std::string _fieldData[FieldCount];
+	bool _fieldSeen[FieldCount];
+	Field _field;
+
+	std::size_t _depth;
+	Mode _mode;
+	std::size_t _modeDepth;
+	bool _haveItem;
+	bool _dependencyPending;
+	std::string _dependencyData;
+	std::unique_ptr<PtreeBuilder> _extraData;
+
+	// lazy extraData
+	BufferOwner _owner;
+	const char *_brace;
+	const char *_rawBegin;
+	bool _rawIncluded;
+	bool _childEager;
+
+	bool building() const
+	{
+		return !_owner || _childEager;
+	}
+
+	static Field fieldForKey(StringRef key)
+	{
+		if(key == "kind")         return Kind;
+		if(key == "scenePosX")    return ScenePosX;
+		if(key == "scenePosY")    return ScenePosY;
+		if(key == "rotation")     return Rotation;
+		if(key == "sceneZ")       return SceneZ;
+		if(key == "dependencies") return Dependencies;
+		if(key == "extraData")    return ExtraData;
+		return Ignored;
+	}
+
+	static void missing(const char *name)
+	{
+		throw boost::property_tree::ptree_bad_path(
+			std::string("No such node (") + name + ")", ptree::path_type(name));
+	}
+
+	void finishItem()
+	{
+		if(!_haveItem)
+		{
+			return;
+		}
+		_haveItem = false;
+
+		if(!_fieldSeen[Kind])         missing("kind");
+		if(!_fieldSeen[Dependencies]) missing("dependencies");
+		if(!_fieldSeen[ExtraData])    missing("extraData");
+
+		_record.kind = _fieldData[Kind];
+		_record.scenePos.setX(number(ScenePosX));
+		_record.scenePos.setY(number(ScenePosY));
+		_record.rotation = number(Rotation);
+		_record.sceneZ = number(SceneZ);
+
+		_fn(_record);
+	}
+
+	double number(Field field)
+	{
+		return _fieldSeen[field]? _numbers.parse(_fieldData[field], 0.0) : 0.0;
+	}
+
+	void finishRawExtraData()
+	{
+		if(_rawIncluded)
+		{
+			// the text is not all in the buffer
+			_record.extraData.clear();
+			readInfo(_rawBegin, _brace, _record.extraData);
+		}
+		else
+		{
+			_record.rawExtraData = std::make_shared<InfoRawTree>(_owner, _rawBegin, _brace);
+		}
+	}
+
+	void endDependency()
+	{
+		if(_dependencyPending)
+		{
+			_record.dependencies.push_back(parseUuid(_dependencyData.data(), _dependencyData.size()));
+			_dependencyPending = false;
+		}
+	}
+
+public:
+	RecordBuilder(const std::function<void (DiagramItemRecord &)> &fn, const BufferOwner &owner)
+	: _fn(fn)
+	, _field(Ignored)
+	, _depth(0)
+	, _mode(ItemFields)
+	, _modeDepth(0)
+	, _haveItem(false)
+	, _dependencyPending(false)
+	, _owner(owner)
+	, _brace(nullptr)
+	, _rawBegin(nullptr)
+	, _rawIncluded(false)
+	, _childEager(false)
+	{
+	}
+
+	void finish()
+	{
+		finishItem();
+	}
+
+	virtual void key(StringRef key)
+	{
+		if(_depth == 0)
+		{
+			finishItem();
+			_record.clear();
+			_record.uuid = parseUuid(key.data, key.size);
+			std::fill(std::begin(_fieldSeen), std::end(_fieldSeen), false);
+			_haveItem = true;
+			_field = Ignored;
+			return;
+		}
+
+		switch(_mode)
+		{
+		case ItemFields:
+			_field = fieldForKey(key);
+			if(_field != Ignored)
+			{
+				if(_fieldSeen[_field])
+				{
+					_field = Ignored;
+				}
+				else
+				{
+					_fieldSeen[_field] = true;
+					_fieldData[_field].clear();
+				}
+			}
+			break;
+		case DependencyList:
+			if(_depth == _modeDepth)
+			{
+				endDependency();
+				_dependencyPending = true;
+				_dependencyData.clear();
+			}
+			break;
+		case ExtraDataTree:
+			if(_owner && _depth == _modeDepth)
+			{
+				_childEager = isEagerExtraDataKey(key.data, key.size);
+			}
+			if(building())
+			{
+				_extraData->key(key);
+			}
+			break;
+		case Skip:
+			break;
+		}
+	}
+
+	virtual void data(StringRef data)
+	{
+		if(_depth == 0)
+		{
+			return;
+		}
+
+		switch(_mode)
+		{
+		case ItemFields:
+			if(_field != Ignored)
+			{
+				_fieldData[_field].assign(data.data, data.size);
+			}
+			break;
+		case DependencyList:
+			if(_depth == _modeDepth)
+			{
+				_dependencyData.assign(data.data, data.size);
+			}
+			break;
+		case ExtraDataTree:
+			if(building())
+			{
+				_extraData->data(data);
+			}
+			break;
+		case Skip:
+			break;
+		}
+	}
+
+	virtual void appendData(StringRef data)
+	{
+		if(_depth == 0)
+		{
+			return;
+		}
+
+		switch(_mode)
+		{
+		case ItemFields:
+			if(_field != Ignored)
+			{
+				_fieldData[_field].append(data.data, data.size);
+			}
+			break;
+		case DependencyList:
+			if(_depth == _modeDepth)
+			{
+				_dependencyData.append(data.data, data.size);
+			}
+			break;
+		case ExtraDataTree:
+			if(building())
+			{
+				_extraData->appendData(data);
+			}
+			break;
+		case Skip:
+			break;
+		}
+	}
+
+	virtual void open()
+	{
+		++_depth;
+		if(_depth == 1)
+		{
+			_mode = ItemFields;
+			return;
+		}
+
+		if(_mode == ItemFields)
+		{
+			_modeDepth = _depth;
+			if(_field == Dependencies)
+			{
+				_mode = DependencyList;
+				_dependencyPending = false;
+			}
+			else if(_field == ExtraData)
+			{
+				_mode = ExtraDataTree;
+				_extraData.reset(new PtreeBuilder(_record.extraData));
+				_rawBegin = _brace + 1;
+				_rawIncluded = false;
+				_childEager = false;
+			}
+			else
+			{
+				_mode = Skip;
+			}
+			_field = Ignored;
+		}
+		else if(_mode == ExtraDataTree && building())
+		{
+			_extraData->open();
+		}
+	}
+
+	virtual void close()
+	{
+		if(_mode != ItemFields && _depth == _modeDepth)
+		{
+			if(_mode == DependencyList)
+			{
+				endDependency();
+			}
+			else if(_mode == ExtraDataTree && _owner)
+			{
+				finishRawExtraData();
+			}
+			_mode = ItemFields;
+			_extraData.reset();
+		}
+		else if(_mode == ExtraDataTree && building())
+		{
+			_extraData->close();
+		}
+
+		--_depth;
+		_field = Ignored;
+	}
+
+	virtual void brace(const char *at)
+	{
+		_brace = at;
+	}
+
+	virtual void beginInclude()
+	{
+		if(_mode == ExtraDataTree)
+		{
+			_rawIncluded = true;
+			_extraData->beginInclude();
+		}
+	}
+
+	virtual void endInclude()
+	{
+		if(_mode == ExtraDataTree)
+		{
+			_extraData->endInclude();
+		}
+	}
+};
+
+}  // namespace
+
+void readInfo(const char *begin, const char *end, ptree &tree)
+{
+	ptree local;
+	PtreeBuilder builder(local);
+	InfoReader().read(begin, end, builder);
+	tree.swap(local);
+}
+
+void readInfo(std::istream &is, ptree &tree)
+{
+	std::string contents((std::istreambuf_iterator<char>(is)),
+	                     std::istreambuf_iterator<char>());
+	readInfo(contents.data(), contents.data() + contents.size(), tree);
+}
+
+void readDiagramItemRecords(const char *begin, const char *end,
+                            const std::function<void (DiagramItemRecord &)> &fn,
+                            const BufferOwner &owner)
+{
+	RecordBuilder builder(fn, owner);
+	InfoReader().read(begin, end, builder);
+	builder.finish();
+}
+
+namespace {
+
+struct Boundary
+{
+	const char *at;
+	unsigned long linesBefore;
+};
+
+/**
+ * Skips a quoted string starting at p, which points at its opening quote.
+ * Escapes are stepped over, not expanded.
+ *
+ * @return just past the closing quote, or nullptr if the line ends first
+ */
+const char *skipString(const char *p, const char *end)
+{
+	for(++p; p < end; ++p)
+	{
+		if(*p == '\\')
+		{
+			if(++p == end) break;
+		}
+		else if(*p == '"')
+		{
+			return p + 1;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ * Finds the lines that begin with a top-level key; a document can be cut
+ * at any of them and the pieces read independently.
+ *
+ * Follows the structure parse() sees (keys, data, braces, comments, quoted
+ * strings and their continuation lines), but only steps over tokens: it
+ * neither expands escapes nor calls a handler, so it costs a fraction of a
+ * parse. Input it cannot follow is left to the serial reader to report.
+ *
+ * @return false if the document uses #include or is not well formed
+ */
+bool findRecordBoundaries(const char *begin, const char *end, std::vector<Boundary> &boundaries)
+{
+	enum State { Key, Data, DataCont };
+
+	State state = Key;
+	std::size_t depth = 0;
+	unsigned long lineNo = 0;
+	for(const char *lineStart = begin; lineStart <= end; ++lineNo)
+	{
+		auto newline = lineStart == end? nullptr
+			: static_cast<const char *>(std::memchr(lineStart, '\n', end - lineStart));
+		auto lineEnd = newline? newline : end;
+		auto nul = lineStart == lineEnd? nullptr
+			: static_cast<const char *>(std::memchr(lineStart, '\0', lineEnd - lineStart));
+		const char *p = lineStart, *e = nul? nul : lineEnd;
+		const char *const line = lineStart;
+		lineStart = lineEnd + 1;
+
+		bool firstOnLine = true;
+		while(true)
+		{
+			while(p < e && isSpace(*p)) ++p;
+			if(p == e || *p == ';')
+			{
+				if(state == Data) state = Key;
+				break;
+			}
+
+			if(firstOnLine && *p == '#')
+			{
+				return false;
+			}
+
+			if(state != DataCont && (*p == '{' || *p == '}'))
+			{
+				if(*p == '{')
+				{
+					++depth;
+				}
+				else if(depth-- == 0)
+				{
+					return false;
+				}
+				++p;
+				state = Key;
+			}
+			else if(state == Key)
+			{
+				if(depth == 0 && firstOnLine)
+				{
+					boundaries.push_back(Boundary{line, lineNo});
+				}
+				if(*p == '"')
+				{
+					if(!(p = skipString(p, e))) return false;
+				}
+				else
+				{
+					while(p < e && !isSpace(*p) && *p != ';') ++p;
+				}
+				state = Data;
+			}
+			else if(*p == '"')
+			{
+				if(!(p = skipString(p, e))) return false;
+				while(p < e && isSpace(*p)) ++p;
+				state = Key;
+				if(p < e && *p == '\\')
+				{
+					++p;
+					state = DataCont;
+				}
+			}
+			else if(state == DataCont)
+			{
+				return false;
+			}
+			else
+			{
+				while(p < e && !isSpace(*p) && *p != ';') ++p;
+				state = Key;
+			}
+			firstOnLine = false;
+		}
+
+		if(!newline) break;
+	}
+
+	return depth == 0 && state != DataCont;
+}
+
+struct RecordRange
+{
+	const char *begin;
+	const char *end;
+	unsigned long linesBefore;
+	BufferOwner owner;
+};
+
+struct ParsedRange
+{
+	std::vector<DiagramItemRecord> records;
+	std::exception_ptr error;
+};
+
+typedef std::shared_ptr<ParsedRange> ParsedRangePtr;
+
+ParsedRangePtr parseRange(const RecordRange &range)
+{
+	ParsedRangePtr result(new ParsedRange);
+	try
+	{
+		auto &records = result->records;
+		RecordBuilder builder([&](DiagramItemRecord &record) {
+			records.emplace_back();
+			records.back().swap(record);
+		}, range.owner);
+		InfoReader().read(range.begin, range.end, builder, std::string(), range.linesBefore);
+		builder.finish();
+	}
+	catch(...)
+	{
+		result->error = std::current_exception();
+	}
+	return result;
+}
+
+// below this, the boundary scan and thread handoff cost more than they save
+const std::ptrdiff_t MinParallelSize = 1 << 20;
+
+}  // namespace
+
+void readDiagramItemRecordsParallel(const char *begin, const char *end,
+                                    const std::function<void (DiagramItemRecord &)> &fn,
+                                    const BufferOwner &owner)
+{
+	const int threads = QThread::idealThreadCount();
+	if(threads < 2 || end - begin < MinParallelSize)
+	{
+		readDiagramItemRecords(begin, end, fn, owner);
+		return;
+	}
+
+	std::vector<Boundary> boundaries;
+	if(!findRecordBoundaries(begin, end, boundaries) || boundaries.size() < 2)
+	{
+		// the serial reader reports malformed input, after any item errors before it
+		readDiagramItemRecords(begin, end, fn, owner);
+		return;
+	}
+
+	// a few ranges per thread so that uneven items still balance
+	QList<RecordRange> ranges;
+	const std::ptrdiff_t target = (end - begin) / (threads * 4) + 1;
+	RecordRange range{begin, nullptr, 0, owner};
+	for(const auto &b : boundaries)
+	{
+		if(b.at - range.begin >= target)
+		{
+			range.end = b.at;
+			ranges << range;
+			range = RecordRange{b.at, nullptr, b.linesBefore, owner};
+		}
+	}
+	range.end = end;
+	ranges << range;
+
+	auto future = QtConcurrent::mapped(ranges, parseRange);
+	try
+	{
+		for(int i = 0; i < ranges.size(); ++i)
+		{
+			// records before an error are delivered, as in a serial read
+			auto parsed = future.resultAt(i);
+			for(auto &record : parsed->records)
+			{
+				fn(record);
+			}
+
+			if(parsed->error)
+			{
+				std::rethrow_exception(parsed->error);
+			}
+		}
+	}
+	catch(...)
+	{
+		// the workers read from the caller's buffer
+		future.cancel();
+		future.waitForFinished();
+		throw;
+	}
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,176 @@
+#pragma once
+/**
+ * @file   InfoReader.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <string>
+#include <cstring>
+#include <functional>
+#include <vector>
+#include <iosfwd>
+#include <boost/property_tree/ptree_fwd.hpp>
+#include "RawTree.hpp"
+
+namespace dbuilder {
+
+struct DiagramItemRecord;
+
+/**
+ * A run of characters owned by someone else; either the document buffer
+ * or the reader's scratch buffer. Only valid for the duration of the
+ * InfoHandler call it is passed to.
+ */
+struct StringRef
+{
+	const char *data;
+	std::size_t size;
+
+	StringRef()
+	: data(nullptr)
+	, size(0)
+	{ }
+
+	StringRef(const char *data, std::size_t size)
+	: data(data)
+	, size(size)
+	{ }
+
+	bool empty() const { return size == 0; }
+	std::string str() const { return std::string(data, size); }
+
+	template <std::size_t N>
+	bool operator ==(const char (&literal)[N]) const
+	{
+		return size == N - 1 && std::memcmp(data, literal, N - 1) == 0;
+	}
+};
+
+/**
+ * Receives the structure of an INFO document as InfoReader tokenizes it.
+ */
+class InfoHandler
+{
+public:
+	virtual ~InfoHandler() { }
+
+	/// A new child of the current node.
+	virtual void key(StringRef key) = 0;
+	/// The data of the node created by the last call to key().
+	virtual void data(StringRef data) = 0;
+	/// A continuation line (trailing backslash) for the last data.
+	virtual void appendData(StringRef data) = 0;
+	/// Descend into the node created by the last call to key().
+	virtual void open() = 0;
+	/// Return to the parent of the current node.
+	virtual void close() = 0;
+
+	/// Called before the tokens of each line, with the start of the line.
+	virtual void beginLine(const char *) { }
+	/// Called before open() and close() with the position of the brace.
+	virtual void brace(const char *) { }
+
+	/// Brackets the nodes read from an #include'd file. The node that an
+	/// open() refers to must be the same afterwards as before.
+	virtual void beginInclude() { }
+	virtual void endInclude() { }
+};
+
+/**
+ * Builds a ptree the same way read_info() does.
+ */
+class PtreeBuilder: public InfoHandler
+{
+	std::vector<boost::property_tree::ptree *> _stack;
+	std::vector<boost::property_tree::ptree *> _includeLast;
+	boost::property_tree::ptree *_last;
+public:
+	PtreeBuilder(boost::property_tree::ptree &root);
+
+	virtual void key(StringRef key);
+	virtual void data(StringRef data);
+	virtual void appendData(StringRef data);
+	virtual void open();
+	virtual void close();
+	virtual void beginInclude();
+	virtual void endInclude();
+};
+
+/**
+ * A hand-written tokenizer for the INFO format accepted by
+ * boost::property_tree::read_info().
+ *
+ * It accepts exactly the same grammar, including quoted strings, escapes,
+ * continuation lines and #include, and reports errors with the same
+ * info_parser_error messages and line numbers. Unlike read_info() it
+ * works on a buffer already in memory and does not copy keys or data
+ * unless they contain escapes.
+ */
+class InfoReader
+{
+	std::string _scratch;
+	std::string _filename;
+	int _includeDepth;
+
+	class Line;
+	void parse(const char *begin, const char *end, InfoHandler &handler, unsigned long firstLine=0);
+	void include(const std::string &filename, InfoHandler &handler, unsigned long lineNo);
+
+public:
+	InfoReader();
+
+	/**
+	 * @throws boost::property_tree::info_parser::info_parser_error
+	 */
+	void read(const char *begin, const char *end, InfoHandler &handler,
+	          const std::string &filename=std::string());
+
+	/**
+	 * Reads part of a document that starts at the beginning of a line, with
+	 * no open braces. Line numbers in errors start after linesBefore.
+	 */
+	void read(const char *begin, const char *end, InfoHandler &handler,
+	          const std::string &filename, unsigned long linesBefore);
+};
+
+/**
+ * Drop-in replacements for read_info() built on InfoReader.
+ */
+void readInfo(const char *begin, const char *end, boost::property_tree::ptree &tree);
+void readInfo(std::istream &is, boost::property_tree::ptree &tree);
+
+/**
+ * Reads a document written by InfoDiagramLoader, calling fn once per item
+ * in document order. The record passed to fn is reused for the next item.
+ *
+ * Enforces the same requirements as the DiagramItemModel ptree constructor
+ * (a UUID key and kind, dependencies and extraData children) but does not
+ * build a property tree for anything except extraData.
+ *
+ * If owner is given, it must keep the buffer alive. extraData is then left
+ * in the buffer as DiagramItemRecord::rawExtraData, and only the children
+ * that isEagerExtraDataKey() selects are built.
+ *
+ * @throws boost::property_tree::info_parser::info_parser_error
+ * @throws boost::property_tree::ptree_error
+ */
+void readDiagramItemRecords(const char *begin, const char *end,
+                            const std::function<void (DiagramItemRecord &)> &fn,
+                            const BufferOwner &owner=BufferOwner());
+
+/**
+ * Same as readDiagramItemRecords(), but parses on QThreadPool's threads.
+ *
+ * One serial pass steps over the document's braces, strings and comments,
+ * without tokenizing it, to find the lines where top-level items begin.
+ * Ranges of items are then parsed in parallel. fn is called on the calling thread, in document
+ * order, as soon as the records before it are ready. Small documents and
+ * documents that use #include are read serially.
+ */
+void readDiagramItemRecordsParallel(const char *begin, const char *end,
+                                    const std::function<void (DiagramItemRecord &)> &fn,
+                                    const BufferOwner &owner=BufferOwner());
+
+}  // namespace dbuilder
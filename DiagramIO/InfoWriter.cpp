@@ -0,0 +1,270 @@
+/**
+ * @file   InfoWriter.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "InfoWriter.hpp"
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <locale>
+#include <sstream>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/info_parser.hpp>
+
+using boost::property_tree::ptree;
+
+namespace dbuilder {
+
+namespace {
+
+const std::size_t IndentCount = 4;
+const char Spaces[] = "                                ";
+
+/// Same as boost's create_escapes().
+void createEscapes(const char *b, const char *e, std::string &result)
+{
+	result.clear();
+	for(; b != e; ++b)
+	{
+		switch(*b)
+		{
+		case '\0': result += "\\0";  break;
+		case '\a': result += "\\a";  break;
+		case '\b': result += "\\b";  break;
+		case '\f': result += "\\f";  break;
+		case '\n': result += "\\n";  break;
+		case '\r': result += "\\r";  break;
+		case '\v': result += "\\v";  break;
+		case '"':  result += "\\\""; break;
+		case '\\': result += "\\\\"; break;
+		default:   result += *b;
+		}
+	}
+}
+
+/// Same as boost's is_simple_key() and is_simple_data().
+bool isSimple(const std::string &s)
+{
+	return !s.empty() && s.find_first_of(" \t{};\n\"") == std::string::npos;
+}
+
+void toHex(char *&out, unsigned long value, int digits)
+{
+	static const char Digits[] = "0123456789abcdef";
+	for(int i = digits - 1; i >= 0; --i)
+	{
+		out[i] = Digits[value & 0xf];
+		value >>= 4;
+	}
+	out += digits;
+}
+
+}  // namespace
+
+void InfoWriter::formatUuid(const QUuid &uuid, char *out)
+{
+	// matches QUuid::toString() wrapped by UUIDTranslator
+	std::memcpy(out, "QUuid({", 7);
+	out += 7;
+	toHex(out, uuid.data1, 8);
+	*out++ = '-';
+	toHex(out, uuid.data2, 4);
+	*out++ = '-';
+	toHex(out, uuid.data3, 4);
+	*out++ = '-';
+	toHex(out, uuid.data4[0], 2);
+	toHex(out, uuid.data4[1], 2);
+	*out++ = '-';
+	for(int i = 2; i < 8; ++i)
+	{
+		toHex(out, uuid.data4[i], 2);
+	}
+	*out++ = '}';
+	*out++ = ')';
+}
+
+InfoWriter::InfoWriter(std::ostream &os)
+: _os(os)
+, _indent(0)
+, _number(&_numberBuf)
+{
+	_number.imbue(std::locale());
+	_number.precision(std::numeric_limits<double>::max_digits10);
+}
+
+void InfoWriter::indent(int level)
+{
+	std::size_t n = level * IndentCount;
+	while(n > 0)
+	{
+		std::size_t chunk = std::min(n, sizeof(Spaces) - 1);
+		_os.write(Spaces, chunk);
+		n -= chunk;
+	}
+}
+
+void InfoWriter::key(const char *data, std::size_t size)
+{
+	indent(_indent);
+	createEscapes(data, data + size, _escaped);
+	if(isSimple(_escaped))
+	{
+		_os << _escaped;
+	}
+	else
+	{
+		_os << '"' << _escaped << '"';
+	}
+}
+
+void InfoWriter::data(const char *data, std::size_t size)
+{
+	if(size == 0)
+	{
+		_os << " \"\"\n";
+		return;
+	}
+
+	createEscapes(data, data + size, _escaped);
+	if(isSimple(_escaped))
+	{
+		_os << ' ' << _escaped << '\n';
+	}
+	else
+	{
+		_os << " \"" << _escaped << "\"\n";
+	}
+}
+
+void InfoWriter::open(const std::string &key)
+{
+	this->key(key.data(), key.size());
+	_os << '\n';
+	indent(_indent);
+	_os << "{\n";
+	++_indent;
+}
+
+void InfoWriter::openUuid(const QUuid &key)
+{
+	char buf[UuidSize];
+	formatUuid(key, buf);
+	this->key(buf, sizeof(buf));
+	_os << '\n';
+	indent(_indent);
+	_os << "{\n";
+	++_indent;
+}
+
+void InfoWriter::close()
+{
+	--_indent;
+	indent(_indent);
+	_os << "}\n";
+}
+
+void InfoWriter::putRaw(const std::string &key, const char *begin, const char *end)
+{
+	this->key(key.data(), key.size());
+	_os << '\n';
+	indent(_indent);
+	_os << '{';
+	_os.write(begin, end - begin);
+	_os << "}\n";
+}
+
+void InfoWriter::put(const std::string &key, const std::string &value)
+{
+	this->key(key.data(), key.size());
+	data(value.data(), value.size());
+}
+
+void InfoWriter::put(const std::string &key, double value)
+{
+	_numberBuf.reset();
+	_number.clear();
+	_number << value;
+	if(_number)
+	{
+		this->key(key.data(), key.size());
+		data(_numberBuf.data(), _numberBuf.size());
+	}
+	else
+	{
+		// longer than the fixed buffer; format as ptree would
+		std::ostringstream os;
+		os.imbue(std::locale());
+		os.precision(std::numeric_limits<double>::max_digits10);
+		os << value;
+		put(key, os.str());
+	}
+}
+
+void InfoWriter::put(const std::string &key, const QUuid &value)
+{
+	char buf[UuidSize];
+	formatUuid(value, buf);
+	this->key(key.data(), key.size());
+	data(buf, sizeof(buf));
+}
+
+void InfoWriter::put(const std::string &key, const ptree &tree, const ptree *more)
+{
+	this->key(key.data(), key.size());
+
+	bool hasChildren = !tree.empty() || (more && !more->empty());
+	if(!tree.data().empty())
+	{
+		data(tree.data().data(), tree.data().size());
+	}
+	else if(!hasChildren)
+	{
+		_os << " \"\"\n";
+	}
+	else
+	{
+		_os << '\n';
+	}
+
+	if(hasChildren)
+	{
+		indent(_indent);
+		_os << "{\n";
+		++_indent;
+		children(tree, more);
+		--_indent;
+		indent(_indent);
+		_os << "}\n";
+	}
+}
+
+void InfoWriter::children(const ptree &node, const ptree *more)
+{
+	for(const auto &child : node)
+	{
+		put(child.first, child.second);
+	}
+
+	if(more)
+	{
+		children(*more, nullptr);
+	}
+}
+
+void InfoWriter::putChildren(const ptree &tree)
+{
+	children(tree, nullptr);
+}
+
+void InfoWriter::finish()
+{
+	if(!_os.good())
+	{
+		throw boost::property_tree::info_parser::info_parser_error("write error", "", 0);
+	}
+}
+
+}  // namespace dbuilder
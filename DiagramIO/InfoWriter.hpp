@@ -0,0 +1,105 @@
+#pragma once
+/**
+ * @file   InfoWriter.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <string>
+#include <iosfwd>
+#include <streambuf>
+#include <ostream>
+#include <QUuid>
+#include <boost/property_tree/ptree_fwd.hpp>
+
+namespace dbuilder {
+
+/**
+ * Writes INFO text directly to a stream, producing the same bytes that
+ * write_info() would for the equivalent ptree.
+ *
+ * Nodes are emitted as they are visited, so documents can be serialized
+ * without first building a tree of the whole document. Numbers and UUIDs
+ * are formatted into fixed buffers.
+ */
+class InfoWriter
+{
+	/// A streambuf over a fixed array; formatting fails instead of allocating.
+	class FixedBuf: public std::streambuf
+	{
+		char _buf[64];
+	public:
+		FixedBuf() { reset(); }
+		void reset() { setp(_buf, _buf + sizeof(_buf)); }
+		const char *data() const { return pbase(); }
+		std::size_t size() const { return pptr() - pbase(); }
+	};
+
+	std::ostream &_os;
+	int _indent;
+	std::string _escaped;
+	FixedBuf _numberBuf;
+	std::ostream _number;
+
+	void indent(int level);
+	void key(const char *data, std::size_t size);
+	void data(const char *data, std::size_t size);
+	void children(const boost::property_tree::ptree &node, const boost::property_tree::ptree *more);
+
+public:
+	/**
+	 * The length of a formatted UUID, "QUuid({xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx})".
+	 */
+	static const std::size_t UuidSize = 45;
+	/**
+	 * Formats a UUID as UUIDTranslator does, without allocating.
+	 * Writes exactly UuidSize characters.
+	 */
+	static void formatUuid(const QUuid &uuid, char *out);
+
+	InfoWriter(std::ostream &os);
+
+	/**
+	 * Starts a node with children, nested in the current one.
+	 */
+	void open(const std::string &key);
+	void openUuid(const QUuid &key);
+	void close();
+
+	/**
+	 * Writes a node without children.
+	 */
+	void put(const std::string &key, const std::string &value);
+	void put(const std::string &key, double value);
+	void put(const std::string &key, const QUuid &value);
+
+	/**
+	 * Writes a node with the data and children of tree. If more is given,
+	 * its children are written after those of tree, as if they had been
+	 * appended to it.
+	 */
+	void put(const std::string &key, const boost::property_tree::ptree &tree,
+	         const boost::property_tree::ptree *more=nullptr);
+
+	/**
+	 * Writes a node whose children are the INFO text from begin to end,
+	 * copied as it is. The text is what was read between the braces of a
+	 * node; it is expected to be indented for the current level already.
+	 */
+	void putRaw(const std::string &key, const char *begin, const char *end);
+
+	/**
+	 * Writes the children of tree at the current level, as write_info()
+	 * does for a whole document.
+	 */
+	void putChildren(const boost::property_tree::ptree &tree);
+
+	/**
+	 * @throws boost::property_tree::info_parser::info_parser_error if the
+	 * stream is in a failed state
+	 */
+	void finish();
+};
+
+}  // namespace dbuilder
@@ -0,0 +1,149 @@
+/**
+ * @file   RawTree.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "RawTree.hpp"
+#include <vector>
+#include <cstring>
+#include <boost/property_tree/ptree.hpp>
+#include "InfoReader.hpp"
+#include "AttributeStore.hpp"
+
+namespace dbuilder {
+
+namespace {
+
+/**
+ * Follows a path through the events of a tree. Like ptree::get_child(), it
+ * only descends into the first child with each key and does not backtrack.
+ */
+class PathFinder: public InfoHandler
+{
+	std::vector<std::string> _path;
+	std::size_t _depth;
+	// depth of the deepest node matched so far
+	std::size_t _matched;
+	bool _levelUsed;
+	bool _candidate;
+	bool _target;
+	bool _done;
+
+public:
+	boost::optional<std::string> result;
+
+	PathFinder(const std::string &path)
+	: _depth(0)
+	, _matched(0)
+	, _levelUsed(false)
+	, _candidate(false)
+	, _target(false)
+	, _done(false)
+	{
+		std::string::size_type begin = 0, dot;
+		while((dot = path.find('.', begin)) != std::string::npos)
+		{
+			_path.push_back(path.substr(begin, dot - begin));
+			begin = dot + 1;
+		}
+		_path.push_back(path.substr(begin));
+	}
+
+	virtual void key(StringRef key)
+	{
+		_candidate = _target = false;
+		if(result)
+		{
+			_done = true;
+		}
+		if(_done || _depth != _matched || _levelUsed)
+		{
+			return;
+		}
+
+		const auto &expected = _path[_depth];
+		if(key.size == expected.size() && std::memcmp(key.data, expected.data(), key.size) == 0)
+		{
+			_levelUsed = true;
+			if(_depth + 1 == _path.size())
+			{
+				result = std::string();
+				_target = true;
+			}
+			else
+			{
+				_candidate = true;
+			}
+		}
+	}
+
+	virtual void data(StringRef data)
+	{
+		if(_target)
+		{
+			result->assign(data.data, data.size);
+		}
+	}
+
+	virtual void appendData(StringRef data)
+	{
+		if(_target)
+		{
+			result->append(data.data, data.size);
+		}
+	}
+
+	virtual void open()
+	{
+		++_depth;
+		if(_candidate)
+		{
+			_matched = _depth;
+			_levelUsed = false;
+		}
+		_candidate = _target = false;
+	}
+
+	virtual void close()
+	{
+		// leaving the node that matched the path so far
+		if(_depth == _matched && _matched > 0)
+		{
+			_done = true;
+		}
+		--_depth;
+		_candidate = _target = false;
+	}
+};
+
+}  // namespace
+
+void RawTree::materialize(boost::property_tree::ptree &dst) const
+{
+	PtreeBuilder builder(dst);
+	walk(builder);
+}
+
+boost::optional<std::string> RawTree::find(const std::string &path) const
+{
+	PathFinder finder(path);
+	walk(finder);
+	return finder.result;
+}
+
+void InfoRawTree::walk(InfoHandler &handler) const
+{
+	// the text was read once already, so it cannot fail now
+	InfoReader().read(_begin, _end, handler);
+}
+
+bool isEagerExtraDataKey(const char *key, std::size_t size)
+{
+	static const char Connection[] = "connection";
+	return (size == sizeof(Connection) - 1 && std::memcmp(key, Connection, size) == 0)
+		|| isAttributeRoot(key, size);
+}
+
+}  // namespace dbuilder
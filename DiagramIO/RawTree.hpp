@@ -0,0 +1,89 @@
+#pragma once
+/**
+ * @file   RawTree.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <string>
+#include <memory>
+#include <boost/optional.hpp>
+#include <boost/property_tree/ptree_fwd.hpp>
+
+namespace dbuilder {
+
+class InfoHandler;
+
+/// Keeps a document buffer alive for as long as something refers into it.
+typedef std::shared_ptr<const void> BufferOwner;
+
+/**
+ * A property tree left in the encoding it was read from, so that it costs
+ * nothing until it is needed and can be written back unchanged.
+ *
+ * Readers keep the extraData of items this way when they are given a
+ * BufferOwner. Implementations must not throw from walk(); readers check
+ * the encoding before creating them.
+ */
+class RawTree
+{
+public:
+	virtual ~RawTree() { }
+
+	/**
+	 * Reports the children of the tree, as InfoReader would for a document
+	 * holding them. Any thread may call this.
+	 */
+	virtual void walk(InfoHandler &handler) const = 0;
+
+	/**
+	 * Appends the children of the tree to dst.
+	 */
+	void materialize(boost::property_tree::ptree &dst) const;
+
+	/**
+	 * @return the data of the node at a dotted path, found the way
+	 * ptree::get_child() finds it, or none if there is no such node
+	 */
+	boost::optional<std::string> find(const std::string &path) const;
+};
+
+typedef std::shared_ptr<const RawTree> RawTreePtr;
+
+/**
+ * A tree kept as the INFO text between the braces of its node.
+ */
+class InfoRawTree: public RawTree
+{
+	BufferOwner _owner;
+	const char *_begin;
+	const char *_end;
+
+public:
+	InfoRawTree(const BufferOwner &owner, const char *begin, const char *end)
+	: _owner(owner)
+	, _begin(begin)
+	, _end(end)
+	{ }
+
+	const char *begin() const { return _begin; }
+	const char *end() const { return _end; }
+
+	virtual void walk(InfoHandler &handler) const;
+};
+
+/**
+ * @return true for the top-level extraData keys that readers decode even
+ * when they keep the rest of an item's extraData raw: the connection and
+ * the roots of attribute paths, which the model reads as soon as it is
+ * created.
+ */
+bool isEagerExtraDataKey(const char *key, std::size_t size);
+
+inline bool isEagerExtraDataKey(const std::string &key)
+{
+	return isEagerExtraDataKey(key.data(), key.size());
+}
+
+}  // namespace dbuilder
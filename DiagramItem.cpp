@@ -10,6 +10,7 @@
 #include <cassert>
 #include "DiagramComponent.hpp"
 #include <QPen>
+#include <QPainter>
 #include <QGraphicsSceneMouseEvent>
 #include "DiagramItemModel.hpp"
 #include <iostream>
@@ -25,6 +26,28 @@
 
 
 namespace dbuilder {
+namespace {
+
+/// a port, drawn only when its item is drawn in full
+class PortSymbolItem: public QGraphicsEllipseItem
+{
+	DiagramItem *_item;
+public:
+	PortSymbolItem(const QRectF &rect, DiagramItem *item)
+	: QGraphicsEllipseItem(rect, item)
+	, _item(item)
+	{ }
+
+	void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+	{
+		if(_item->detailLevel(painter) == DetailLevel::Full)
+		{
+			QGraphicsEllipseItem::paint(painter, option, widget);
+		}
+	}
+};
+
+}  // anonymous namespace
 
 DiagramItem::DiagramItem(QObject *parent)
 : QObject(parent)
@@ -35,16 +58,20 @@ DiagramItem::DiagramItem(QObject *parent)
 void DiagramItem::init()
 {
 	_model = nullptr;
+	_handle = InvalidItemHandle;
 	_dragging = false;
 	_printMode = false;
 	_explicitSelectionOnly = false;
 	_highlightedPort = -1;
+	_flattened = false;
+	_hoveredPort = -1;
 	_positionBeingSet = false;
 	_itemSnaps = true;
 	_settingsModel = nullptr;
 	_positionByCenter = true;
 	_app = dbuilder::Application::instance();
 	_editMode = false;
+	_editorOpen = false;
 
 	connect(_app, SIGNAL(settingsChanged()), this, SLOT(settingsChanged()));
 
@@ -89,6 +116,13 @@ void DiagramItem::settingsChanged()
 
 void DiagramItem::setHighlightedPort(int port)
 {
+	if(_flattened)
+	{
+		_highlightedPort = port;
+		update();
+		return;
+	}
+
 	if(_highlightedPort != -1)
 	{
 		_portSymbols[_highlightedPort]->setBrush(QBrush(QColor(0, 0, 0, 0))); //QColor("SlateBlue")));
@@ -106,7 +140,14 @@ void DiagramItem::setHighlightedPort(int port)
 void DiagramItem::addPort(QPointF loc)
 {
 	_portLocations.push_back(loc);
-	_portSymbols.push_back(new QGraphicsEllipseItem(loc.x()-5, loc.y()-5, 10, 10, this));
+	if(_flattened)
+	{
+		update(portRect(_portLocations.size() - 1));
+		emit posChanged(this->scenePos());
+		return;
+	}
+
+	_portSymbols.push_back(new PortSymbolItem(QRectF(loc.x()-5, loc.y()-5, 10, 10), this));
 	_portSymbols.back()->setPen(QPen(_app->portOutlineColor()));
 
 	emit posChanged(this->scenePos());
@@ -129,9 +170,84 @@ void DiagramItem::setPrintMode(bool printMode)
 			sym->setPen(QPen(_app->portOutlineColor()));
 		}
 	}
+	if(_flattened)
+	{
+		update();
+	}
 	emit printModeChanged(printMode);
 }
 
+void DiagramItem::setFlattened(const QRectF &symbolBounds)
+{
+	assert(_portSymbols.empty());
+	_flattened = true;
+	_symbolBounds = symbolBounds;
+	update();
+}
+
+/// @return the bounds of the circle drawn for port, with its outline
+QRectF DiagramItem::portRect(int port) const
+{
+	const QPointF loc = _portLocations[port];
+	return QRectF(loc.x() - 5.5, loc.y() - 5.5, 11, 11);
+}
+
+void DiagramItem::setHoveredPort(int port)
+{
+	if(port != _hoveredPort)
+	{
+		if(_hoveredPort != -1 && _hoveredPort < _portLocations.size())
+		{
+			update(portRect(_hoveredPort));
+		}
+		_hoveredPort = port;
+		if(_hoveredPort != -1)
+		{
+			update(portRect(_hoveredPort));
+		}
+	}
+}
+
+void DiagramItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+	QGraphicsRectItem::paint(painter, option, widget);
+	if(!_flattened)
+	{
+		return;
+	}
+
+	const auto level = detailLevel(painter);
+	if(_model && _model->kind())
+	{
+		_model->kind()->paintSymbol(this, painter, level);
+	}
+
+	if(level == DetailLevel::Full && !_printMode && !_portLocations.empty())
+	{
+		painter->save();
+		painter->setPen(QPen(_app->portOutlineColor(), 0));
+		for(int i = 0; i < _portLocations.size(); ++i)
+		{
+			painter->setBrush(i == _hoveredPort? QBrush(Qt::black)
+				: i == _highlightedPort? QBrush(_app->portHighlightColor())
+				: QBrush(Qt::NoBrush));
+			painter->drawEllipse(_portLocations[i], 5, 5);
+		}
+		painter->restore();
+	}
+}
+
+DetailLevel DiagramItem::detailLevel(const QPainter *painter) const
+{
+	if(_printMode || !_app)
+	{
+		return DetailLevel::Full;
+	}
+
+	const QRectF bounds = rect();
+	return _app->levelOfDetail().levelFor(qMax(bounds.width(), bounds.height()) * LevelOfDetail::scale(painter));
+}
+
 const QList<QPointF>& DiagramItem::portLocations() const
 {
 	return _portLocations;
@@ -224,6 +340,13 @@ QVariant DiagramItem::itemChange(GraphicsItemChange change,
 
 void DiagramItem::hoverMoveEvent(QGraphicsSceneHoverEvent* event)
 {
+	if(_flattened)
+	{
+		setHoveredPort(portAt(event->pos()));
+		QGraphicsRectItem::hoverMoveEvent(event);
+		return;
+	}
+
 	for(auto item : _portSymbols)
 	{
 		if(item->contains(event->pos()))
@@ -240,6 +363,7 @@ void DiagramItem::hoverMoveEvent(QGraphicsSceneHoverEvent* event)
 
 void DiagramItem::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
 {
+	setHoveredPort(-1);
 	for(auto item : _portSymbols)
 	{
 		item->setBrush(QBrush(QColor(0,0,0,0)));
@@ -282,10 +406,32 @@ void DiagramItem::deleteDiagramItem()
 
 void DiagramItem::updateBoundingBox()
 {
-	this->setRect(this->childrenBoundingRect());
+	QRectF bounds = this->childrenBoundingRect();
+	if(_flattened)
+	{
+		bounds |= _symbolBounds;
+		for(int i = 0; i < _portLocations.size(); ++i)
+		{
+			bounds |= portRect(i);
+		}
+	}
+	this->setRect(bounds);
 }
 int DiagramItem::portAt(QPointF point)
 {
+	if(_flattened)
+	{
+		for(int i = 0; i < _portLocations.size(); ++i)
+		{
+			const QPointF d = point - _portLocations[i];
+			if(d.x() * d.x() + d.y() * d.y() <= 25)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+
 	int i = 0;
 	for(auto item : _portSymbols)
 	{
@@ -325,6 +471,11 @@ void DiagramItem::clearPorts()
 
 	this->_portSymbols.clear();
 	this->_portLocations.clear();
+	if(_flattened)
+	{
+		_hoveredPort = -1;
+		update();
+	}
 	emit posChanged(this->scenePos());
 }
 
@@ -482,6 +633,7 @@ void DiagramItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
 		emit connectorDragEnd(event->scenePos());
 	}
 
+	setHoveredPort(-1);
 	for(auto item : _portSymbols)
 	{
 		item->setBrush(QBrush(QColor(0, 0, 0, 0)));
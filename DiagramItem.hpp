@@ -6,6 +6,7 @@
 #include <iosfwd>
 #include "CoreForward.hpp"
 #include "Util/Extendable.hpp"
+#include "LevelOfDetail.hpp"
 /**
  * @file   DiagramItem.h
  *
@@ -36,8 +37,12 @@ class DiagramItem
 	friend class DiagramScene;
 	friend class DiagramComponent;
 	DiagramItemModel *_model;
+	ItemHandle _handle;
 	QList<QPointF> _portLocations;
 	QList<QGraphicsEllipseItem *> _portSymbols;
+	bool _flattened;
+	QRectF _symbolBounds;
+	int _hoveredPort;
 	bool _dragging;
 	bool _printMode;
 	bool _explicitSelectionOnly;
@@ -53,8 +58,11 @@ class DiagramItem
 	dbuilder::Application *_app;
 
 	bool _editMode;
+	bool _editorOpen;
 
 	void init();
+	QRectF portRect(int port) const;
+	void setHoveredPort(int port);
 
 	Q_PROPERTY(QPointF pos READ pos WRITE setPos)
 	Q_PROPERTY(qreal x READ x WRITE setX)
@@ -76,6 +84,22 @@ public:
 	int portAt(QPointF);
 	void clearPorts();
 
+	/**
+	 * Makes this item draw its symbol with DiagramComponent::paintSymbol()
+	 * and its ports itself, instead of with child items. Call from
+	 * DiagramComponent::configure(), before adding ports.
+	 *
+	 * @param symbolBounds  where the symbol is drawn, in item coordinates
+	 */
+	void setFlattened(const QRectF &symbolBounds);
+
+	bool flattened() const
+	{
+		return _flattened;
+	}
+
+	void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget=nullptr);
+
 	void updateBoundingBox();
 	virtual ~DiagramItem();
 
@@ -89,6 +113,15 @@ public:
 
 	void setModel(DiagramItemModel*);
 
+	/**
+	 * @return the handle assigned by the scene, or InvalidItemHandle if the
+	 * item has never been added to one
+	 */
+	ItemHandle handle() const
+	{
+		return _handle;
+	}
+
 	bool printMode() const
 	{
 		return _printMode;
@@ -96,6 +129,13 @@ public:
 
 	void setPrintMode(bool printMode);
 
+	/**
+	 * @return how much of this item and its children to draw with painter,
+	 * by the size of the item on the device; always DetailLevel::Full in
+	 * print mode
+	 */
+	DetailLevel detailLevel(const QPainter *painter) const;
+
 	bool explicitSelectionOnly() const
 	{
 		return _explicitSelectionOnly;
@@ -149,6 +189,21 @@ public slots:
 
 	void setEditMode(bool);
 	bool editMode() const;
+
+	/**
+	 * @return whether an editor in the view holds changes that reach the
+	 * model only when it is asked to update (see
+	 * DiagramItemModel::requestUpdateModel())
+	 */
+	bool editorOpen() const
+	{
+		return _editorOpen;
+	}
+
+	void setEditorOpen(bool editorOpen)
+	{
+		_editorOpen = editorOpen;
+	}
 signals:
 	void printModeChanged(bool);
 	void posChanged(QPointF);
@@ -11,15 +11,52 @@
 #include "DiagramComponent.hpp"
 #include <boost/lexical_cast.hpp>
 #include "UUIDMapper.hpp"
+#include "DiagramIO/InfoWriter.hpp"
+#include "Util/Log.hpp"
 #include <boost/property_tree/info_parser.hpp>
 #include <iostream>
 
 namespace dbuilder {
 
 
+static Connection readConnection(const pt::ptree &connTree)
+{
+	return Connection {
+		connTree.get<QUuid>("src"),
+		connTree.get<int>("srcPort"),
+		connTree.get<QUuid>("dst"),
+		connTree.get<int>("dstPort"),
+		connTree.get("center", 0.5)
+	};
+}
+
+static pt::ptree writeConnection(const Connection &conn)
+{
+	pt::ptree connTree;
+	connTree.put("src", conn.src);
+	connTree.put("srcPort", conn.srcPort);
+	connTree.put("dst", conn.dst);
+	connTree.put("dstPort", conn.dstPort);
+	connTree.put("center", conn.center);
+	return connTree;
+}
+
+static bool sameConnection(const optional<Connection> &a, const optional<Connection> &b)
+{
+	if(!a || !b)
+	{
+		return !a == !b;
+	}
+	return a->src == b->src && a->srcPort == b->srcPort
+		&& a->dst == b->dst && a->dstPort == b->dstPort
+		&& a->center == b->center;
+}
+
 DiagramItemModel::DiagramItemModel(DiagramContext *ctx, const pt::ptree::value_type &data, QObject *parent)
 : QObject(parent)
 , _ctx(ctx)
+, _extraData(std::make_shared<pt::ptree>())
+, _materialized(true)
 {
 	UUIDTranslator ut;
 	_uuid = ut.get_value(data.first).get();
@@ -37,40 +74,176 @@ DiagramItemModel::DiagramItemModel(DiagramContext *ctx, const pt::ptree::value_t
 		addDependency(pv.second.get_value<QUuid>());
 	}
 
-	_extraData = data.second.get_child("extraData");
+	loadExtraData(data.second.get_child("extraData"));
 }
 
-DiagramItemModel::DiagramItemModel(DiagramContext *ctx, QObject *parent)
-: QObject(parent)
-, _ctx(ctx)
-, _uuid(QUuid::createUuid())
-, _kind(nullptr)
-, _rotation(0)
-, _sceneZ(0)
+void DiagramItemModel::loadExtraData(pt::ptree extraData, RawTreePtr raw)
+{
+	assert(_kind);
+	_raw.reset();
+	_materialized = true;
+	_extraData = std::make_shared<pt::ptree>();
+	_extraData->swap(extraData);
+	_extraDataOrder.reset();
+
+	// the connection is kept decoded; it is written back to extraData in
+	// save(), where it was, so the order is taken before anything is erased
+	auto connIt = _extraData->find("connection");
+	const bool hasConnection = connIt != _extraData->not_found();
+	if(hasConnection)
+	{
+		_extraDataOrder = std::make_shared<KeyOrder>(keyOrder(*_extraData));
+	}
+
+	_attributes.clear();
+	_attributes.load(_kind->attributeSlots(), *_extraData);
+
+	if(!hasConnection)
+	{
+		// a connection from the tree this one replaces is gone with it
+		setConnection(boost::none);
+	}
+	else
+	{
+		connIt = _extraData->find("connection");
+		try
+		{
+			setConnection(readConnection(connIt->second));
+			_extraData->erase(_extraData->to_iterator(connIt));
+		}
+		catch(const pt::ptree_error &exc)
+		{
+			// only this connector is affected; the subtree is saved as it was
+			DBWarning("Ignoring malformed connection of ", _uuid, ": ", exc.what());
+			_extraDataOrder.reset();
+			setConnection(boost::none);
+		}
+	}
+
+	_raw = std::move(raw);
+	_materialized = !_raw;
+}
+
+void DiagramItemModel::materialize() const
+{
+	if(_materialized)
+	{
+		return;
+	}
+
+	// the eager children were decoded when the model was loaded, and what
+	// is left of them is in _extraData; it takes their places, so the
+	// children keep the order they were read in
+	pt::ptree raw, rest = *_extraData;
+	_raw->materialize(raw);
+	auto tree = std::make_shared<pt::ptree>();
+	for(const auto &child : raw)
+	{
+		if(!isEagerExtraDataKey(child.first))
+		{
+			tree->push_back(child);
+			continue;
+		}
+
+		auto it = rest.find(child.first);
+		if(it != rest.not_found())
+		{
+			auto restIt = rest.to_iterator(it);
+			tree->push_back(*restIt);
+			rest.erase(restIt);
+		}
+	}
+	for(const auto &child : rest)
+	{
+		tree->push_back(child);
+	}
+
+	_extraData = tree;
+	_materialized = true;
+}
+
+void DiagramItemModel::discardRaw()
 {
+	materialize();
+	_raw.reset();
+}
 
+optional<std::string> DiagramItemModel::findData(const std::string &path) const
+{
+	if(!_materialized && !isEagerExtraDataKey(path.substr(0, path.find('.'))))
+	{
+		return _raw->find(path);
+	}
+	const pt::ptree &extraData = *_extraData;
+	if(auto node = extraData.get_child_optional(path))
+	{
+		return node->data();
+	}
+	return {};
 }
 
-boost::optional<Connection> DiagramItemModel::connection() const
+void DiagramItemModel::removeData(const std::string &key)
 {
-	if(auto connTree = getTree("connection"))
+	int slot = findAttribute(key);
+	if(slot >= 0 && _attributes.remove(slot))
+	{
+		discardRaw();
+		emit changed();
+	}
+	if(findData(key))
 	{
-		Connection conn {
-			connTree->get<QUuid>("src"),
-			connTree->get<int>("srcPort"),
-			connTree->get<QUuid>("dst"),
-			connTree->get<int>("dstPort"),
-			connTree->get("center", 0.5)
-		};
+		extraData().erase(key);
+		emit changed();
+	}
+}
+
+void DiagramItemModel::saveExtraData(pt::ptree &dst) const
+{
+	materialize();
+	dst = *_extraData;
+	_attributes.save(dst);
+}
 
-		return conn;
+void ModelSnapshot::saveExtraData(pt::ptree &dst, bool withConnection) const
+{
+	if(rawExtraData)
+	{
+		// typed attributes and the connection are unchanged and already in
+		// it; a connection that could not be decoded stays as it was read
+		dst.clear();
+		rawExtraData->materialize(dst);
+		if(connection && !withConnection)
+		{
+			dst.erase("connection");
+		}
+		return;
 	}
-	else
+
+	dst = *extraData;
+	attributes.save(dst);
+	if(connection && withConnection)
 	{
-		return {};
+		dst.put_child("connection", writeConnection(*connection));
+		if(extraDataOrder)
+		{
+			restoreKeyOrder(dst, *extraDataOrder);
+		}
 	}
 }
 
+DiagramItemModel::DiagramItemModel(DiagramContext *ctx, QObject *parent)
+: QObject(parent)
+, _ctx(ctx)
+, _uuid(QUuid::createUuid())
+, _kind(nullptr)
+, _rotation(0)
+, _sceneZ(0)
+, _extraData(std::make_shared<pt::ptree>())
+, _materialized(true)
+{
+
+}
+
 boost::optional<QString> DiagramItemModel::text() const
 {
 	if(auto resultString = getData<std::string>("text"))
@@ -85,24 +258,38 @@ boost::optional<QString> DiagramItemModel::text() const
 
 void DiagramItemModel::setConnection(const optional<Connection> &conn)
 {
-	if(conn)
+	auto stillConnected = [&](const QUuid &endpoint) {
+		return conn && (conn->src == endpoint || conn->dst == endpoint);
+	};
+
+	const bool connectionChanged = !sameConnection(conn, _connection);
+	if(connectionChanged)
 	{
-		pt::ptree connTree;
-		connTree.put("src", conn->src);
-		connTree.put("srcPort", conn->srcPort);
-		connTree.put("dst", conn->dst);
-		connTree.put("dstPort", conn->dstPort);
-		connTree.put("center", conn->center);
-		setTree("connection", connTree);
+		discardRaw();
+	}
+
+	if(_connection)
+	{
+		if(!stillConnected(_connection->src))
+			this->removeDependency(_connection->src);
+		if(!stillConnected(_connection->dst))
+			this->removeDependency(_connection->dst);
+	}
 
+	_connection = conn;
+
+	if(conn)
+	{
 		this->addDependency(conn->src);
 		this->addDependency(conn->dst);
 	}
-	else
+
+	if(connectionChanged)
 	{
-		this->_extraData.erase("connection");
+		emit changed();
 	}
 }
+
 void DiagramItemModel::setText(const optional<QString> &text)
 {
 	if(text)
@@ -116,31 +303,134 @@ DiagramItemModel::~DiagramItemModel()
 
 }
 
-void DiagramItemModel::save(pt::ptree &dst) const
+ModelSnapshot DiagramItemModel::capture() const
 {
 	assert(_kind);
+	return ModelSnapshot {
+		_uuid,
+		_kind->name(),
+		_scenePos,
+		_rotation,
+		_sceneZ,
+		_dependencies,
+		_extraData,
+		_attributes,
+		_connection,
+		_raw,
+		_extraDataOrder
+	};
+}
+
+ModelSnapshot DiagramItemModel::snapshot()
+{
+	requestUpdateModel();
+	return capture();
+}
+
+void DiagramItemModel::save(pt::ptree &dst) const
+{
+	const_cast<DiagramItemModel *>(this)->requestUpdateModel();
+	capture().save(dst);
+}
+
+void DiagramItemModel::save(InfoWriter &dst) const
+{
 	const_cast<DiagramItemModel *>(this)->requestUpdateModel();
+	capture().save(dst);
+}
 
+void ModelSnapshot::save(pt::ptree &dst) const
+{
 	pt::ptree result;
-	result.add("kind", kind()->name().toStdString());
-	result.add("scenePosX", scenePos().x());
-	result.add("scenePosY", scenePos().y());
-	result.add("rotation", rotation());
-	result.add("sceneZ", sceneZ());
+	result.add("kind", kind.toStdString());
+	result.add("scenePosX", scenePos.x());
+	result.add("scenePosY", scenePos.y());
+	result.add("rotation", rotation);
+	result.add("sceneZ", sceneZ);
 
 	pt::ptree deptree;
 	int i = 0;
-	for(const auto &dep : dependencies())
+	for(const auto &dep : dependencies)
 	{
 		deptree.add(boost::lexical_cast<std::string>(i), dep);
 		++i;
 	}
 
 	result.add_child("dependencies", deptree);
-	result.add_child("extraData", _extraData);
+
+	pt::ptree extra;
+	saveExtraData(extra, true);
+	result.add_child("extraData", extra);
 
 	UUIDTranslator ut;
-	dst.add_child(ut.put_value(uuid()).get(), result);
+	dst.add_child(ut.put_value(uuid).get(), result);
+}
+
+void ModelSnapshot::save(InfoWriter &dst) const
+{
+	dst.openUuid(uuid);
+	dst.put("kind", kind.toStdString());
+	dst.put("scenePosX", scenePos.x());
+	dst.put("scenePosY", scenePos.y());
+	dst.put("rotation", rotation);
+	dst.put("sceneZ", sceneZ);
+
+	if(dependencies.isEmpty())
+	{
+		dst.put("dependencies", std::string());
+	}
+	else
+	{
+		dst.open("dependencies");
+		int i = 0;
+		for(const auto &dep : dependencies)
+		{
+			dst.put(std::to_string(i), dep);
+			++i;
+		}
+		dst.close();
+	}
+
+	if(auto raw = dynamic_cast<const InfoRawTree *>(rawExtraData.get()))
+	{
+		dst.putRaw("extraData", raw->begin(), raw->end());
+		dst.close();
+		return;
+	}
+
+	// Attributes and the connection are put into an empty tree and written
+	// after extraData. That is what put() into a copy of extraData yields,
+	// unless one of their top-level keys is already present there, or they
+	// were read from a document and go back where they were.
+	pt::ptree tail;
+	attributes.save(tail);
+	if(connection)
+	{
+		tail.put_child("connection", writeConnection(*connection));
+	}
+
+	bool appendable = !attributes.keepsOrder() && !extraDataOrder;
+	for(const auto &child : tail)
+	{
+		if(extraData->find(child.first) != extraData->not_found())
+		{
+			appendable = false;
+			break;
+		}
+	}
+
+	if(appendable && !rawExtraData)
+	{
+		dst.put("extraData", *extraData, &tail);
+	}
+	else
+	{
+		pt::ptree extra;
+		saveExtraData(extra, true);
+		dst.put("extraData", extra);
+	}
+
+	dst.close();
 }
 
 static void mapUUIDs(UUIDMapper *mapper, pt::ptree &tree)
@@ -159,6 +449,7 @@ static void mapUUIDs(UUIDMapper *mapper, pt::ptree &tree)
 DiagramItemModel *DiagramItemModel::clone(UUIDMapper *mapper, QObject *parent) const
 {
 	const_cast<DiagramItemModel *>(this)->requestUpdateModel();
+	materialize();
 	DiagramItemModel *result = new DiagramItemModel(_ctx, parent);
 	result->_uuid = mapper->map(_uuid);
 	result->_kind = _kind;
@@ -169,9 +460,18 @@ DiagramItemModel *DiagramItemModel::clone(UUIDMapper *mapper, QObject *parent) c
 		result->_dependencies.insert(mapper->map(dep));
 	}
 	result->_rotation = _rotation;
-	result->_extraData = _extraData;
+	result->_extraData = std::make_shared<pt::ptree>(*_extraData);
+	result->_attributes = _attributes;
+	result->_connection = _connection;
+	result->_extraDataOrder = _extraDataOrder;
 
-	mapUUIDs(mapper, result->_extraData);
+	mapUUIDs(mapper, *result->_extraData);
+	result->_attributes.mapUUIDs(mapper);
+	if(result->_connection)
+	{
+		result->_connection->src = mapper->map(result->_connection->src);
+		result->_connection->dst = mapper->map(result->_connection->dst);
+	}
 
 	return result;
 }
@@ -5,8 +5,12 @@
 #include <QSet>
 #include "DiagramContext.hpp"
 #include <QPoint>
+#include <QString>
+#include <memory>
 #include "CoreForward.hpp"
 #include "Util/ReentrancyGuard.hpp"
+#include "AttributeStore.hpp"
+#include "DiagramIO/RawTree.hpp"
 /**
  * @file   DiagramItemModel.hpp
  *
@@ -16,6 +20,8 @@
 
 
 namespace dbuilder {
+class InfoWriter;
+
 struct Connection
 {
 	QUuid src;
@@ -27,6 +33,39 @@ struct Connection
 namespace pt = boost::property_tree;
 using boost::optional;
 
+/**
+ * The saved state of a DiagramItemModel, detached from the model. The
+ * extraData tree is shared until the model next changes it, so taking a
+ * snapshot copies no trees. Snapshots may be read from any thread.
+ *
+ * While the model is unchanged since it was read, rawExtraData holds its
+ * whole extraData as read, typed attributes included, and is written
+ * instead of extraData and attributes.
+ */
+struct ModelSnapshot
+{
+	QUuid uuid;
+	QString kind;
+	QPointF scenePos;
+	double rotation;
+	qreal sceneZ;
+	QSet<QUuid> dependencies;
+	std::shared_ptr<const pt::ptree> extraData;
+	AttributeStore attributes;
+	optional<Connection> connection;
+	RawTreePtr rawExtraData;
+	// the top-level keys of extraData as read, if it held a connection
+	std::shared_ptr<const KeyOrder> extraDataOrder;
+
+	/**
+	 * Writes extraData and typed attributes into dst, and the connection,
+	 * where it was read, if withConnection is set.
+	 */
+	void saveExtraData(pt::ptree &dst, bool withConnection=false) const;
+	void save(pt::ptree &dst) const;
+	void save(InfoWriter &dst) const;
+};
+
 class DiagramItemModel: public QObject
 {
 	Q_OBJECT
@@ -37,19 +76,80 @@ class DiagramItemModel: public QObject
 	qreal _sceneZ;
 	QSet<QUuid> _dependencies;
 	double _rotation;
-	pt::ptree _extraData;
+	// shared with snapshots; copied before it is changed while one holds it
+	mutable std::shared_ptr<pt::ptree> _extraData;
+	AttributeStore _attributes;
+	optional<Connection> _connection;
+	// the top-level keys of extraData as read, if it held a connection
+	std::shared_ptr<const KeyOrder> _extraDataOrder;
 	ReentrancyGuard _updateViewGuard, _updateModelGuard;
+
+	// extraData as read, until the model changes. Until it is materialized,
+	// _extraData holds only what is left of its eager children.
+	RawTreePtr _raw;
+	mutable bool _materialized;
+
+	void materialize() const;
+	void discardRaw();
+	optional<std::string> findData(const std::string &path) const;
+
+	pt::ptree &extraData()
+	{
+		discardRaw();
+		if(_extraData.use_count() > 1)
+		{
+			_extraData = std::make_shared<pt::ptree>(*_extraData);
+		}
+		return *_extraData;
+	}
+
+	ModelSnapshot capture() const;
 public:
 	DiagramItemModel(DiagramContext *ctx, const pt::ptree::value_type &data, QObject *parent=nullptr);
 	DiagramItemModel(DiagramContext *ctx, QObject *parent=nullptr);
 	virtual ~DiagramItemModel();
 
 	void save(pt::ptree &dst) const;
+	/**
+	 * Writes the same text that write_info() produces for save(), without
+	 * copying extraData.
+	 */
+	void save(InfoWriter &dst) const;
+
+	/**
+	 * Replaces the extraData tree, moving typed attributes and the
+	 * connection out of it as the tree constructor does.
+	 *
+	 * If raw is given, extraData holds only its eager children (see
+	 * isEagerExtraDataKey()). The rest is parsed from raw when first used,
+	 * and raw is saved as it is until the model changes.
+	 */
+	void loadExtraData(pt::ptree extraData, RawTreePtr raw=RawTreePtr());
+	/**
+	 * Writes extraData and typed attributes, but not the connection, into dst.
+	 */
+	void saveExtraData(pt::ptree &dst) const;
+
+	/**
+	 * Has the view commit its changes to the model, then captures it for
+	 * writing elsewhere, possibly on another thread.
+	 */
+	ModelSnapshot snapshot();
+
 	DiagramItemModel *clone(UUIDMapper *mapper, QObject *parent=nullptr) const;
 
-	boost::optional<Connection> connection() const;
+	const optional<Connection> &connection() const
+	{
+		return _connection;
+	}
+
 	boost::optional<QString> text() const;
 
+	/**
+	 * Sets the endpoints of a connector. The source and destination are kept
+	 * in the dependency set: endpoints that are replaced or cleared are
+	 * removed, and new ones are added.
+	 */
 	void setConnection(const optional<Connection> &);
 	void setText(const optional<QString> &text);
 
@@ -80,12 +180,19 @@ public:
 
 	void addDependency(const QUuid &dep)
 	{
-		_dependencies.insert(dep);
+		if(!_dependencies.contains(dep))
+		{
+			_dependencies.insert(dep);
+			emit changed();
+		}
 	}
 
 	void removeDependency(const QUuid &dep)
 	{
-		_dependencies.remove(dep);
+		if(_dependencies.remove(dep))
+		{
+			emit changed();
+		}
 	}
 
 	const QSet<QUuid> &dependencies() const
@@ -93,33 +200,108 @@ public:
 		return _dependencies;
 	}
 
+	/**
+	 * @return the value of a typed attribute, or its default if unset
+	 */
+	template <typename T>
+	const T &attribute(const Attribute<T> &attr) const
+	{
+		return _attributes.value(attr);
+	}
+
 	template <typename T>
-	void setData(const pt::ptree::path_type &path, T &&value)
+	bool hasAttribute(const Attribute<T> &attr) const
+	{
+		return _attributes.contains(attr.slot());
+	}
+
+	template <typename T>
+	void setAttribute(const Attribute<T> &attr, const typename Attribute<T>::value_type &value)
 	{
-		_extraData.put(path, std::forward<T>(value));
+		if(_attributes.set(attr.slot(), value))
+		{
+			discardRaw();
+			emit changed();
+		}
 	}
 
+	const AttributeStore &attributes() const
+	{
+		return _attributes;
+	}
 
-	void removeData(const std::string &key)
+	/**
+	 * Path-based access. Interned attribute paths are routed to the
+	 * attribute store; everything else lives in the extraData tree.
+	 */
+	template <typename T>
+	void setData(const pt::ptree::path_type &path, T &&value)
 	{
-		_extraData.erase(key);
+		const std::string dotted = path.dump();
+		int slot = findAttribute(dotted);
+		if(slot >= 0)
+		{
+			if(_attributes.convertAndSet(slot, std::forward<T>(value)))
+			{
+				discardRaw();
+				emit changed();
+			}
+			return;
+		}
+
+		// views write back every field; only a real change drops the raw tree
+		pt::ptree node;
+		node.put_value(std::forward<T>(value));
+		auto current = findData(dotted);
+		if(!current || *current != node.data())
+		{
+			extraData().put(path, node.data());
+			emit changed();
+		}
 	}
 
+	void removeData(const std::string &key);
+
 	template <typename T>
 	optional<T> getData(const pt::ptree::path_type &path) const
 	{
-		return _extraData.get_optional<T>(path);
+		const std::string dotted = path.dump();
+		int slot = findAttribute(dotted);
+		if(slot >= 0 && _attributes.contains(slot))
+		{
+			return _attributes.get<T>(slot);
+		}
+		if(_materialized)
+		{
+			return _extraData->get_optional<T>(path);
+		}
+		if(auto data = findData(dotted))
+		{
+			pt::ptree node(*data);
+			return node.get_value_optional<T>();
+		}
+		return {};
 	}
 
 	template <typename Tree>
 	void setTree(const pt::ptree::path_type &path, Tree &&tree)
 	{
-		_extraData.put_child(path, std::forward<Tree>(tree));
+		auto current = getTree(path);
+		if(!current || *current != tree)
+		{
+			extraData().put_child(path, std::forward<Tree>(tree));
+			emit changed();
+		}
 	}
 
+	/**
+	 * @note subtrees returned here do not include typed attributes
+	 */
 	optional<const pt::ptree &> getTree(const pt::ptree::path_type &path) const
 	{
-		return _extraData.get_child_optional(path);
+		materialize();
+		const pt::ptree &extraData = *_extraData;
+		return extraData.get_child_optional(path);
 	}
 
 
@@ -152,6 +334,11 @@ signals:
 	 * signal: request that the view commit its changes to the model
 	 */
 	void updateModelRequested();
+	/**
+	 * signal: the extraData, typed attributes, connection or dependencies
+	 * changed; not emitted for the position, rotation or Z order
+	 */
+	void changed();
 public slots:
 	void requestUpdateView();
 	void requestUpdateModel();
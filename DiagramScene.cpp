@@ -22,6 +22,7 @@
 #include "Commands/RotateItemCommand.hpp"
 #include "Commands/MoveItemCommand.hpp"
 #include <memory>
+#include <algorithm>
 #include "Util.hpp"
 #include "DiagramContext.hpp"
 #include "Util/Log.hpp"
@@ -36,8 +37,28 @@
 #include "TabFocus/TabFocusRing.hpp"
 
 namespace dbuilder {
+namespace {
 
+/**
+ * @return the cache mode for item, which is a diagram item or a child of
+ * one, outside print mode
+ */
+QGraphicsItem::CacheMode itemCacheMode(QGraphicsItem *item)
+{
+	auto diagramItem = dynamic_cast<DiagramItem *>(item);
+	if(!diagramItem)
+	{
+		diagramItem = dynamic_cast<DiagramItem *>(item->parentItem());
+	}
 
+	if(diagramItem && diagramItem->model() && diagramItem->model()->kind()->sharesRasters())
+	{
+		return QGraphicsItem::NoCache;
+	}
+	return QGraphicsItem::DeviceCoordinateCache;
+}
+
+}  // anonymous namespace
 
 DiagramScene::DiagramScene(DiagramContext *context, QObject* parent)
 : QGraphicsScene(parent)
@@ -46,6 +67,7 @@ DiagramScene::DiagramScene(DiagramContext *context, QObject* parent)
 , startPort(0)
 , _highlightedItem(nullptr)
 , _clean(true)
+, _revision(0)
 , _printMode(false)
 , _connectorType("connector")
 , _highlightedHandle(nullptr)
@@ -53,8 +75,11 @@ DiagramScene::DiagramScene(DiagramContext *context, QObject* parent)
 , _focusRing(new SequentialTabFocusRing(this))
 , _zoomRectangle(nullptr)
 , _dragLock(false)
+, _dependencyFlushQueued(false)
+, _dependencyUpdatesRequested(0)
+, _dependencyUpdatesPerformed(0)
 {
-
+	connect(&_undoStack, SIGNAL(indexChanged(int)), this, SLOT(undoIndexChanged()));
 }
 
 void DiagramScene::setHighlightedItem(DiagramItem *item, int port)
@@ -73,10 +98,20 @@ void DiagramScene::setHighlightedItem(DiagramItem *item, int port)
 
 void DiagramScene::setClean(bool clean)
 {
+	if(!clean)
+	{
+		++_revision;
+	}
 	_clean = clean;
 	emit modifiedChanged(!_clean);
 }
-const QMap<QString, DiagramComponent *> &DiagramScene::kinds() const
+
+void DiagramScene::undoIndexChanged()
+{
+	// property edits only go through the undo stack
+	++_revision;
+}
+QMap<QString, DiagramComponent *> DiagramScene::kinds() const
 {
 	return ctx->kinds();
 }
@@ -85,40 +120,127 @@ void DiagramScene::drawBackground(QPainter * painter, const QRectF &rect)
 {
 	if(!printMode())
 	{
-		qreal gridInterval = 5;
-		painter->setPen(QColor(230, 230, 255));
-		for(qreal x = round(rect.left() / gridInterval) * gridInterval; x < rect.right(); x += gridInterval)
+		_grid.draw(painter, rect);
+	}
+}
+
+void DiagramScene::addDependent(const QUuid &dependency, ItemHandle dependent)
+{
+	ItemHandle h = _handlesByUuid.find(dependency);
+	if(h == InvalidItemHandle)
+	{
+		_pendingDependents.insert(dependency, dependent);
+	}
+	else
+	{
+		_dependencies.addEdge(h, dependent);
+	}
+}
+
+/**
+ * Assigns a handle to item, indexes its UUID and records its dependency
+ * edges, without making it visible to lookups or adding it to the scene.
+ */
+ItemHandle DiagramScene::registerDiagramItem(DiagramItem *item)
+{
+	const QUuid &uuid = item->model()->uuid();
+
+	ItemHandle h = item->_handle;
+	if(h >= _itemSlots.size() || _itemSlots[h].item != item)
+	{
+		h = item->_handle = _itemSlots.size();
+		_itemSlots.push_back(ItemSlot{item, false, false, InvalidItemHandle});
+	}
+	_handlesByUuid.insert(uuid, h);
+	_dependencies.addNode(h);
+
+	for(auto dependency : item->model()->dependencies())
+		addDependent(dependency, h);
+
+	auto pendingIt = _pendingDependents.find(uuid);
+	while(pendingIt != _pendingDependents.end() && pendingIt.key() == uuid)
+	{
+		// only if the dependent is still here and still depends on item
+		const ItemHandle dependent = *pendingIt;
+		const auto dependentModel = _itemSlots[dependent].item->model();
+		if(_handlesByUuid.find(dependentModel->uuid()) == dependent
+		   && dependentModel->dependencies().contains(uuid))
 		{
-			painter->drawLine(x, rect.top(), x, rect.bottom());
+			_dependencies.addEdge(h, dependent);
 		}
+		pendingIt = _pendingDependents.erase(pendingIt);
+	}
 
-		for(qreal y = round(rect.top() / gridInterval) * gridInterval; y < rect.bottom(); y += gridInterval)
+	return h;
+}
+
+void DiagramScene::addDependency(DiagramItem *item, const QUuid &dependency)
+{
+	setClean(false);
+	item->model()->addDependency(dependency);
+	if(item->_handle < _itemSlots.size() && _itemSlots[item->_handle].item == item)
+	{
+		addDependent(dependency, item->_handle);
+	}
+}
+
+void DiagramScene::removeDependency(DiagramItem *item, const QUuid &dependency)
+{
+	setClean(false);
+	item->model()->removeDependency(dependency);
+	if(item->_handle >= _itemSlots.size() || _itemSlots[item->_handle].item != item)
+	{
+		return;
+	}
+
+	ItemHandle h = _handlesByUuid.find(dependency);
+	if(h != InvalidItemHandle)
+	{
+		_dependencies.removeEdge(h, item->_handle);
+		return;
+	}
+
+	auto pendingIt = _pendingDependents.find(dependency);
+	while(pendingIt != _pendingDependents.end() && pendingIt.key() == dependency)
+	{
+		if(*pendingIt == item->_handle)
+		{
+			pendingIt = _pendingDependents.erase(pendingIt);
+		}
+		else
 		{
-			painter->drawLine(rect.left(), y, rect.right(), y);
+			++pendingIt;
 		}
 	}
 }
 
 void DiagramScene::addDiagramItem(DiagramItem* item)
+{
+	registerDiagramItem(item);
+	activateDiagramItem(item);
+}
+
+void DiagramScene::activateDiagramItem(DiagramItem *item)
 {
 	setClean(false);
 	DBLog(Debug, "added item with uuid ", item->model()->uuid().toString().toStdString());
-	_itemsByUuid.insert(item->model()->uuid(), item);
-	for(auto dependency : item->model()->dependencies())
-		_dependents.insert(dependency, item);
+	_itemSlots[item->_handle].live = true;
+
 	if(item->scene() != this)
 		this->addItem(item);
 	connect(item, SIGNAL(posChanged(QPointF)), this, SLOT(diagramItemMoved(QPointF)));
 	connect(item, SIGNAL(connectorDragStart(QPointF, int)), this, SLOT(connectorDragStart(QPointF, int)));
 	connect(item, SIGNAL(connectorDragMid(QPointF)), this, SLOT(connectorDragMid(QPointF)));
 	connect(item, SIGNAL(connectorDragEnd(QPointF)), this, SLOT(connectorDragEnd(QPointF)));
+	const auto cacheMode = itemCacheMode(item);
 	for(auto i : item->childItems())
 	{
-		i->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+		i->setCacheMode(cacheMode);
 	}
 
-	item->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+	item->setCacheMode(cacheMode);
 	item->model()->requestUpdateView();
+	emit diagramItemAdded(item);
 }
 
 void DiagramScene::contextMenuEvent(QGraphicsSceneContextMenuEvent *contextMenuEvent)
@@ -148,41 +270,106 @@ QList<DiagramItem *> DiagramScene::removeDiagramItem(DiagramItem *item)
 	if(item->scene() != this) return {};
 
 	QList<DiagramItem *> result;
-	result << item;
-	_itemsByUuid.remove(item->model()->uuid());
-	for(auto dependent : this->_dependents.values(item->model()->uuid()))
+
+	ItemHandle h = item->_handle;
+	if(h < _itemSlots.size() && _itemSlots[h].item == item && _itemSlots[h].live)
 	{
-		result.append(this->removeDiagramItem(dependent));
-	}
-	this->_dependents.remove(item->model()->uuid());
+		// the item and everything that transitively depends on it
+		_dependencies.reachable(h, _affectedHandles);
+		for(auto affected : _affectedHandles)
+		{
+			auto &slot = _itemSlots[affected];
+			if(!slot.live || slot.item->scene() != this) continue;
+
+			if(affected != h)
+			{
+				slot.item->model()->requestUpdateModel();
+			}
 
-	// disconnect all signals from item
-	item->disconnect(this);
+			_handlesByUuid.remove(slot.item->model()->uuid());
+			slot.live = false;
+			result << slot.item;
+		}
+
+		// edges are re-created from the models if the items are added back
+		for(auto affected : _affectedHandles)
+		{
+			_dependencies.isolate(affected);
+		}
+
+		// and so are the dependencies they were waiting for
+		for(auto pendingIt = _pendingDependents.begin(); pendingIt != _pendingDependents.end(); )
+		{
+			if(std::find(_affectedHandles.begin(), _affectedHandles.end(), *pendingIt) != _affectedHandles.end())
+			{
+				pendingIt = _pendingDependents.erase(pendingIt);
+			}
+			else
+			{
+				++pendingIt;
+			}
+		}
+	}
+	else
+	{
+		result << item;
+	}
 
-	this->removeItem(item);
+	for(auto removed : result)
+	{
+		// disconnect all signals from item
+		removed->disconnect(this);
+		this->removeItem(removed);
+		emit diagramItemRemoved(removed);
+	}
 
 	return result;
 }
 
 DiagramItem* DiagramScene::item(QUuid id)
 {
-	auto it = _itemsByUuid.find(id);
-	if(it != _itemsByUuid.end())
+	return itemByHandle(_handlesByUuid.find(id));
+}
+
+DiagramItem *DiagramScene::item(const QUuid &id, ItemHandle &hint)
+{
+	if(hint < _itemSlots.size())
 	{
-		return *it;
+		const auto &slot = _itemSlots[hint];
+		if(slot.live && slot.item->model()->uuid() == id)
+		{
+			return slot.item;
+		}
 	}
-	else
+
+	hint = _handlesByUuid.find(id);
+	return itemByHandle(hint);
+}
+
+QList<DiagramItem *> DiagramScene::diagramItems() const
+{
+	QList<DiagramItem *> result;
+	result.reserve(_handlesByUuid.size());
+	for(const auto &slot : _itemSlots)
 	{
-		return nullptr;
+		if(slot.live)
+		{
+			result << slot.item;
+		}
 	}
+	return result;
 }
 
 void DiagramScene::update()
 {
 	setClean(false);
-	for(auto item : _itemsByUuid)
+	// dependencies first, so that dependents see final positions
+	for(auto h : _dependencies.topologicalOrder())
 	{
-		item->emitPosChanged();
+		if(auto item = itemByHandle(h))
+		{
+			item->emitPosChanged();
+		}
 	}
 }
 
@@ -203,11 +390,75 @@ DiagramScene::~DiagramScene()
 void DiagramScene::diagramItemMoved(QPointF)
 {
 	this->setClean(false);
-	auto sdr = static_cast<DiagramItem *>(sender());
-	auto deps = _dependents.values(sdr->model()->uuid());
-	for(auto dependent : deps)
+	auto item = static_cast<DiagramItem *>(sender());
+	markDependentsDirty(item);
+	emit diagramItemMovedBy(item);
+}
+
+void DiagramScene::markDependentsDirty(DiagramItem *dependency)
+{
+	ItemHandle h = dependency->_handle;
+	if(h >= _itemSlots.size()) return;
+
+	for(auto dependent : _dependencies.dependents(h))
 	{
-		dependent->emitDependencyPosChanged(sdr);
+		++_dependencyUpdatesRequested;
+		auto &slot = _itemSlots[dependent];
+		if(!slot.dirty)
+		{
+			slot.dirty = true;
+			slot.dirtyDependency = h;
+			_dirtyHandles.push_back(dependent);
+		}
+		else if(slot.dirtyDependency != h)
+		{
+			// more than one dependency moved; the update names none of them
+			slot.dirtyDependency = InvalidItemHandle;
+		}
+	}
+
+	if(!_dirtyHandles.empty() && !_dependencyFlushQueued)
+	{
+		_dependencyFlushQueued = true;
+		QMetaObject::invokeMethod(this, "flushDependencyUpdates", Qt::QueuedConnection);
+	}
+}
+
+void DiagramScene::flushDependencyUpdates()
+{
+	_dependencyFlushQueued = false;
+
+	// a dependent that moves in response marks its own dependents, so
+	// repeat until settled; the bound guards against cycles that never do
+	for(int pass = 0; pass < 16 && !_dirtyHandles.empty(); ++pass)
+	{
+		_flushingHandles.swap(_dirtyHandles);
+		_dirtyHandles.clear();
+		_dependencies.sort(_flushingHandles, _flushOrder);
+
+		for(auto h : _flushOrder)
+		{
+			// the scene may have been cleared by a handler
+			if(h >= _itemSlots.size()) continue;
+
+			auto &slot = _itemSlots[h];
+			auto dependency = itemByHandle(slot.dirtyDependency);
+			slot.dirty = false;
+			slot.dirtyDependency = InvalidItemHandle;
+			if(slot.live)
+			{
+				++_dependencyUpdatesPerformed;
+				slot.item->emitDependencyPosChanged(dependency);
+				emit diagramItemFollowed(slot.item);
+			}
+		}
+	}
+
+	if(!_dirtyHandles.empty())
+	{
+		DBWarning("Dependency updates did not settle; ", _dirtyHandles.size(), " items deferred");
+		_dependencyFlushQueued = true;
+		QMetaObject::invokeMethod(this, "flushDependencyUpdates", Qt::QueuedConnection);
 	}
 }
 
@@ -337,8 +588,11 @@ void DiagramScene::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 void DiagramScene::clearDiagram()
 {
 	clear();
-	_itemsByUuid.clear();
-	_dependents.clear();
+	_itemSlots.clear();
+	_handlesByUuid.clear();
+	_dependencies.clear();
+	_pendingDependents.clear();
+	_dirtyHandles.clear();
 	_highlightedItem = nullptr;
 }
 
@@ -375,66 +629,36 @@ void DiagramScene::ungroup()
 	}
 }
 
-class DiagramItemLoader
+void DiagramScene::addDiagramItemsInOrder(const QList<DiagramItem*>& items)
 {
-	DiagramScene &scene;
-	const QList<DiagramItem *> &items;
-	QSet<DiagramItem *> itemsBeingLoaded;
-	QSet<DiagramItem *> itemsLoaded;
-	QMap<QUuid, DiagramItem *> itemsByUUID;
-public:
-	DiagramItemLoader(DiagramScene &scene, const QList<DiagramItem *> &items)
-	: scene(scene)
-	, items(items)
+	_affectedHandles.clear();
+	for(auto item : items)
 	{
-		for(auto item : items)
-		{
-			itemsByUUID[item->model()->uuid()] = item;
-		}
+		_affectedHandles.push_back(registerDiagramItem(item));
 	}
 
-	void load(DiagramItem *item)
+	for(auto item : items)
 	{
-		if(itemsBeingLoaded.contains(item))
-		{
-			DBWarning("Circular reference ignored for ", item->model()->uuid(), " of kind ", item->model()->kind()->name());
-			return;
-		}
-
-		if(itemsLoaded.contains(item))
-		{
-			return;
-		}
-
-		itemsBeingLoaded.insert(item);
-		for(auto uuid : item->model()->dependencies())
+		for(const auto &uuid : item->model()->dependencies())
 		{
-			if(!itemsByUUID.contains(uuid))
+			if(_handlesByUuid.find(uuid) == InvalidItemHandle)
 			{
 				DBWarning("Item ", item->model()->uuid(), " depends on unknown item ", uuid);
 			}
-			else
-			{
-				load(itemsByUUID[uuid]);
-			}
 		}
-		scene.addDiagramItem(item);
-		itemsLoaded.insert(item);
-		itemsBeingLoaded.remove(item);
 	}
 
-	void loadAll()
+	_dependencies.sort(_affectedHandles, _orderedHandles, &_cyclicHandles);
+	for(auto h : _cyclicHandles)
 	{
-		for(auto item : items)
-		{
-			load(item);
-		}
+		auto model = _itemSlots[h].item->model();
+		DBWarning("Circular reference ignored for ", model->uuid(), " of kind ", model->kind()->name());
 	}
-};
 
-void DiagramScene::addDiagramItemsInOrder(const QList<DiagramItem*>& items)
-{
-	DiagramItemLoader(*this, items).loadAll();
+	for(auto h : _orderedHandles)
+	{
+		activateDiagramItem(_itemSlots[h].item);
+	}
 }
 
 
@@ -612,7 +836,7 @@ void DiagramScene::send(const QList<DiagramItem *> &items,
 	}
 
 	auto otherItems = motion & ZMFully?
-		  diagramItems().values()
+		  diagramItems()
 		: filterCast<DiagramItem>(this->items(boundingRect));
 
 	for(auto item : items)
@@ -675,10 +899,7 @@ void DiagramScene::setPrintMode(bool printMode)
 	_printMode = printMode;
 	for (auto item : items())
 	{
-		item->setCacheMode(
-				printMode ?
-						QGraphicsItem::NoCache :
-						QGraphicsItem::DeviceCoordinateCache);
+		item->setCacheMode(printMode? QGraphicsItem::NoCache : itemCacheMode(item));
 
 		if(auto di = dynamic_cast<DiagramItem *>(item))
 		{
@@ -686,6 +907,7 @@ void DiagramScene::setPrintMode(bool printMode)
 		}
 	}
 	update();
+	flushDependencyUpdates();
 }
 
 
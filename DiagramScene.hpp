@@ -2,11 +2,15 @@
 #include <QGraphicsScene>
 #include <QUuid>
 #include <QMap>
+#include <vector>
 #include <qundostack.h>
 #include "DiagramItemModel.hpp"
 #include "Handle.hpp"
 #include "qgraphicsitem.h"
 #include "CoreForward.hpp"
+#include "Util/UUIDIndex.hpp"
+#include "DependencyGraph.hpp"
+#include "GridBackground.hpp"
 class QGraphicsLineItem;
 namespace dbuilder {
 
@@ -33,8 +37,30 @@ class DiagramScene: public QGraphicsScene
 {
 	Q_OBJECT
 	DiagramContext *ctx;
-	QMap<QUuid, DiagramItem *> _itemsByUuid;
-	QMultiMap<QUuid, DiagramItem *> _dependents;
+
+	struct ItemSlot
+	{
+		// kept after removal so that an item re-added by undo gets its old handle back
+		DiagramItem *item;
+		bool live;
+		// set while the item waits in _dirtyHandles
+		bool dirty;
+		// the dependency that moved, or InvalidItemHandle if several did
+		ItemHandle dirtyDependency;
+	};
+
+	std::vector<ItemSlot> _itemSlots;
+	UUIDIndex _handlesByUuid;
+	DependencyGraph _dependencies;
+	// dependency edges whose dependency has not been added yet
+	QMultiMap<QUuid, ItemHandle> _pendingDependents;
+	// scratch lists reused by removal and ordered insertion
+	DependencyGraph::NodeList _affectedHandles, _orderedHandles, _cyclicHandles;
+
+	// items whose dependencies moved since the last flush
+	DependencyGraph::NodeList _dirtyHandles, _flushingHandles, _flushOrder;
+	bool _dependencyFlushQueued;
+	quint64 _dependencyUpdatesRequested, _dependencyUpdatesPerformed;
 	QSet<QGraphicsItem *> _temporarilyDisabledItems;
 //	QMap<QString, DiagramComponent *> _kinds;
 
@@ -47,7 +73,9 @@ class DiagramScene: public QGraphicsScene
 	DiagramItem *_highlightedItem;
 
 	bool _clean;
+	quint64 _revision;
 	bool _printMode;
+	dbuilder::GridBackground _grid;
 
 	QPointF insertLoc;
 
@@ -64,6 +92,10 @@ class DiagramScene: public QGraphicsScene
 	bool _dragLock;
 
 	void setHighlightedItem(DiagramItem *item, int port);
+	void addDependent(const QUuid &dependency, ItemHandle dependent);
+	ItemHandle registerDiagramItem(DiagramItem *item);
+	void activateDiagramItem(DiagramItem *item);
+	void markDependentsDirty(DiagramItem *dependency);
 
 public:
 
@@ -88,6 +120,17 @@ public:
 
 	void addDiagramItemsInOrder(const QList<DiagramItem *> &items);
 
+	/**
+	 * Adds dependency to the model of item and to the dependency graph,
+	 * whether or not an item with that UUID is in the scene yet.
+	 */
+	void addDependency(DiagramItem *item, const QUuid &dependency);
+	/**
+	 * Removes dependency from the model of item and from the dependency
+	 * graph, so that removing the dependency no longer removes item.
+	 */
+	void removeDependency(DiagramItem *item, const QUuid &dependency);
+
 	/**
 	 * Register a DiagramComponent for use with the DiagramScene.
 	 * @param kind
@@ -99,9 +142,10 @@ public:
 	 */
 	DiagramComponent *kind(const QString &name);
 	/**
-	 * @return a map of all registered DiagramComponent instances by name
+	 * @return a map of all registered DiagramComponent instances by name,
+	 * creating those not created yet
 	 */
-	const QMap<QString, DiagramComponent *> &kinds() const;
+	QMap<QString, DiagramComponent *> kinds() const;
 
 	/**
 	 * @param id
@@ -109,9 +153,32 @@ public:
 	 */
 	DiagramItem *item(QUuid id);
 	/**
-	 * @return a map of all DiagramItem instances in this scene by UUID
+	 * Looks up an item, trying a previously resolved handle first.
+	 *
+	 * @param hint    a handle cached by the caller; updated if stale
+	 * @return the DiagramItem with the given UUID or nullptr if no such item exists
+	 */
+	DiagramItem *item(const QUuid &id, ItemHandle &hint);
+	/**
+	 * @return the DiagramItem with the given handle or nullptr if it is not in the scene
+	 */
+	DiagramItem *itemByHandle(ItemHandle handle) const
+	{
+		return handle < _itemSlots.size() && _itemSlots[handle].live?
+			  _itemSlots[handle].item
+			: nullptr;
+	}
+	/**
+	 * @return the handle of the item with the given UUID, or InvalidItemHandle
+	 */
+	ItemHandle handle(const QUuid &id) const
+	{
+		return _handlesByUuid.find(id);
+	}
+	/**
+	 * @return all DiagramItem instances in this scene in the order they were added
 	 */
-	const QMap<QUuid, DiagramItem *> &diagramItems() const { return _itemsByUuid; }
+	QList<DiagramItem *> diagramItems() const;
 
 	/**
 	 * Creates the given connection in the scene
@@ -150,6 +217,15 @@ public:
 
 	void setClean(bool clean=true);
 
+	/**
+	 * @return a number that changes whenever the scene is modified or the
+	 * undo stack moves, telling whether a snapshot of it is still current
+	 */
+	quint64 revision() const
+	{
+		return _revision;
+	}
+
 	bool printMode() const
 	{
 		return _printMode;
@@ -157,6 +233,23 @@ public:
 
 	void setPrintMode(bool printMode);
 
+	/**
+	 * @return number of dependency updates requested by moves, including
+	 * those coalesced with another request for the same item
+	 */
+	quint64 dependencyUpdatesRequested() const
+	{
+		return _dependencyUpdatesRequested;
+	}
+
+	/**
+	 * @return number of dependencyPosChanged() notifications actually emitted
+	 */
+	quint64 dependencyUpdatesPerformed() const
+	{
+		return _dependencyUpdatesPerformed;
+	}
+
 	const QString& connectorType() const
 	{
 		return _connectorType;
@@ -200,6 +293,13 @@ private:
 	qreal targetZForSending(const QList<DiagramItem *> &items, ZMotion motion);
 
 public slots:
+	/**
+	 * Notifies every item whose dependencies moved since the last flush,
+	 * once per item. Runs automatically from the event loop after a move;
+	 * call it directly when positions must be current right away.
+	 */
+	void flushDependencyUpdates();
+
 	void group();
 	void ungroup();
 	void setDragLock(bool d) { _dragLock = d; }
@@ -218,6 +318,15 @@ signals:
 	 */
 	void modifiedChanged(bool modified);
 	void contextMenu(QGraphicsSceneContextMenuEvent *);
+
+	/// emitted when an item enters the scene, including when undo restores it
+	void diagramItemAdded(DiagramItem *item);
+	/// emitted for each item removeDiagramItem() takes out of the scene
+	void diagramItemRemoved(DiagramItem *item);
+	/// emitted when an item is moved or rotated
+	void diagramItemMovedBy(DiagramItem *item);
+	/// emitted when an item is updated because one of its dependencies moved
+	void diagramItemFollowed(DiagramItem *item);
 protected:
 	void mousePressEvent(QGraphicsSceneMouseEvent *mouseEvent);
 	void mouseReleaseEvent(QGraphicsSceneMouseEvent *mouseEvent);
@@ -229,6 +338,7 @@ private slots:
 	void contextMenuTriggered(QAction *);
 	void diagramItemMoved(QPointF);
 	void userFinishedMovingItem(QPointF, QPointF);
+	void undoIndexChanged();
 
 	void connectorDragStart(QPointF, int port);
 	void connectorDragMid(QPointF);
@@ -0,0 +1,109 @@
+/**
+ * @file   GridBackground.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "GridBackground.hpp"
+#include <QPainter>
+#include <QImage>
+#include <QPixmap>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+
+namespace dbuilder {
+
+const int GridBackground::MinLineSpacing;
+const int GridBackground::Subdivisions;
+const int GridBackground::MaxTilePixels;
+
+GridBackground::GridBackground(qreal interval)
+: _interval(interval)
+, _minorColor(230, 230, 255)
+, _majorColor(205, 205, 245)
+, _tileBucket(0)
+{
+}
+
+void GridBackground::draw(QPainter *painter, const QRectF &rect)
+{
+	const qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+	if(scale <= 0)
+	{
+		return;
+	}
+
+	// round down to half an octave, so lines are never closer than planned
+	const qreal bucket = std::pow(2.0, std::floor(std::log2(scale) * 2) / 2);
+
+	qreal minor = _interval;
+	while(minor * bucket < MinLineSpacing)
+	{
+		minor *= Subdivisions;
+	}
+	const qreal major = minor * Subdivisions;
+
+	if(major * bucket > MaxTilePixels)
+	{
+		drawLines(painter, rect, minor);
+		return;
+	}
+
+	if(bucket != _tileBucket)
+	{
+		renderTile(bucket, minor);
+	}
+	painter->fillRect(rect, _tile);
+}
+
+void GridBackground::drawLines(QPainter *painter, const QRectF &rect, qreal minor) const
+{
+	painter->save();
+	QPen minorPen(_minorColor, 0), majorPen(_majorColor, 0);
+
+	const qint64 firstX = std::ceil(rect.left() / minor), lastX = std::floor(rect.right() / minor);
+	for(qint64 i = firstX; i <= lastX; ++i)
+	{
+		painter->setPen(i % Subdivisions == 0? majorPen : minorPen);
+		painter->drawLine(QPointF(i * minor, rect.top()), QPointF(i * minor, rect.bottom()));
+	}
+
+	const qint64 firstY = std::ceil(rect.top() / minor), lastY = std::floor(rect.bottom() / minor);
+	for(qint64 i = firstY; i <= lastY; ++i)
+	{
+		painter->setPen(i % Subdivisions == 0? majorPen : minorPen);
+		painter->drawLine(QPointF(rect.left(), i * minor), QPointF(rect.right(), i * minor));
+	}
+	painter->restore();
+}
+
+/**
+ * Renders one major cell, with its major lines along the top and left
+ * edges, at the resolution of bucket.
+ */
+void GridBackground::renderTile(qreal bucket, qreal minor)
+{
+	const qreal major = minor * Subdivisions;
+	const int size = qMax(Subdivisions, qRound(major * bucket));
+
+	QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+	{
+		QPainter p(&image);
+		for(int i = 1; i < Subdivisions; ++i)
+		{
+			const int offset = qRound(qreal(i) * size / Subdivisions);
+			p.fillRect(offset, 0, 1, size, _minorColor);
+			p.fillRect(0, offset, size, 1, _minorColor);
+		}
+		p.fillRect(0, 0, 1, size, _majorColor);
+		p.fillRect(0, 0, size, 1, _majorColor);
+	}
+
+	_tile = QBrush(QPixmap::fromImage(image));
+	_tile.setTransform(QTransform::fromScale(major / size, major / size));
+	_tileBucket = bucket;
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,60 @@
+#pragma once
+#include <QBrush>
+#include <QColor>
+#include <QRectF>
+class QPainter;
+/**
+ * @file   GridBackground.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+namespace dbuilder {
+
+/**
+ * The grid drawn behind a diagram.
+ *
+ * Lines closer together than MinLineSpacing device pixels are skipped by
+ * widening the grid in steps of Subdivisions, and every Subdivisions-th line
+ * is a major line. One cell of major lines is rendered into a tile, and the
+ * exposed area is filled with it. The tile is rendered again only when the
+ * scale moves to another bucket (buckets are half an octave wide), so zooming
+ * in steps reuses it.
+ */
+class GridBackground
+{
+	qreal _interval;
+	QColor _minorColor, _majorColor;
+
+	QBrush _tile;
+	qreal _tileBucket;
+
+	void drawLines(QPainter *painter, const QRectF &rect, qreal minor) const;
+	void renderTile(qreal bucket, qreal minor);
+
+public:
+	/// the fewest device pixels between two lines that are drawn
+	static const int MinLineSpacing = 4;
+	/// the number of minor cells along a major cell
+	static const int Subdivisions = 5;
+	/// the largest tile side, in pixels; beyond it lines are drawn directly
+	static const int MaxTilePixels = 512;
+
+	/**
+	 * @param interval  the distance between the finest lines, in scene units
+	 */
+	GridBackground(qreal interval = 5);
+
+	qreal interval() const
+	{
+		return _interval;
+	}
+
+	/**
+	 * Fills rect, in the painter's coordinates, with the grid.
+	 */
+	void draw(QPainter *painter, const QRectF &rect);
+};
+
+}  // namespace dbuilder
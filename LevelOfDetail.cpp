@@ -0,0 +1,19 @@
+/**
+ * @file   LevelOfDetail.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "LevelOfDetail.hpp"
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+namespace dbuilder {
+
+qreal LevelOfDetail::scale(const QPainter *painter)
+{
+	return QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,66 @@
+#pragma once
+#include <QtGlobal>
+class QPainter;
+/**
+ * @file   LevelOfDetail.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+namespace dbuilder {
+
+/**
+ * How much of an item is worth drawing at its size on the device.
+ */
+enum class DetailLevel
+{
+	/// nothing
+	Hidden,
+	/// a filled rectangle over its bounds
+	Block,
+	/// a cached picture of the symbol, without ports
+	Glyph,
+	/// everything
+	Full
+};
+
+/**
+ * Thresholds for drawing diagram items in less detail when they are small
+ * on the device, as in an overview of a large diagram. All sizes are in
+ * device pixels.
+ */
+struct LevelOfDetail
+{
+	/// the longer side of an item below which it is drawn as a glyph
+	qreal glyphBelow;
+	/// the longer side of an item below which it is drawn as a block
+	qreal blockBelow;
+	/// the longer side of an item below which it is not drawn
+	qreal hiddenBelow;
+	/// the line height below which text is drawn as bars
+	qreal greekTextBelow;
+
+	LevelOfDetail()
+	: glyphBelow(24)
+	, blockBelow(8)
+	, hiddenBelow(2)
+	, greekTextBelow(5)
+	{ }
+
+	/**
+	 * @param extent  the longer side of an item, in device pixels
+	 */
+	DetailLevel levelFor(qreal extent) const
+	{
+		return extent < hiddenBelow? DetailLevel::Hidden
+			: extent < blockBelow? DetailLevel::Block
+			: extent < glyphBelow? DetailLevel::Glyph
+			: DetailLevel::Full;
+	}
+
+	/// @return device pixels per unit of the painter's coordinates
+	static qreal scale(const QPainter *painter);
+};
+
+}  // namespace dbuilder
@@ -21,6 +21,11 @@
 #include <sstream>
 #include "Components/ImageComponent.hpp"
 #include "DiagramIO/ComponentFile.hpp"
+#include "DiagramIO/ComponentIndex.hpp"
+#include "Util/IconCache.hpp"
+#include "Components/SymbolCache.hpp"
+#include "Main/KindPreloader.hpp"
+#include "Components/BuiltinComponents.hpp"
 #include "Util/QtUtil.hpp"
 #include "Util/Backtrace.hpp"
 
@@ -33,9 +38,15 @@ static std::function<int(int, char**)> *replacedMain = nullptr;
 Application *Application::_instance = nullptr;
 
 Application::Application()
+: _componentIndex(new ComponentIndex(QDesktopServices::storageLocation(QDesktopServices::CacheLocation)
+                                     + "/component-index.info"))
+, _iconCache(new IconCache(QDesktopServices::storageLocation(QDesktopServices::CacheLocation) + "/icons"))
+, _symbolCache(new SymbolCache)
+, _flattenItems(false)
 {
 	_instance = this;
 	readSettings();
+	_componentIndex->load();
 
 
 	QStringList candidatePlugins;
@@ -85,61 +96,82 @@ Application::Application()
 
 }
 
-DiagramContext *Application::createContext()
+std::shared_ptr<ComponentRegistry> Application::buildRegistry(bool preloadKinds)
 {
-	auto result = new DiagramContext;
+	QElapsedTimer timer;
+	timer.start();
+	std::shared_ptr<ComponentRegistry> result(new ComponentRegistry);
 
 	for(auto plugin : plugins())
 	if(auto componentPlugin = qobject_cast<DiagramComponentPlugin *>(plugin))
 	{
 		DBInfo("Loading components from plugin: ", componentPlugin->pluginInfo());
-		for(auto component : componentPlugin->createComponents(result))
+		for(auto component : componentPlugin->createComponents(result.get()))
 		{
 			DBDebug("--> ", component->name());
 			result->registerKind(component);
 		}
 	}
 
-	result->registerKind(new ConnectorComponent(result));
-	result->registerKind(new dbuilder::PathConnectorComponent(result));
-	result->registerKind(new dbuilder::BoxComponent(result));
-	result->registerKind(new PathComponent(result));
+	result->registerKind(new ConnectorComponent(result.get()));
+	result->registerKind(new dbuilder::PathConnectorComponent(result.get()));
+	result->registerKind(new dbuilder::BoxComponent(result.get()));
+	result->registerKind(new PathComponent(result.get()));
 
-	auto registerAll = [&](ComponentFile &cf) {
-		for(const auto &componentSpec : cf.components())
-		{
-			result->registerKind(componentSpec.createKind(result));
-		}
-	};
-
-	std::stringstream builtinComponentsStream(readFile("://components.info").toStdString());
-	ComponentFile builtinComponents(builtinComponentsStream);
-	registerAll(builtinComponents);
+	// the SVG kinds are made when first used, or by the preloader
+	std::vector<KindPreloader::SpecSource> sources;
 
+	// components.info is compiled into BuiltinComponents at build time
+	for(int i = 0; i < BuiltinComponentCount; ++i)
+	{
+		const BuiltinComponent *builtin = &BuiltinComponents[i];
+		sources.push_back([builtin]() { return builtinComponentSpec(*builtin); });
+		result->registerKindFactory(QString::fromUtf8(builtin->name), [builtin]() {
+			return builtinComponentSpec(*builtin).createKind(nullptr);
+		});
+	}
 
+	// library files are indexed, and each component is only read when it is
+	// first used
+	QStringList componentFiles;
 	for(auto library : libraries())
 	{
 		QDir libraryDir(library);
 		auto entries = libraryDir.entryInfoList({"*.dbcomponent"}, QDir::Files | QDir::NoDotAndDotDot);
 		for(const auto &entry : entries)
 		{
-			std::ifstream is(entry.filePath().toStdString());
-			if(is)
-			{
-				ComponentFile cf(is);
-				registerAll(cf);
-			}
-			else
-			{
-				DBError("Cannot open '", entry.filePath(), "' for reading.");
-			}
+			componentFiles << entry.filePath();
 		}
+	}
 
+	for(const auto &entry : _componentIndex->update(componentFiles))
+	{
+		sources.push_back([entry]() { return ComponentIndex::loadComponent(entry); });
+		result->registerKindFactory(entry.name, [entry]() {
+			return ComponentIndex::loadComponent(entry).createKind(nullptr);
+		});
+	}
+	_componentIndex->save();
+
+	if(preloadKinds)
+	{
+		new KindPreloader(result.get(), sources, _iconCache.get());
 	}
 
+	DBInfo("Built component registry with ", result->kindNames().size(), " kinds in ", timer.elapsed(), " ms");
 	return result;
 }
 
+DiagramContext *Application::createContext(bool preloadKinds)
+{
+	if(!_registry)
+	{
+		_registry = buildRegistry(preloadKinds);
+	}
+
+	return new DiagramContext(_registry);
+}
+
 Application::~Application()
 {
 }
@@ -154,6 +186,12 @@ void Application::saveSettings()
 	_settings.setValue("colors/ports/highlight", _portHighlightColor);
 	_settings.setValue("colors/ports/outline", _portOutlineColor);
 	_settings.setValue("log/level", log::levelName(log::level()));
+	_settings.setValue("rendering/lod/glyphBelow", _levelOfDetail.glyphBelow);
+	_settings.setValue("rendering/lod/blockBelow", _levelOfDetail.blockBelow);
+	_settings.setValue("rendering/lod/hiddenBelow", _levelOfDetail.hiddenBelow);
+	_settings.setValue("rendering/lod/greekTextBelow", _levelOfDetail.greekTextBelow);
+	_settings.setValue("rendering/symbolCacheKiB", _symbolCache->maxKiB());
+	_settings.setValue("rendering/flattenItems", _flattenItems);
 	_settings.sync();
 
 	emit settingsChanged();
@@ -164,6 +202,14 @@ void Application::readSettings()
 	_portHighlightColor = _settings.value("colors/ports/highlight", QColor("DarkViolet")).value<QColor>();
 	_portOutlineColor   = _settings.value("colors/ports/outline",   defaultPortOutlineColor()).value<QColor>();
 	log::setLevel(log::levelForName(_settings.value("log/level").toString().toStdString()).get_value_or(log::Debug));
+
+	const LevelOfDetail defaults;
+	_levelOfDetail.glyphBelow     = _settings.value("rendering/lod/glyphBelow",     defaults.glyphBelow).toDouble();
+	_levelOfDetail.blockBelow     = _settings.value("rendering/lod/blockBelow",     defaults.blockBelow).toDouble();
+	_levelOfDetail.hiddenBelow    = _settings.value("rendering/lod/hiddenBelow",    defaults.hiddenBelow).toDouble();
+	_levelOfDetail.greekTextBelow = _settings.value("rendering/lod/greekTextBelow", defaults.greekTextBelow).toDouble();
+	_symbolCache->setMaxKiB(_settings.value("rendering/symbolCacheKiB", SymbolCache::DefaultMaxKiB).toInt());
+	_flattenItems = _settings.value("rendering/flattenItems", false).toBool();
 }
 
 void Application::run()
@@ -215,9 +261,24 @@ void Application::setLibraries(const QSet<QString> &value)
 		convertedValue << s;
 	}
 
+	// windows already open keep the registry they were made with
+	if(value != libraries())
+	{
+		_registry.reset();
+	}
 	_settings.setValue("libraries", convertedValue);
 }
 
+int Application::autosaveInterval() const
+{
+	return _settings.value("documents/autosaveInterval", 0).toInt();
+}
+
+void Application::setAutosaveInterval(int minutes)
+{
+	_settings.setValue("documents/autosaveInterval", minutes);
+}
+
 
 } /* namespace dbuilder */
 
@@ -2,9 +2,11 @@
 #include <QSettings>
 #include <QObject>
 #include <functional>
+#include <memory>
 #include <QSharedPointer>
 #include <QColor>
 #include "CoreForward.hpp"
+#include "LevelOfDetail.hpp"
 #include <QList>
 /**
  * @file   Application.hpp
@@ -17,6 +19,10 @@
 
 namespace dbuilder {
 class MainWindow;
+class ComponentIndex;
+class IconCache;
+class SymbolCache;
+class ComponentRegistry;
 
 
 class Application: public QObject
@@ -25,6 +31,10 @@ class Application: public QObject
 	QList<QSharedPointer<MainWindow>> mainWindows;
 	QList<DiagramContext *> activeContexts;
 	QList<QObject *> _plugins;
+	std::unique_ptr<ComponentIndex> _componentIndex;
+	std::unique_ptr<IconCache> _iconCache;
+	std::unique_ptr<SymbolCache> _symbolCache;
+	std::shared_ptr<ComponentRegistry> _registry;
 
 
 	friend class ReplaceMain;
@@ -32,7 +42,11 @@ class Application: public QObject
 	static void setMain(std::function<int(int, char**)> f);
 	static Application *_instance;
 
+	std::shared_ptr<ComponentRegistry> buildRegistry(bool preloadKinds);
+
 	QColor _portOutlineColor, _portHighlightColor;
+	LevelOfDetail _levelOfDetail;
+	bool _flattenItems;
 public:
 	static Application *instance();
 
@@ -44,11 +58,39 @@ public:
 	void saveSettings();
 	void readSettings();
 
-	DiagramContext *createContext();
+	/**
+	 * Makes a context on the component registry for the current libraries.
+	 * The registry is built by the first call, and again by the first call
+	 * after setLibraries() changes them.
+	 *
+	 * @param preloadKinds  whether to create the indexed kinds in the
+	 * background, ahead of their first use, if the registry is built;
+	 * needs a GUI application
+	 */
+	DiagramContext *createContext(bool preloadKinds=false);
+
+	/// @return where component icons rendered in earlier runs are kept
+	IconCache *iconCache() const
+	{
+		return _iconCache.get();
+	}
+
+	/// @return the rasters of SVG symbols shared by every window
+	SymbolCache *symbolCache() const
+	{
+		return _symbolCache.get();
+	}
 
 	QSet<QString> libraries() const;
 	void setLibraries(const QSet<QString> &);
 
+	/**
+	 * @return minutes between autosaves of modified documents, or 0 if they
+	 * are not autosaved
+	 */
+	int autosaveInterval() const;
+	void setAutosaveInterval(int minutes);
+
 	void run();
 
 	const QColor& portOutlineColor() const
@@ -77,6 +119,32 @@ public:
 		_portHighlightColor = portHighlightColor;
 	}
 
+	/// @return when items are drawn in less detail; saved with the settings
+	const LevelOfDetail &levelOfDetail() const
+	{
+		return _levelOfDetail;
+	}
+
+	void setLevelOfDetail(const LevelOfDetail &levelOfDetail)
+	{
+		_levelOfDetail = levelOfDetail;
+	}
+
+	/**
+	 * @return whether SVG components are drawn by their diagram items
+	 * alone, without child items for the symbol and ports; applies to items
+	 * made after it is set. Off unless enabled in the settings.
+	 */
+	bool flattenItems() const
+	{
+		return _flattenItems;
+	}
+
+	void setFlattenItems(bool flattenItems)
+	{
+		_flattenItems = flattenItems;
+	}
+
 	class ReplaceMain
 	{
 	public:
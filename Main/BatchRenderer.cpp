@@ -0,0 +1,444 @@
+/**
+ * @file   BatchRenderer.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_BatchRenderer.cpp"
+#include <QApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QThread>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <exception>
+#include "DiagramScene.hpp"
+#include "DiagramItem.hpp"
+#include "DiagramItemModel.hpp"
+#include "DiagramComponent.hpp"
+#include "DiagramIO/DocumentReader.hpp"
+#include "Main/Application.hpp"
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+
+namespace {
+
+const char Usage[] =
+	"Usage: dbuilder-render [-f svg|png|pdf] [-o DIR] [-s SCALE] [-j JOBS] [-v] FILE...\n"
+	"\n"
+	"Renders each document to a file of the same name with the suffix of\n"
+	"the format, beside it or in DIR.\n"
+	"\n"
+	"  -f FORMAT  output format (default svg)\n"
+	"  -o DIR     directory for the output files\n"
+	"  -s SCALE   pixels per scene unit for png (default 1)\n"
+	"  -j JOBS    worker processes (default: one per core)\n"
+	"  -v         log loading and rendering\n"
+	"\n"
+	"Text and symbols are laid out with the fonts of the window system, so\n"
+	"a display is needed; on a machine without one, run under xvfb-run.\n";
+
+int usage()
+{
+	std::cerr << Usage;
+	return 2;
+}
+
+void report(const QString &input, qint64 ms, const QString &error)
+{
+	std::cout << std::setw(8) << ms << " ms  " << input.toLocal8Bit().constData();
+	if(!error.isNull())
+	{
+		std::cout << "  FAILED: " << error.toLocal8Bit().constData();
+	}
+	std::cout << std::endl;
+}
+
+/// Keeps a reason on one field of a worker's report.
+QString oneLine(QString text)
+{
+	return text.replace('\n', ' ').replace('\t', ' ');
+}
+
+int runWorker(DiagramContext *ctx, const RenderOptions &options)
+{
+	std::string line;
+	while(std::getline(std::cin, line))
+	{
+		if(line.empty()) continue;
+
+		const auto input = QString::fromUtf8(line.data(), line.size());
+		QElapsedTimer timer;
+		timer.start();
+		const auto error = renderDocument(ctx, input, options);
+
+		std::cout << (error.isNull()? "OK" : "FAIL") << '\t' << timer.elapsed() << '\t' << line;
+		if(!error.isNull())
+		{
+			std::cout << '\t' << oneLine(error).toUtf8().constData();
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}
+
+}  // namespace
+
+QString RenderOptions::outputPath(const QString &input) const
+{
+	const QFileInfo info(input);
+	const QDir dir(outputDirectory.isEmpty()? info.absolutePath() : outputDirectory);
+	return dir.filePath(info.completeBaseName() + "." + exportFormatSuffix(format));
+}
+
+QString renderDocument(DiagramContext *ctx, const QString &input, const RenderOptions &options)
+{
+	// as a window would open it, with the saved changes in its journal
+	std::vector<DiagramItemRecord> records;
+	const QString readError = readDocumentFile(input, records);
+	if(!readError.isNull())
+	{
+		return readError;
+	}
+
+	DiagramScene scene(ctx);
+	QList<DiagramItem *> items;
+	try
+	{
+		for(auto &record : records)
+		{
+			auto model = record.createModel(ctx);
+			items << model->kind()->createFromModel(model);
+		}
+	}
+	catch(const std::exception &exc)
+	{
+		qDeleteAll(items);
+		return QString::fromLocal8Bit(exc.what());
+	}
+	scene.addDiagramItemsInOrder(items);
+
+	return exportScene(&scene, options.outputPath(input), options.format, options.scale);
+}
+
+RenderWorkerPool::RenderWorkerPool(const QStringList &files, const QStringList &workerArguments, QObject *parent)
+: QObject(parent)
+, _workerArguments(workerArguments)
+, _pending(files.begin(), files.end())
+, _succeeded(0)
+, _failed(0)
+, _finished(false)
+{
+}
+
+RenderWorkerPool::~RenderWorkerPool()
+{
+	for(auto &worker : _workers)
+	{
+		if(worker.process)
+		{
+			worker.process->kill();
+			worker.process->waitForFinished();
+		}
+	}
+}
+
+void RenderWorkerPool::start(int workers)
+{
+	workers = std::max(1, std::min(workers, int(_pending.size())));
+	for(int i = 0; i < workers; ++i)
+	{
+		startWorker();
+	}
+	checkFinished();
+}
+
+RenderWorkerPool::Worker *RenderWorkerPool::workerFor(QObject *process)
+{
+	for(auto &worker : _workers)
+	{
+		if(worker.process == process)
+		{
+			return &worker;
+		}
+	}
+	return nullptr;
+}
+
+void RenderWorkerPool::startWorker()
+{
+	auto process = new QProcess(this);
+	connect(process, SIGNAL(readyReadStandardOutput()), this, SLOT(workerOutput()));
+	connect(process, SIGNAL(readyReadStandardError()), this, SLOT(workerLog()));
+	connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(workerFinished(int, QProcess::ExitStatus)));
+	connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(workerError(QProcess::ProcessError)));
+
+	_workers.push_back(Worker{process, QString()});
+	process->start(QCoreApplication::applicationFilePath(), _workerArguments);
+	dispatch(_workers.back());
+}
+
+void RenderWorkerPool::dispatch(Worker &worker)
+{
+	if(_pending.empty())
+	{
+		// the worker exits at the end of its input
+		worker.current = QString();
+		worker.process->closeWriteChannel();
+		return;
+	}
+
+	worker.current = _pending.front();
+	_pending.pop_front();
+	worker.process->write((worker.current + "\n").toUtf8());
+}
+
+void RenderWorkerPool::readReports(Worker &worker)
+{
+	while(worker.process->canReadLine())
+	{
+		const QByteArray line = worker.process->readLine();
+		const auto fields = QString::fromUtf8(line.constData(), line.size()).trimmed().split('\t');
+		if(fields.size() < 3)
+		{
+			continue;
+		}
+
+		const bool ok = fields[0] == "OK";
+		const QString error = ok? QString() : fields.value(3, tr("unknown error"));
+		(ok? _succeeded : _failed) += 1;
+		report(fields[2], fields[1].toLongLong(), error);
+		dispatch(worker);
+	}
+}
+
+void RenderWorkerPool::workerOutput()
+{
+	if(auto worker = workerFor(sender()))
+	{
+		readReports(*worker);
+	}
+}
+
+void RenderWorkerPool::workerLog()
+{
+	if(auto process = qobject_cast<QProcess *>(sender()))
+	{
+		const auto log = process->readAllStandardError();
+		std::cerr.write(log.constData(), log.size());
+	}
+}
+
+void RenderWorkerPool::workerFinished(int, QProcess::ExitStatus)
+{
+	auto worker = workerFor(sender());
+	if(!worker)
+	{
+		return;
+	}
+
+	readReports(*worker);
+	const bool crashed = !worker->current.isNull();
+	if(crashed)
+	{
+		++_failed;
+		report(worker->current, 0, tr("the renderer exited unexpectedly"));
+	}
+
+	worker->process->deleteLater();
+	worker->process = nullptr;
+	worker->current = QString();
+
+	// documents that crash a worker only take that one with them
+	if(crashed && !_pending.empty())
+	{
+		startWorker();
+	}
+	checkFinished();
+}
+
+void RenderWorkerPool::workerError(QProcess::ProcessError error)
+{
+	// otherwise finished() follows
+	if(error != QProcess::FailedToStart)
+	{
+		return;
+	}
+
+	auto worker = workerFor(sender());
+	if(!worker)
+	{
+		return;
+	}
+
+	DBError("Cannot start a render worker: ", qobject_cast<QProcess *>(sender())->errorString().toStdString());
+	const QString reason = tr("no worker could be started");
+	if(!worker->current.isNull())
+	{
+		++_failed;
+		report(worker->current, 0, reason);
+	}
+	worker->process->deleteLater();
+	worker->process = nullptr;
+	worker->current = QString();
+
+	const bool anyRunning = std::any_of(_workers.begin(), _workers.end(),
+	                                    [](const Worker &w) { return w.process != nullptr; });
+	if(!anyRunning)
+	{
+		for(const auto &input : _pending)
+		{
+			++_failed;
+			report(input, 0, reason);
+		}
+		_pending.clear();
+	}
+	checkFinished();
+}
+
+void RenderWorkerPool::checkFinished()
+{
+	if(_finished || !_pending.empty())
+	{
+		return;
+	}
+	for(const auto &worker : _workers)
+	{
+		if(worker.process)
+		{
+			return;
+		}
+	}
+
+	_finished = true;
+	emit finished();
+}
+
+int renderMain(int argc, char **argv)
+{
+	// fonts and pixmaps need the GUI, even though no window is shown
+	QApplication qapp(argc, argv);
+
+	RenderOptions options;
+	int jobs = std::max(1, QThread::idealThreadCount());
+	bool worker = false, verbose = false;
+	QStringList files;
+
+	const auto args = qapp.arguments();
+	for(int i = 1; i < args.size(); ++i)
+	{
+		const auto &arg = args[i];
+		const bool hasValue = i + 1 < args.size();
+		bool ok = true;
+		if(arg == "-f" && hasValue)
+		{
+			auto format = exportFormatForName(args[++i]);
+			ok = bool(format);
+			if(format) options.format = *format;
+		}
+		else if(arg == "-o" && hasValue)
+		{
+			options.outputDirectory = args[++i];
+		}
+		else if(arg == "-s" && hasValue)
+		{
+			options.scale = args[++i].toDouble(&ok);
+			ok = ok && options.scale > 0;
+		}
+		else if(arg == "-j" && hasValue)
+		{
+			jobs = args[++i].toInt(&ok);
+			ok = ok && jobs > 0;
+		}
+		else if(arg == "-v")
+		{
+			verbose = true;
+		}
+		else if(arg == "--worker")
+		{
+			worker = true;
+		}
+		else if(arg.startsWith('-'))
+		{
+			ok = false;
+		}
+		else
+		{
+			files << arg;
+		}
+
+		if(!ok)
+		{
+			return usage();
+		}
+	}
+
+	if(!worker && files.isEmpty())
+	{
+		return usage();
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	int failed = 0;
+
+	if(worker || jobs == 1 || files.size() == 1)
+	{
+		Application app;
+		log::setLevel(verbose? log::Debug : log::Warning);
+		DiagramContext *ctx = app.createContext();
+
+		if(worker)
+		{
+			return runWorker(ctx, options);
+		}
+
+		for(const auto &input : files)
+		{
+			QElapsedTimer fileTimer;
+			fileTimer.start();
+			const auto error = renderDocument(ctx, input, options);
+			report(input, fileTimer.elapsed(), error);
+			failed += !error.isNull();
+		}
+	}
+	else
+	{
+		QStringList workerArguments {
+			"--worker",
+			"-f", exportFormatSuffix(options.format),
+			"-s", QString::number(options.scale)
+		};
+		if(!options.outputDirectory.isEmpty())
+		{
+			workerArguments << "-o" << options.outputDirectory;
+		}
+		if(verbose)
+		{
+			workerArguments << "-v";
+		}
+
+		RenderWorkerPool pool(files, workerArguments);
+		QObject::connect(&pool, SIGNAL(finished()), &qapp, SLOT(quit()));
+		pool.start(jobs);
+		if(!pool.isFinished())
+		{
+			qapp.exec();
+		}
+		failed = pool.failed();
+	}
+
+	std::cout << "Rendered " << files.size() - failed << " of " << files.size()
+	          << " files in " << timer.elapsed() << " ms" << std::endl;
+	return failed > 0? 1 : 0;
+}
+
+// this file is only built into dbuilder-render
+namespace { Application::ReplaceMain r{renderMain}; }
+
+}  // namespace dbuilder
@@ -0,0 +1,113 @@
+#pragma once
+/**
+ * @file   BatchRenderer.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <deque>
+#include <vector>
+#include "Main/SceneExport.hpp"
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+
+/**
+ * What dbuilder-render makes of each document.
+ */
+struct RenderOptions
+{
+	ExportFormat format;
+	/// empty to write each file beside its document
+	QString outputDirectory;
+	qreal scale;
+
+	RenderOptions()
+	: format(ExportFormat::Svg)
+	, scale(1)
+	{ }
+
+	/// @return where the rendering of the document at input goes
+	QString outputPath(const QString &input) const;
+};
+
+/**
+ * Loads the document at input, with the saved changes in its journal, into
+ * a scene of its own, with no view, and exports it as options say.
+ *
+ * @return a description of the failure, or a null string on success
+ */
+QString renderDocument(DiagramContext *ctx, const QString &input, const RenderOptions &options);
+
+/**
+ * Renders a list of documents in worker processes, handing each worker the
+ * next document as soon as it reports on the last one.
+ *
+ * Workers are this executable run with --worker and the options of the
+ * parent. They read document paths from stdin, one per line, and answer
+ * each with a line on stdout: "OK", the milliseconds taken and the path,
+ * or "FAIL", the milliseconds, the path and the reason, separated by tabs.
+ */
+class RenderWorkerPool: public QObject
+{
+	Q_OBJECT
+
+	struct Worker
+	{
+		QProcess *process;
+		QString current;
+	};
+
+	QStringList _workerArguments;
+	std::deque<QString> _pending;
+	std::vector<Worker> _workers;
+	int _succeeded, _failed;
+	bool _finished;
+
+	Worker *workerFor(QObject *process);
+	void startWorker();
+	void dispatch(Worker &worker);
+	void readReports(Worker &worker);
+	void checkFinished();
+
+public:
+	RenderWorkerPool(const QStringList &files, const QStringList &workerArguments, QObject *parent=nullptr);
+	virtual ~RenderWorkerPool();
+
+	/**
+	 * Starts up to workers processes. finished() is emitted once every file
+	 * is done.
+	 */
+	void start(int workers);
+
+	int succeeded() const { return _succeeded; }
+	int failed() const { return _failed; }
+	bool isFinished() const { return _finished; }
+
+signals:
+	void finished();
+
+private slots:
+	void workerOutput();
+	void workerLog();
+	void workerFinished(int exitCode, QProcess::ExitStatus status);
+	void workerError(QProcess::ProcessError error);
+};
+
+/**
+ * The main function of dbuilder-render.
+ *
+ * Usage: dbuilder-render [-f svg|png|pdf] [-o DIR] [-s SCALE] [-j JOBS] [-v] FILE...
+ *
+ * Prints the time taken for each file, and exits with 1 if any of them
+ * failed or 2 for bad arguments.
+ */
+int renderMain(int argc, char **argv);
+
+}  // namespace dbuilder
@@ -0,0 +1,213 @@
+/**
+ * @file   CheckTool.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QApplication>
+#include <QFile>
+#include <QElapsedTimer>
+#include <iostream>
+#include <memory>
+#include <exception>
+#include "DiagramIO/DocumentChecker.hpp"
+#include "DiagramIO/DocumentReader.hpp"
+#include "DiagramIO/DocumentFormat.hpp"
+#include "DiagramIO/InfoDiagramLoader.hpp"
+#include "DiagramIO/BinaryDiagramLoader.hpp"
+#include "DiagramItemModel.hpp"
+#include "Main/Application.hpp"
+#include "Main/DocumentSaver.hpp"
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+
+namespace {
+
+const char Usage[] =
+	"Usage: dbuilder-check [--repair] [--json] [-o OUTPUT] FILE...\n"
+	"\n"
+	"Checks the references between the items of each document, as saved\n"
+	"with the changes in its journal. A repaired document holds those\n"
+	"changes, and its journal is removed.\n"
+	"\n"
+	"  --repair   write each document back with its problems repaired\n"
+	"  -o OUTPUT  write the repaired document there instead (one FILE only)\n"
+	"  --json     print a JSON array with one report per document\n"
+	"  -v         log loading\n"
+	"\n"
+	"Exits with 0 if no problems were found, 1 if some were, and 2 if a\n"
+	"document could not be read or written.\n"
+	"\n"
+	"Loading the kinds of the items needs a display; on a machine without\n"
+	"one, run under xvfb-run.\n";
+
+int usage()
+{
+	std::cerr << Usage;
+	return 2;
+}
+
+/**
+ * Writes records to path in format, through the loader that reads it.
+ *
+ * @return a description of the failure, or a null string on success
+ */
+QString writeRecords(DiagramContext *ctx, const QString &path, DocumentFormat format,
+                     std::vector<DiagramItemRecord> &records)
+{
+	QObject models;
+	std::shared_ptr<DocumentSnapshot> snapshot(new DocumentSnapshot);
+	snapshot->revision = 0;
+	snapshot->items.reserve(records.size());
+	try
+	{
+		for(auto &record : records)
+		{
+			snapshot->items.push_back(record.createModel(ctx, &models)->snapshot());
+		}
+	}
+	catch(const std::exception &exc)
+	{
+		return QString::fromLocal8Bit(exc.what());
+	}
+
+	if(format == DocumentFormat::Binary)
+	{
+		BinaryDiagramLoader loader(ctx);
+		return writeDocument(path, &loader, snapshot);
+	}
+
+	InfoDiagramLoader loader(ctx);
+	loader.setCompressed(format == DocumentFormat::CompressedInfo);
+	return writeDocument(path, &loader, snapshot);
+}
+
+}  // namespace
+
+/**
+ * The main function of dbuilder-check. See Usage.
+ */
+int checkMain(int argc, char **argv)
+{
+	// loading kinds makes their icons and glyphs, which need the GUI
+	QApplication qapp(argc, argv);
+
+	bool repair = false, json = false, verbose = false;
+	QString output;
+	QStringList files;
+
+	const auto args = qapp.arguments();
+	for(int i = 1; i < args.size(); ++i)
+	{
+		const auto &arg = args[i];
+		if(arg == "--repair")
+		{
+			repair = true;
+		}
+		else if(arg == "--json")
+		{
+			json = true;
+		}
+		else if(arg == "-v")
+		{
+			verbose = true;
+		}
+		else if(arg == "-o" && i + 1 < args.size())
+		{
+			output = args[++i];
+		}
+		else if(arg.startsWith('-'))
+		{
+			return usage();
+		}
+		else
+		{
+			files << arg;
+		}
+	}
+
+	if(files.isEmpty() || (!output.isEmpty() && (!repair || files.size() != 1)))
+	{
+		return usage();
+	}
+
+	Application app;
+	log::setLevel(verbose? log::Debug : log::Warning);
+	DiagramContext *ctx = app.createContext();
+
+	int status = 0;
+	bool first = true;
+	if(json) std::cout << "[";
+	for(const auto &path : files)
+	{
+		QElapsedTimer timer;
+		timer.start();
+
+		// the document as last saved includes the saved frames of its journal
+		std::vector<DiagramItemRecord> records;
+		DocumentFormat format;
+		const QString readError = readDocumentFile(path, records, &format);
+		if(!readError.isNull())
+		{
+			std::cerr << path.toLocal8Bit().constData() << ": " << readError.toLocal8Bit().constData() << std::endl;
+			status = 2;
+			continue;
+		}
+
+		const auto report = checkDocument(records, ctx);
+		const qint64 checkMs = timer.elapsed();
+		if(!report.clean() && status == 0)
+		{
+			status = 1;
+		}
+
+		QString writeError;
+		if(repair && (!report.clean() || !output.isEmpty()))
+		{
+			repairDocument(records, report);
+			const QString target = output.isEmpty()? path : output;
+			writeError = writeRecords(ctx, target, format, records);
+			if(!writeError.isNull())
+			{
+				std::cerr << path.toLocal8Bit().constData() << ": " << writeError.toLocal8Bit().constData() << std::endl;
+				status = 2;
+			}
+			else
+			{
+				// the rewritten document already holds what the journal did
+				QFile::remove(DocumentJournal::pathFor(target));
+			}
+		}
+
+		if(json)
+		{
+			std::cout << (first? "\n" : ",\n");
+			report.writeJson(std::cout, path.toUtf8().constData());
+		}
+		else
+		{
+			std::cout << path.toLocal8Bit().constData() << ": " << report.itemCount << " items, "
+			          << report.issues.size() << " problems, checked in " << checkMs << " ms";
+			if(repair && !report.clean() && writeError.isNull())
+			{
+				std::cout << ", repaired (" << report.removedCount() << " items removed)";
+			}
+			std::cout << std::endl;
+			for(const auto &issue : report.issues)
+			{
+				std::cout << "  " << issue.describe() << std::endl;
+			}
+		}
+		first = false;
+	}
+	if(json) std::cout << "\n]" << std::endl;
+
+	return status;
+}
+
+// this file is only built into dbuilder-check
+namespace { Application::ReplaceMain r{checkMain}; }
+
+}  // namespace dbuilder
@@ -0,0 +1,410 @@
+/**
+ * @file   DocumentOpener.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_DocumentOpener.cpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QProgressDialog>
+#include <QtConcurrentRun>
+#include <algorithm>
+#include <memory>
+#include "DiagramScene.hpp"
+#include "DiagramItem.hpp"
+#include "DiagramItemModel.hpp"
+#include "DiagramComponent.hpp"
+#include "DiagramIO/DocumentReader.hpp"
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+
+namespace {
+
+// small at first so the first items appear quickly
+const std::size_t FirstBatchSize = 64;
+const std::size_t MaxBatchSize = 4096;
+
+struct Cancelled { };
+
+}  // namespace
+
+DocumentOpener::DocumentOpener(DiagramScene *scene, QWidget *dialogParent, QObject *parent)
+: QObject(parent)
+, _scene(scene)
+, _format(DocumentFormat::Info)
+, _progress(new QProgressDialog(dialogParent))
+, _cancelled(0)
+, _parsed(0)
+, _currentIndex(0)
+, _created(0)
+, _scheduled(false)
+, _stopped(false)
+, _succeeded(false)
+, _emitted(false)
+{
+	_progress->setWindowModality(Qt::WindowModal);
+	_progress->setMinimumDuration(500);
+	_progress->setRange(0, 0);
+	_progress->setAutoReset(false);
+	_progress->setAutoClose(false);
+	connect(_progress, SIGNAL(canceled()), this, SLOT(cancel()));
+	connect(&_watcher, SIGNAL(finished()), this, SLOT(parseFinished()));
+}
+
+DocumentOpener::~DocumentOpener()
+{
+	// being deleted is not a result anyone waits for
+	_emitted = true;
+	_cancelled = 1;
+	_watcher.waitForFinished();
+	if(!_stopped)
+	{
+		stop(QString());
+	}
+	delete _progress;
+}
+
+void DocumentOpener::open(const QString &path, JournalReplay replay)
+{
+	_path = path;
+	_replay = std::move(replay);
+	_elapsed.start();
+	_progress->setLabelText(tr("Opening %1...").arg(QFileInfo(path).fileName()));
+	_watcher.setFuture(QtConcurrent::run(this, &DocumentOpener::parse));
+}
+
+void DocumentOpener::parse()
+{
+	// Items keep the parts of their extraData that nothing has read yet in
+	// this buffer, so it lives as long as they refer to it. It is a copy,
+	// not a mapping, for binary documents too: another program may
+	// overwrite the file in place while the items still refer to it, and a
+	// mapping would then fault or change under them.
+	QFile file(_path);
+	if(!file.open(QIODevice::ReadOnly))
+	{
+		QMutexLocker lock(&_mutex);
+		_error = file.errorString();
+		return;
+	}
+
+	auto contents = std::make_shared<QByteArray>(file.readAll());
+	file.close();
+	const char *data = contents->constData();
+	const std::size_t size = contents->size();
+	const BufferOwner owner = contents;
+	_format = detectDocumentFormat(data, size);
+
+	Batch batch;
+	std::size_t batchSize = FirstBatchSize;
+	auto flush = [&]() {
+		if(batch.empty()) return;
+		{
+			QMutexLocker lock(&_mutex);
+			_batches.push_back(std::move(batch));
+		}
+		batch = Batch();
+		batchSize = std::min(batchSize * 2, MaxBatchSize);
+		QMetaObject::invokeMethod(this, "processBatches", Qt::QueuedConnection);
+	};
+
+	auto add = [&](DiagramItemRecord &record) {
+		batch.emplace_back();
+		batch.back().swap(record);
+		_parsed.ref();
+		if(batch.size() >= batchSize)
+		{
+			flush();
+		}
+	};
+
+	auto sink = [&](DiagramItemRecord &record) {
+		if(_cancelled)
+		{
+			throw Cancelled();
+		}
+		add(record);
+	};
+
+	try
+	{
+		// a compressed document is expanded into a buffer that becomes the owner
+		readDocument(data, size, _replay, sink, owner);
+		flush();
+	}
+	catch(const Cancelled &)
+	{
+	}
+	catch(const std::exception &exc)
+	{
+		QMutexLocker lock(&_mutex);
+		_error = exc.what();
+	}
+}
+
+void DocumentOpener::schedule()
+{
+	if(!_scheduled)
+	{
+		_scheduled = true;
+		QMetaObject::invokeMethod(this, "processBatches", Qt::QueuedConnection);
+	}
+}
+
+void DocumentOpener::processBatches()
+{
+	_scheduled = false;
+	if(_stopped)
+	{
+		return;
+	}
+
+	bool entered = _processGuard.enter([&]() {
+		QElapsedTimer timer;
+		timer.start();
+		try
+		{
+			do
+			{
+				if(_currentIndex == _current.size())
+				{
+					QMutexLocker lock(&_mutex);
+					if(_batches.empty()) break;
+
+					_current = std::move(_batches.front());
+					_batches.pop_front();
+					_currentIndex = 0;
+				}
+
+				instantiate(_current[_currentIndex++]);
+			} while(timer.elapsed() < SliceMilliseconds);
+		}
+		catch(const std::exception &exc)
+		{
+			stop(exc.what());
+			return;
+		}
+
+		updateProgress();
+	});
+
+	if(!entered)
+	{
+		// a nested event loop (the progress dialog's) called us back
+		schedule();
+		return;
+	}
+
+	if(_stopped)
+	{
+		return;
+	}
+
+	bool more;
+	{
+		QMutexLocker lock(&_mutex);
+		more = _currentIndex < _current.size() || !_batches.empty();
+	}
+
+	if(more)
+	{
+		schedule();
+	}
+	else if(_watcher.isFinished())
+	{
+		QString error;
+		{
+			QMutexLocker lock(&_mutex);
+			error = _error;
+		}
+
+		if(error.isEmpty())
+		{
+			complete();
+		}
+		else
+		{
+			stop(error);
+		}
+	}
+}
+
+void DocumentOpener::parseFinished()
+{
+	if(_stopped)
+	{
+		emitFinishedIfDone();
+	}
+	else
+	{
+		processBatches();
+	}
+}
+
+void DocumentOpener::instantiate(DiagramItemRecord &record)
+{
+	auto model = record.createModel(_scene->context());
+	auto item = model->kind()->createFromModel(model);
+	++_created;
+
+	int missing = 0;
+	for(const auto &dep : model->dependencies())
+	{
+		if(!_scene->item(dep))
+		{
+			_waiting.insert(dep, item);
+			++missing;
+		}
+	}
+
+	if(missing > 0)
+	{
+		_missing.insert(item, missing);
+		_pending << item;
+	}
+	else
+	{
+		_ready << item;
+		activateReady();
+	}
+}
+
+void DocumentOpener::activateReady()
+{
+	while(!_ready.isEmpty())
+	{
+		auto item = _ready.takeFirst();
+		_scene->addDiagramItem(item);
+
+		const QUuid uuid = item->model()->uuid();
+		auto it = _waiting.find(uuid);
+		while(it != _waiting.end() && it.key() == uuid)
+		{
+			auto waiter = _missing.find(*it);
+			if(waiter != _missing.end() && --*waiter == 0)
+			{
+				_ready << waiter.key();
+				_missing.erase(waiter);
+			}
+			it = _waiting.erase(it);
+		}
+	}
+}
+
+void DocumentOpener::complete()
+{
+	// whatever still waits has a dangling dependency or is part of a
+	// cycle; the scene reports those and adds them in the best order it can
+	QList<DiagramItem *> remaining;
+	for(auto item : _pending)
+	{
+		if(_missing.contains(item))
+		{
+			remaining << item;
+		}
+	}
+	_pending.clear();
+	_missing.clear();
+	_waiting.clear();
+
+	if(!remaining.isEmpty())
+	{
+		_scene->addDiagramItemsInOrder(remaining);
+	}
+
+	DBInfo("Opened ", _path.toStdString(), ": ", _created, " items in ", _elapsed.elapsed(), " ms");
+	_succeeded = true;
+	_stopped = true;
+	emitFinishedIfDone();
+}
+
+void DocumentOpener::stop(const QString &error)
+{
+	_stopped = true;
+	_cancelled = 1;
+	{
+		QMutexLocker lock(&_mutex);
+		_batches.clear();
+		_error = error;
+	}
+	_current.clear();
+	_currentIndex = 0;
+
+	// items that never made it into the scene are still ours
+	for(auto item : _pending)
+	{
+		if(_missing.contains(item))
+		{
+			delete item;
+		}
+	}
+	qDeleteAll(_ready);
+	_pending.clear();
+	_missing.clear();
+	_waiting.clear();
+	_ready.clear();
+
+	_scene->clearDiagram();
+
+	if(error.isEmpty())
+	{
+		DBInfo("Cancelled opening ", _path.toStdString());
+	}
+	else
+	{
+		DBError("Failed to read ", _path.toStdString(), ": ", error.toStdString());
+	}
+
+	emitFinishedIfDone();
+}
+
+void DocumentOpener::cancel()
+{
+	if(!_stopped)
+	{
+		stop(QString());
+	}
+}
+
+void DocumentOpener::updateProgress()
+{
+	if(_watcher.isFinished())
+	{
+		_progress->setRange(0, _parsed);
+		_progress->setValue(_created);
+	}
+	else
+	{
+		_progress->setLabelText(tr("Opening %1...\n%2 items read")
+		                        .arg(QFileInfo(_path).fileName())
+		                        .arg(int(_parsed)));
+		// keeps the busy indicator moving and shows the dialog once
+		// the minimum duration has passed
+		_progress->setValue(0);
+	}
+}
+
+void DocumentOpener::emitFinishedIfDone()
+{
+	if(_emitted || !_stopped || !_watcher.isFinished())
+	{
+		return;
+	}
+
+	_emitted = true;
+	_progress->hide();
+
+	QString error;
+	{
+		QMutexLocker lock(&_mutex);
+		error = _error;
+	}
+	emit finished(_succeeded, error);
+}
+
+}  // namespace dbuilder
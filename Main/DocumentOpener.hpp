@@ -0,0 +1,124 @@
+#pragma once
+/**
+ * @file   DocumentOpener.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMultiHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <deque>
+#include <vector>
+#include "DiagramIO/DiagramItemRecord.hpp"
+#include "DiagramIO/DocumentFormat.hpp"
+#include "DiagramIO/DocumentJournal.hpp"
+#include "Util/ReentrancyGuard.hpp"
+#include "CoreForward.hpp"
+
+class QProgressDialog;
+class QWidget;
+
+namespace dbuilder {
+
+/**
+ * Opens a document into a scene without blocking the GUI thread.
+ *
+ * The file is parsed into DiagramItemRecords on a worker thread, which hands
+ * them over in batches. On the GUI thread, items are created and added to
+ * the scene in short time slices, each as soon as all of its dependencies
+ * are in the scene, so the first items are drawn while the rest of the
+ * file is still being read.
+ *
+ * A progress dialog is shown for slow opens. Cancelling, or an error,
+ * clears the scene. finished() is emitted exactly once, after the worker
+ * has stopped; the opener may then be deleted.
+ */
+class DocumentOpener: public QObject
+{
+	Q_OBJECT
+	typedef std::vector<DiagramItemRecord> Batch;
+
+	DiagramScene *_scene;
+	QString _path;
+	DocumentFormat _format;
+	JournalReplay _replay;
+	QProgressDialog *_progress;
+
+	// shared with the worker
+	QMutex _mutex;
+	std::deque<Batch> _batches;
+	QString _error;
+	QAtomicInt _cancelled;
+	QAtomicInt _parsed;
+
+	QFutureWatcher<void> _watcher;
+
+	// GUI thread only
+	Batch _current;
+	std::size_t _currentIndex;
+	QMultiHash<QUuid, DiagramItem *> _waiting;
+	QHash<DiagramItem *, int> _missing;
+	QList<DiagramItem *> _pending;
+	QList<DiagramItem *> _ready;
+	int _created;
+	bool _scheduled;
+	bool _stopped;
+	bool _succeeded;
+	bool _emitted;
+	QElapsedTimer _elapsed;
+	ReentrancyGuard _processGuard;
+
+	void parse();
+	void instantiate(DiagramItemRecord &record);
+	void activateReady();
+	void schedule();
+	void complete();
+	void stop(const QString &error);
+	void updateProgress();
+	void emitFinishedIfDone();
+
+public:
+	/// Items are created per slice for at most this long.
+	static const int SliceMilliseconds = 15;
+
+	DocumentOpener(DiagramScene *scene, QWidget *dialogParent, QObject *parent=nullptr);
+	virtual ~DocumentOpener();
+
+	/**
+	 * Starts opening path into the scene, which should be empty. Items are
+	 * patched with replay as they are read, and the items it adds follow
+	 * those of the document.
+	 */
+	void open(const QString &path, JournalReplay replay=JournalReplay());
+
+	/**
+	 * @return the format of the document; valid once finished() is emitted
+	 */
+	DocumentFormat format() const { return _format; }
+
+	const QString &path() const { return _path; }
+
+signals:
+	/**
+	 * @param ok     true if every item was loaded
+	 * @param error  a description of the failure; empty if cancelled
+	 */
+	void finished(bool ok, const QString &error);
+
+public slots:
+	void cancel();
+
+private slots:
+	void processBatches();
+	void parseFinished();
+};
+
+}  // namespace dbuilder
@@ -0,0 +1,159 @@
+/**
+ * @file   DocumentSaver.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_DocumentSaver.cpp"
+#include <QFile>
+#include <QElapsedTimer>
+#include <QtConcurrentRun>
+#include <cstdio>
+#include <sstream>
+#include <exception>
+#include "DiagramScene.hpp"
+#include "DiagramItem.hpp"
+#include "DiagramIO/DiagramLoader.hpp"
+#include "Util/Log.hpp"
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <windows.h>
+#include <QDir>
+#else
+#include <unistd.h>
+#endif
+
+namespace dbuilder {
+
+std::shared_ptr<const DocumentSnapshot> DocumentSnapshot::take(DiagramScene *scene)
+{
+	scene->flushDependencyUpdates();
+
+	auto items = scene->diagramItems();
+	std::shared_ptr<DocumentSnapshot> result(new DocumentSnapshot);
+	result->items.reserve(items.size());
+	for(auto item : items)
+	{
+		result->items.push_back(item->model()->snapshot());
+	}
+	// views may only commit their changes now
+	result->revision = scene->revision();
+	return result;
+}
+
+QString writeDocument(const QString &path,
+                      const DiagramLoader *loader,
+                      std::shared_ptr<const DocumentSnapshot> snapshot)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	std::string contents;
+	try
+	{
+		std::ostringstream os;
+		loader->saveSnapshots(os, snapshot->items);
+		contents = os.str();
+	}
+	catch(std::exception &ex)
+	{
+		DBError("Failed to write ", path.toStdString(), ": ", ex.what());
+		return QString::fromLocal8Bit(ex.what());
+	}
+
+	const QString tmpPath = path + ".tmp";
+	QFile tmp(tmpPath);
+	if(!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate)
+	   || tmp.write(contents.data(), contents.size()) != qint64(contents.size())
+	   || !tmp.flush())
+	{
+		const QString error = tmp.errorString();
+		DBError("Failed to write ", tmpPath.toStdString(), ": ", error.toStdString());
+		tmp.remove();
+		return error;
+	}
+
+	// the contents must be on disk before the rename makes them the document
+#ifdef Q_OS_WIN
+	const bool synced = ::_commit(tmp.handle()) == 0;
+#else
+	const bool synced = ::fsync(tmp.handle()) == 0;
+#endif
+	tmp.close();
+	if(!synced)
+	{
+		DBError("Failed to sync ", tmpPath.toStdString());
+		QFile::remove(tmpPath);
+		return QObject::tr("The file could not be flushed to disk.");
+	}
+
+#ifdef Q_OS_WIN
+	// replaces the document in one step, so a crash never leaves neither file
+	const bool replaced = ::MoveFileExW(
+		reinterpret_cast<const wchar_t *>(QDir::toNativeSeparators(tmpPath).utf16()),
+		reinterpret_cast<const wchar_t *>(QDir::toNativeSeparators(path).utf16()),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	const bool replaced = std::rename(QFile::encodeName(tmpPath).constData(),
+	                                  QFile::encodeName(path).constData()) == 0;
+#endif
+	if(!replaced)
+	{
+		DBError("Failed to replace ", path.toStdString());
+		QFile::remove(tmpPath);
+		return QObject::tr("The file could not be replaced.");
+	}
+
+	DBInfo("Wrote ", snapshot->items.size(), " items to ", path.toStdString(), " in ", timer.elapsed(), " ms");
+	return QString();
+}
+
+DocumentSaver::DocumentSaver(DiagramScene *scene, QObject *parent)
+: QObject(parent)
+, _scene(scene)
+, _saving(false)
+, _succeeded(true)
+, _loader(nullptr)
+, _revision(0)
+{
+	connect(&_watcher, SIGNAL(finished()), this, SLOT(writeFinished()));
+}
+
+DocumentSaver::~DocumentSaver()
+{
+	// the snapshot does not refer to the scene, but the file must be complete
+	_watcher.waitForFinished();
+}
+
+void DocumentSaver::save(const QString &path, const DiagramLoader *loader)
+{
+	finish();
+
+	auto snapshot = DocumentSnapshot::take(_scene);
+	_path = path;
+	_loader = loader;
+	_revision = snapshot->revision;
+	_saving = true;
+	_watcher.setFuture(QtConcurrent::run(&writeDocument, path, loader, snapshot));
+}
+
+bool DocumentSaver::finish()
+{
+	_watcher.waitForFinished();
+	writeFinished();
+	return _succeeded;
+}
+
+void DocumentSaver::writeFinished()
+{
+	if(!_saving) return;
+	_saving = false;
+
+	const QString error = _watcher.result();
+	_succeeded = error.isNull();
+	emit finished(_succeeded, error);
+}
+
+}  // namespace dbuilder
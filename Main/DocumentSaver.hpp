@@ -0,0 +1,102 @@
+#pragma once
+/**
+ * @file   DocumentSaver.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QObject>
+#include <QString>
+#include <QFutureWatcher>
+#include <memory>
+#include <vector>
+#include "DiagramItemModel.hpp"
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+
+/**
+ * The items of a scene as they were at one revision, in scene order.
+ */
+struct DocumentSnapshot
+{
+	std::vector<ModelSnapshot> items;
+	quint64 revision;
+
+	/**
+	 * Captures the scene after its pending dependency updates. Called on the
+	 * GUI thread; copies no extraData trees.
+	 */
+	static std::shared_ptr<const DocumentSnapshot> take(DiagramScene *scene);
+};
+
+/**
+ * Writes snapshot with loader to a temporary file beside path, flushes it to
+ * disk and renames it over path, so that the document is never left partly
+ * written. May be called from any thread.
+ *
+ * @return a description of the failure, or a null string on success
+ */
+QString writeDocument(const QString &path,
+                      const DiagramLoader *loader,
+                      std::shared_ptr<const DocumentSnapshot> snapshot);
+
+/**
+ * Saves a scene without blocking the GUI thread.
+ *
+ * save() captures the scene and returns; serialization and the write happen
+ * on a worker thread while editing continues. finished() is emitted once per
+ * save. Compare revision() with DiagramScene::revision() to tell whether the
+ * file still matches the scene.
+ */
+class DocumentSaver: public QObject
+{
+	Q_OBJECT
+	DiagramScene *_scene;
+	QFutureWatcher<QString> _watcher;
+	bool _saving;
+	bool _succeeded;
+
+	QString _path;
+	const DiagramLoader *_loader;
+	quint64 _revision;
+
+public:
+	DocumentSaver(DiagramScene *scene, QObject *parent=nullptr);
+	virtual ~DocumentSaver();
+
+	/**
+	 * Captures the scene and starts writing it to path with loader. A save
+	 * still in progress is finished first.
+	 */
+	void save(const QString &path, const DiagramLoader *loader);
+
+	bool saving() const { return _saving; }
+
+	/**
+	 * Waits for the save in progress, if any, and emits its finished().
+	 *
+	 * @return false if the last save failed
+	 */
+	bool finish();
+
+	/// @return the path of the last save
+	const QString &path() const { return _path; }
+	/// @return the loader of the last save
+	const DiagramLoader *loader() const { return _loader; }
+	/// @return the scene revision captured by the last save
+	quint64 revision() const { return _revision; }
+
+signals:
+	/**
+	 * @param ok     true if the document was replaced
+	 * @param error  a description of the failure
+	 */
+	void finished(bool ok, const QString &error);
+
+private slots:
+	void writeFinished();
+};
+
+}  // namespace dbuilder
@@ -0,0 +1,311 @@
+/**
+ * @file   JournalRecorder.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_JournalRecorder.cpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QUndoStack>
+#include <QtConcurrentRun>
+#include <algorithm>
+#include <sstream>
+#include "DiagramScene.hpp"
+#include "DiagramItem.hpp"
+#include "DiagramItemModel.hpp"
+#include "DiagramIO/DiagramLoader.hpp"
+#include "DiagramIO/InfoWriter.hpp"
+#include "Main/DocumentSaver.hpp"
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+
+const qint64 JournalRecorder::MinCompactionSize;
+
+JournalRecorder::JournalRecorder(DiagramScene *scene, QObject *parent)
+: QObject(parent)
+, _scene(scene)
+, _loader(nullptr)
+, _recording(false)
+, _index(0)
+, _flushQueued(false)
+, _compacting(false)
+{
+	connect(_scene, SIGNAL(diagramItemAdded(DiagramItem *)), this, SLOT(diagramItemChanged(DiagramItem *)));
+	connect(_scene, SIGNAL(diagramItemRemoved(DiagramItem *)), this, SLOT(diagramItemChanged(DiagramItem *)));
+	// a dependent may store geometry derived from what it follows
+	connect(_scene, SIGNAL(diagramItemFollowed(DiagramItem *)), this, SLOT(diagramItemChanged(DiagramItem *)));
+	connect(_scene, SIGNAL(diagramItemMovedBy(DiagramItem *)), this, SLOT(diagramItemMovedBy(DiagramItem *)));
+	connect(&_scene->undoStack(), SIGNAL(indexChanged(int)), this, SLOT(undoIndexChanged(int)));
+	connect(&_compaction, SIGNAL(finished()), this, SLOT(compactionFinished()));
+}
+
+void JournalRecorder::watch(DiagramItem *item)
+{
+	connect(item->model(), SIGNAL(changed()), this, SLOT(modelChanged()), Qt::UniqueConnection);
+}
+
+JournalRecorder::~JournalRecorder()
+{
+	stop();
+}
+
+bool JournalRecorder::start(const QString &documentPath, const DiagramLoader *loader, bool keepUnsaved)
+{
+	stop();
+	// updates left over from loading are part of the document already
+	_scene->flushDependencyUpdates();
+	if(!_journal.open(documentPath, keepUnsaved))
+	{
+		return false;
+	}
+
+	for(auto item : _scene->diagramItems())
+	{
+		watch(item);
+	}
+
+	_loader = loader;
+	_recording = true;
+	_index = _scene->undoStack().index();
+	return true;
+}
+
+void JournalRecorder::stop()
+{
+	finishCompaction();
+	_journal.close();
+	_recording = false;
+	_loader = nullptr;
+	_changed.clear();
+	_moved.clear();
+	_pendingSteps.clear();
+	_steps.clear();
+	_sinceSnapshot.clear();
+}
+
+bool JournalRecorder::recording(const QString &documentPath, const DiagramLoader *loader) const
+{
+	return _recording && _loader == loader && _journal.documentPath() == documentPath;
+}
+
+void JournalRecorder::diagramItemChanged(DiagramItem *item)
+{
+	if(!_recording) return;
+	watch(item);
+	_changed.insert(item->model()->uuid());
+	scheduleFlush();
+}
+
+void JournalRecorder::modelChanged()
+{
+	if(!_recording) return;
+	if(auto model = qobject_cast<DiagramItemModel *>(sender()))
+	{
+		_changed.insert(model->uuid());
+		scheduleFlush();
+	}
+}
+
+void JournalRecorder::diagramItemMovedBy(DiagramItem *item)
+{
+	if(!_recording) return;
+	_moved.insert(item->model()->uuid());
+}
+
+void JournalRecorder::undoIndexChanged(int index)
+{
+	if(!_recording) return;
+
+	auto &stack = _scene->undoStack();
+	// a merge into the current command leaves the index where it was
+	int from = std::min(index, _index), to = std::max(index, _index);
+	if(from == to)
+	{
+		from = std::max(0, index - 1);
+	}
+
+	for(int i = from; i < to && i < stack.count(); ++i)
+	{
+		if(i >= int(_steps.size()))
+		{
+			_steps.resize(i + 1, Step{nullptr, QSet<QUuid>()});
+		}
+
+		auto &step = _steps[i];
+		if(step.command != stack.command(i))
+		{
+			// pushed just now; model changes are recorded as they happen,
+			// but the Z order reaches the model only when it is captured
+			step.command = stack.command(i);
+			step.items.clear();
+			for(auto item : _scene->selectedDiagramItems())
+			{
+				step.items.insert(item->model()->uuid());
+			}
+		}
+
+		_changed.unite(step.items);
+		_pendingSteps << i;
+	}
+
+	if(int(_steps.size()) > stack.count())
+	{
+		_steps.resize(stack.count());
+	}
+	_index = index;
+	scheduleFlush();
+}
+
+void JournalRecorder::scheduleFlush()
+{
+	if(!_flushQueued)
+	{
+		_flushQueued = true;
+		// queued behind the scene's dependency updates for the same event
+		QMetaObject::invokeMethod(this, "flush", Qt::QueuedConnection);
+	}
+}
+
+bool JournalRecorder::written(bool ok)
+{
+	if(ok && _compacting)
+	{
+		_sinceSnapshot += _journal.lastFrame();
+	}
+	return ok;
+}
+
+void JournalRecorder::flush()
+{
+	_flushQueued = false;
+	if(!_recording) return;
+
+	for(int i : _pendingSteps)
+	{
+		if(i < int(_steps.size()))
+		{
+			_steps[i].items.unite(_changed);
+		}
+	}
+	_pendingSteps.clear();
+
+	// capturing a model may change it again, which is recorded for the next flush
+	QSet<QUuid> changed, moved;
+	changed.swap(_changed);
+	moved.swap(_moved);
+
+	bool ok = true;
+	std::ostringstream os;
+	for(const auto &uuid : changed)
+	{
+		auto item = _scene->item(uuid);
+		if(!item || item->scene() != _scene)
+		{
+			ok = written(_journal.remove(uuid)) && ok;
+			continue;
+		}
+
+		os.str(std::string());
+		InfoWriter writer(os);
+		item->model()->snapshot().save(writer);
+		ok = written(_journal.put(os.str())) && ok;
+	}
+
+	for(const auto &uuid : moved)
+	{
+		if(changed.contains(uuid)) continue;
+
+		auto item = _scene->item(uuid);
+		if(item && item->scene() == _scene)
+		{
+			ok = written(_journal.move(uuid, item->scenePos(), item->rotation())) && ok;
+		}
+	}
+
+	if(!ok)
+	{
+		// the next save rewrites the document instead
+		DBError("Journal of ", _journal.documentPath().toStdString(), " is incomplete; stopped journaling");
+		stop();
+	}
+}
+
+bool JournalRecorder::commit()
+{
+	if(!_recording) return false;
+
+	// text edited in place reaches the model only when it is asked for
+	for(auto item : _scene->diagramItems())
+	{
+		if(item->editorOpen())
+		{
+			item->model()->requestUpdateModel();
+		}
+	}
+	flush();
+
+	if(!_recording || !written(_journal.commit()))
+	{
+		return false;
+	}
+
+	const qint64 documentSize = QFileInfo(_journal.documentPath()).size();
+	if(!_compacting && _journal.size() > std::max(MinCompactionSize, documentSize / 4))
+	{
+		compact();
+	}
+	return true;
+}
+
+void JournalRecorder::discardUnsaved()
+{
+	if(_recording)
+	{
+		finishCompaction();
+		_changed.clear();
+		_moved.clear();
+		_journal.discardUnsaved();
+	}
+}
+
+void JournalRecorder::compact()
+{
+	// called right after a commit, so the scene is exactly what was saved
+	auto snapshot = DocumentSnapshot::take(_scene);
+
+	DBInfo("Compacting ", _journal.size(), " byte journal of ", _journal.documentPath().toStdString());
+	_sinceSnapshot.clear();
+	_compacting = true;
+	_compaction.setFuture(QtConcurrent::run(&writeDocument, _journal.documentPath(), _loader, snapshot));
+}
+
+void JournalRecorder::finishCompaction()
+{
+	_compaction.waitForFinished();
+	compactionFinished();
+}
+
+void JournalRecorder::compactionFinished()
+{
+	if(!_compacting) return;
+	_compacting = false;
+
+	std::string since;
+	since.swap(_sinceSnapshot);
+	if(!_compaction.result().isNull())
+	{
+		return;
+	}
+
+	// the snapshot holds everything before the frames written since it
+	if(!_journal.reset() || !_journal.appendRaw(since))
+	{
+		DBError("Failed to restart journal of ", _journal.documentPath().toStdString());
+		stop();
+	}
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,121 @@
+#pragma once
+/**
+ * @file   JournalRecorder.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QObject>
+#include <QSet>
+#include <QUuid>
+#include <QString>
+#include <QFutureWatcher>
+#include <string>
+#include <vector>
+#include "DiagramIO/DocumentJournal.hpp"
+#include "CoreForward.hpp"
+
+class QUndoCommand;
+
+namespace dbuilder {
+
+/**
+ * Records the changes made to a scene in the DocumentJournal of its
+ * document, so that saving only has to append what changed.
+ *
+ * Each item's model reports its own changes, so edits are recorded whatever
+ * made them; the scene adds the items it reports as added, removed, moved
+ * or following a dependency. Items with an editor open are asked to update
+ * their models before a commit. Undo and redo move models back through the
+ * same signals, but the Z order reaches a model only when it is captured, so
+ * the items selected when a command is first pushed are remembered with the
+ * items it changed and journaled again whenever it is undone or redone.
+ * Items that only moved get Move frames; everything else is written whole.
+ * Changes are written once the event that made them has finished, after the
+ * scene's dependency updates.
+ *
+ * When a commit leaves the journal larger than MinCompactionSize and a
+ * quarter of the document, the document is rewritten on a worker thread
+ * and the journal starts over.
+ */
+class JournalRecorder: public QObject
+{
+	Q_OBJECT
+
+	struct Step
+	{
+		const QUndoCommand *command;
+		QSet<QUuid> items;
+	};
+
+	DiagramScene *_scene;
+	const DiagramLoader *_loader;
+	DocumentJournal _journal;
+	bool _recording;
+
+	// since the last flush
+	QSet<QUuid> _changed, _moved;
+	QList<int> _pendingSteps;
+	std::vector<Step> _steps;
+	int _index;
+	bool _flushQueued;
+
+	QFutureWatcher<QString> _compaction;
+	bool _compacting;
+	// frames written while the compaction snapshot is being written
+	std::string _sinceSnapshot;
+
+	void scheduleFlush();
+	bool written(bool ok);
+	void compact();
+	void finishCompaction();
+	void watch(DiagramItem *item);
+
+public:
+	static const qint64 MinCompactionSize = 4 << 20;
+
+	JournalRecorder(DiagramScene *scene, QObject *parent=nullptr);
+	virtual ~JournalRecorder();
+
+	/**
+	 * Reads the journal of documentPath before the document is opened.
+	 * @see DocumentJournal::scan()
+	 */
+	DocumentJournal &journal() { return _journal; }
+
+	/**
+	 * Starts recording changes to the scene, which holds the document saved
+	 * at documentPath with loader. Keeps a journal read by journal().scan(),
+	 * with its unsaved frames if keepUnsaved is set.
+	 */
+	bool start(const QString &documentPath, const DiagramLoader *loader, bool keepUnsaved=false);
+	void stop();
+
+	/**
+	 * @return true if changes are being recorded for documentPath, saved with loader
+	 */
+	bool recording(const QString &documentPath, const DiagramLoader *loader) const;
+
+	/**
+	 * Writes outstanding changes and marks them saved.
+	 */
+	bool commit();
+
+	/**
+	 * Forgets the changes made since the last commit, when they are discarded.
+	 */
+	void discardUnsaved();
+
+public slots:
+	void flush();
+
+private slots:
+	void diagramItemChanged(DiagramItem *item);
+	void modelChanged();
+	void diagramItemMovedBy(DiagramItem *item);
+	void undoIndexChanged(int index);
+	void compactionFinished();
+};
+
+}  // namespace dbuilder
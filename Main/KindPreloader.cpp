@@ -0,0 +1,117 @@
+/**
+ * @file   KindPreloader.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "moc_KindPreloader.cpp"
+#include <QFile>
+#include <QtConcurrentMap>
+#include <QThreadPool>
+#include <exception>
+#include "ComponentRegistry.hpp"
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+
+/// Runs on the thread pool; touches nothing shared.
+class KindPreloader::Load
+{
+	IconCache *_cache;
+public:
+	typedef KindPreloader::Loaded result_type;
+
+	Load(IconCache *cache)
+	: _cache(cache)
+	{ }
+
+	Loaded operator ()(const SpecSource &source) const
+	{
+		Loaded result;
+		try
+		{
+			result.spec = source();
+		}
+		catch(const std::exception &exc)
+		{
+			result.error = QString::fromLocal8Bit(exc.what());
+			return result;
+		}
+
+		QByteArray document;
+		if(result.spec.svgFile.isNull())
+		{
+			document = result.spec.svgData.toUtf8();
+		}
+		else
+		{
+			QFile file(result.spec.svgFile);
+			if(!file.open(QIODevice::ReadOnly))
+			{
+				result.error = file.errorString();
+				return result;
+			}
+			document = file.readAll();
+		}
+
+		result.svg = SVGComponent::preprocess(document, _cache);
+		return result;
+	}
+};
+
+KindPreloader::KindPreloader(ComponentRegistry *registry, const std::vector<SpecSource> &sources, IconCache *cache)
+: QObject(registry)
+, _registry(registry)
+, _sources(sources)
+{
+	_elapsed.start();
+	connect(&_watcher, SIGNAL(finished()), this, SLOT(loaded()));
+	_watcher.setFuture(QtConcurrent::mapped(_sources, Load(cache)));
+}
+
+KindPreloader::~KindPreloader()
+{
+	_watcher.cancel();
+	_watcher.waitForFinished();
+}
+
+void KindPreloader::loaded()
+{
+	deleteLater();
+	if(_watcher.isCanceled()) return;
+
+	const qint64 preprocessMs = _elapsed.restart();
+	int created = 0;
+	for(int i = 0, n = _sources.size(); i < n; ++i)
+	{
+		const auto loaded = _watcher.resultAt(i);
+		if(!loaded.error.isNull())
+		{
+			// reported again if the kind is ever used
+			DBDebug("Not preloading a kind: ", loaded.error);
+			continue;
+		}
+
+		auto kind = loaded.spec.createKind(_registry);
+		if(auto svgKind = qobject_cast<SVGComponent *>(kind))
+		{
+			svgKind->setPreprocessed(loaded.svg);
+		}
+
+		if(_registry->provideKind(kind))
+		{
+			++created;
+		}
+		else
+		{
+			delete kind;
+		}
+	}
+
+	DBInfo("Preloaded ", created, " kinds: ", preprocessMs, " ms on ",
+	       QThreadPool::globalInstance()->maxThreadCount(), " threads, then ",
+	       _elapsed.elapsed(), " ms to register them");
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,66 @@
+#pragma once
+/**
+ * @file   KindPreloader.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <vector>
+#include <functional>
+#include "DiagramIO/ComponentFile.hpp"
+#include "Components/SVGComponent.hpp"
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+
+class IconCache;
+class ComponentRegistry;
+
+/**
+ * Creates the SVG kinds of a registry before they are first used.
+ *
+ * Reading each component's spec, the fixed-width-stroke rewrite and validation of
+ * its SVG, and rendering its icon into a QImage run on the global thread
+ * pool. When all of them are done, the kinds and their QIcons are made on
+ * the GUI thread and registered in the order given. Kinds that were created on
+ * demand in the meantime are kept.
+ *
+ * Made a child of the registry; it deletes itself when done.
+ */
+class KindPreloader: public QObject
+{
+	Q_OBJECT
+
+public:
+	/// Reads the spec of one kind; called on the thread pool.
+	typedef std::function<ComponentSpec()> SpecSource;
+
+private:
+	struct Loaded
+	{
+		ComponentSpec spec;
+		PreprocessedSVG svg;
+		/// why the component could not be read, or a null string
+		QString error;
+	};
+
+	class Load;
+
+	ComponentRegistry *_registry;
+	std::vector<SpecSource> _sources;
+	QFutureWatcher<Loaded> _watcher;
+	QElapsedTimer _elapsed;
+
+public:
+	KindPreloader(ComponentRegistry *registry, const std::vector<SpecSource> &sources, IconCache *cache);
+	virtual ~KindPreloader();
+
+private slots:
+	void loaded();
+};
+
+}  // namespace dbuilder
@@ -14,11 +14,14 @@
 
 #include "Clipboard.hpp"
 #include "Commands/DeleteItemCommand.hpp"
+#include "Commands/DropDependencyCommand.hpp"
 #include "Commands/InsertItemCommand.hpp"
 #include "Commands/InsertItemsCommand.hpp"
 #include "Commands/RotateItemCommand.hpp"
 #include "DiagramContext.hpp"
 #include "DiagramIO/InfoDiagramLoader.hpp"
+#include "DiagramIO/BinaryDiagramLoader.hpp"
+#include "DiagramIO/DocumentChecker.hpp"
 #include "DiagramItem.hpp"
 #include "DiagramComponent.hpp"
 #include "DiagramItemModel.hpp"
@@ -35,9 +38,66 @@
 #include "PreferencesDialog.hpp"
 #include <QTextCursor>
 #include "DiagramIO/ComponentFile.hpp"
+#include "Main/DocumentOpener.hpp"
+#include "Main/JournalRecorder.hpp"
+#include "Main/DocumentSaver.hpp"
+#include "Main/SceneExport.hpp"
 #include "ExportComponentOptions.hpp"
 namespace dbuilder {
 
+namespace {
+
+/**
+ * The icon of a kind that may not be loaded yet. The kind is loaded the
+ * first time the icon is drawn, so building the toolbox does not load every
+ * component.
+ */
+class KindIconEngine: public QIconEngineV2
+{
+	QPointer<DiagramContext> _ctx;
+	QString _name;
+
+	QIcon kindIcon() const
+	{
+		if(_ctx)
+		{
+			if(auto kind = _ctx->findKind(_name))
+			{
+				return kind->icon();
+			}
+		}
+		return QIcon();
+	}
+
+public:
+	KindIconEngine(DiagramContext *ctx, const QString &name)
+	: _ctx(ctx)
+	, _name(name)
+	{ }
+
+	virtual void paint(QPainter *painter, const QRect &rect, QIcon::Mode mode, QIcon::State state)
+	{
+		kindIcon().paint(painter, rect, Qt::AlignCenter, mode, state);
+	}
+
+	virtual QPixmap pixmap(const QSize &size, QIcon::Mode mode, QIcon::State state)
+	{
+		return kindIcon().pixmap(size, mode, state);
+	}
+
+	virtual QSize actualSize(const QSize &size, QIcon::Mode, QIcon::State)
+	{
+		return size;
+	}
+
+	virtual QIconEngineV2 *clone() const
+	{
+		return new KindIconEngine(_ctx.data(), _name);
+	}
+};
+
+}  // namespace
+
 void MainWindow::populateToolDock(const QList<QAction*>& contextActions)
 {
 	auto toolDockWidget = new Toolbox(this);
@@ -54,14 +114,26 @@ MainWindow::MainWindow(Application *app)
 , _prefsDialog(new PreferencesDialog(this))
 , _propWidget(new GenericPropertyWidget(this))
 {
-	_ctx = app->createContext();
+	_ctx = app->createContext(true);
 	_ctx->setParent(this);
+	// the clipboard always uses INFO, and so do new documents; binary is
+	// chosen in Save As
 	_loader = new InfoDiagramLoader(_ctx, this);
+	_compressedLoader = new InfoDiagramLoader(_ctx, this);
+	_compressedLoader->setCompressed(true);
+	_binaryLoader = new BinaryDiagramLoader(_ctx, this);
+	_documentFormat = DocumentFormat::Info;
+	_opener = nullptr;
 
 	_ui->setupUi(this);
 	_ui->propDock->setWidget(_propWidget);
 
 	_scene = new DiagramScene(_ctx, this);
+	_journal = new JournalRecorder(_scene, this);
+	_recoverUnsaved = false;
+	_saver = new DocumentSaver(_scene, this);
+	_autosaving = false;
+	_autosaveTimer = new QTimer(this);
 	_view = new DiagramView(this);
 	_view->setScene(_scene);
 
@@ -81,6 +153,10 @@ MainWindow::MainWindow(Application *app)
 	connect(_scene, SIGNAL(modifiedChanged(bool)), this, SLOT(sceneModifiedChanged()));
 	connect(_scene, SIGNAL(selectionChanged()), this, SLOT(sceneSelectionChanged()));
 	connect(_ui->actionDrag_Lock, SIGNAL(triggered(bool)), _scene, SLOT(setDragLock(bool)));
+	connect(_saver, SIGNAL(finished(bool, QString)), this, SLOT(documentSaved(bool, QString)));
+	connect(_autosaveTimer, SIGNAL(timeout()), this, SLOT(autosave()));
+	connect(_app, SIGNAL(settingsChanged()), this, SLOT(updateAutosaveInterval()));
+	updateAutosaveInterval();
 
 	QAction *toggleViewAction = _ui->propDock->toggleViewAction();
 	toggleViewAction->setText(tr("Inspector"));
@@ -100,18 +176,22 @@ MainWindow::MainWindow(Application *app)
 
 MainWindow::~MainWindow()
 {
+	// the opener must stop before the scene it fills is destroyed
+	delete _opener;
 }
 
 QList<QAction*> MainWindow::createInsertItemActions()
 {
 	QList<QAction *> actions;
-	for(auto kind : _ctx->kinds())
+	for(const auto &name : _ctx->kindNames())
 	{
-		if(!kind->hidden())
+		// kinds not loaded yet come from component files, which are never hidden
+		auto kind = _ctx->createdKinds().value(name, nullptr);
+		if(!kind || !kind->hidden())
 		{
 			auto action = new QAction(this);
-			action->setText(kind->name());
-			action->setIcon(kind->icon());
+			action->setText(name);
+			action->setIcon(kind? kind->icon() : QIcon(new KindIconEngine(_ctx, name)));
 			actions << action;
 			connect(action, SIGNAL(triggered()), this, SLOT(insertItemTriggered()));
 		}
@@ -167,6 +247,8 @@ void MainWindow::on_actionNew_triggered()
 
 bool MainWindow::displaySaveChangesPrompt()
 {
+	// a save in progress may be all that was needed
+	_saver->finish();
 	if(_scene->clean()) return true;
 
 	QMessageBox m{this};
@@ -180,10 +262,11 @@ bool MainWindow::displaySaveChangesPrompt()
 	int r = m.exec();
 	if(r == QMessageBox::Save)
 	{
-		return save();
+		return save() && _saver->finish();
 	}
 	else if(r == QMessageBox::Discard)
 	{
+		_journal->discardUnsaved();
 		return true;
 	}
 	else
@@ -199,9 +282,15 @@ bool MainWindow::makeNew()
 		return false;
 	}
 
+	// stops an open in progress
+	delete _opener;
+	_opener = nullptr;
+	_journal->stop();
+
 	_scene->clearDiagram();
 	_scene->undoStack().clear();
 	setCurrentFilePath({});
+	_documentFormat = DocumentFormat::Info;
 	return true;
 }
 
@@ -220,8 +309,24 @@ bool MainWindow::save()
 
 bool MainWindow::saveAs()
 {
+	const QString binaryFilter = tr("DiagramBuilder Document (*.dbuilder)");
+	const QString infoFilter = tr("DiagramBuilder Text Document (*.dbuilder)");
+	const QString compressedFilter = tr("DiagramBuilder Compressed Text Document (*.dbuilder)");
+
 	QFileDialog d{this};
-	d.setFilter("*.dbuilder");
+	d.setNameFilters({infoFilter, compressedFilter, binaryFilter});
+	switch(_documentFormat)
+	{
+	case DocumentFormat::Binary:
+		d.selectNameFilter(binaryFilter);
+		break;
+	case DocumentFormat::CompressedInfo:
+		d.selectNameFilter(compressedFilter);
+		break;
+	default:
+		d.selectNameFilter(infoFilter);
+	}
+	d.setDefaultSuffix("dbuilder");
 	d.setWindowModality(Qt::ApplicationModal);
 	d.setAcceptMode(QFileDialog::AcceptSave);
 	if(d.exec())
@@ -233,6 +338,12 @@ bool MainWindow::saveAs()
 		}
 		else
 		{
+			const auto filter = d.selectedNameFilter();
+			_documentFormat = filter == binaryFilter?
+				  DocumentFormat::Binary
+				: filter == compressedFilter?
+				  DocumentFormat::CompressedInfo
+				: DocumentFormat::Info;
 			return saveFile(fn);
 		}
 	}
@@ -243,20 +354,83 @@ bool MainWindow::saveAs()
 }
 
 
-bool MainWindow::saveFile(QString where)
+const DiagramLoader *MainWindow::loaderFor(DocumentFormat format) const
 {
-	std::ofstream os(where.toStdString());
-	if(!os)
+	switch(format)
 	{
-		DBError("Failed to open output file ", where.toStdString());
-		return false;
+	case DocumentFormat::Binary:
+		return _binaryLoader;
+	case DocumentFormat::CompressedInfo:
+		return _compressedLoader;
+	default:
+		return _loader;
+	}
+}
+
+bool MainWindow::saveFile(QString where, bool autosave)
+{
+	const auto loader = loaderFor(_documentFormat);
+	// the document and its journal together are what was saved
+	if(_journal->recording(where, loader) && _journal->commit())
+	{
+		_scene->setClean(true);
+		return true;
 	}
-	_loader->save(os, _scene->diagramItems().values());
-	setCurrentFilePath(where);
-	_scene->setClean(true);
+
+	// restarted once the document is rewritten
+	_journal->stop();
+	_autosaving = autosave;
+	_saver->save(where, loader);
 	return true;
 }
 
+void MainWindow::documentSaved(bool ok, const QString &error)
+{
+	if(!ok)
+	{
+		if(!_autosaving)
+		{
+			QMessageBox::critical(this, tr("Save Failed"),
+			                      tr("The document could not be saved.\n\n%1").arg(error));
+		}
+		return;
+	}
+
+	setCurrentFilePath(_saver->path());
+	// changes made while the snapshot was written are not in the file, and
+	// the journal cannot hold them; the next save rewrites the document
+	if(_scene->revision() == _saver->revision())
+	{
+		_scene->setClean(true);
+		_journal->start(_saver->path(), _saver->loader());
+	}
+}
+
+void MainWindow::autosave()
+{
+	// untitled documents are left to the save prompt
+	if(_scene->clean() || windowFilePath().isEmpty() || _opener || _saver->saving())
+	{
+		return;
+	}
+
+	DBInfo("Autosaving ", windowFilePath().toStdString());
+	saveFile(windowFilePath(), true);
+}
+
+void MainWindow::updateAutosaveInterval()
+{
+	const int minutes = _app->autosaveInterval();
+	if(minutes > 0)
+	{
+		_autosaveTimer->start(minutes * 60 * 1000);
+	}
+	else
+	{
+		_autosaveTimer->stop();
+	}
+}
+
 void MainWindow::on_actionOpen_triggered()
 {
 	auto fname = QFileDialog::getOpenFileName(this, {}, {}, "*.dbuilder");
@@ -269,20 +443,60 @@ void MainWindow::on_actionOpen_triggered()
 bool MainWindow::openFile(QString where)
 {
 	makeNew();
-	std::ifstream is(where.toStdString());
-	if(!is)
+
+	JournalReplay replay;
+	auto &journal = _journal->journal();
+	_recoverUnsaved = false;
+	if(journal.scan(where))
 	{
-		DBError("Failed to open input file ", where.toStdString());
-		return false;
+		if(journal.hasUnsavedChanges())
+		{
+			_recoverUnsaved = QMessageBox::question(this, tr("Recover Changes"),
+				tr("%1 was not closed properly and has unsaved changes.\n\n"
+				   "Do you want to recover them?").arg(QFileInfo(where).fileName()),
+				QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) == QMessageBox::Yes;
+		}
+		journal.replay(replay, _recoverUnsaved);
+	}
+	else if(!journal.stalePath().isNull())
+	{
+		QMessageBox::warning(this, tr("Journal Does Not Match"),
+			tr("%1 was changed outside of DiagramBuilder since it was last saved, so its "
+			   "journal of saved changes no longer applies and they are not shown.\n\n"
+			   "The journal will be kept as %2.").arg(QFileInfo(where).fileName(), journal.stalePath()));
 	}
 
-	auto loaded = _loader->load(is, _scene);
-	_scene->addDiagramItemsInOrder(loaded);
-	this->setCurrentFilePath(where);
-	_scene->setClean(true);
+	_opener = new DocumentOpener(_scene, this, this);
+	connect(_opener, SIGNAL(finished(bool, QString)), this, SLOT(documentOpened(bool, QString)));
+	_opener->open(where, std::move(replay));
 	return true;
 }
 
+void MainWindow::documentOpened(bool ok, const QString &error)
+{
+	auto opener = _opener;
+	_opener = nullptr;
+	opener->deleteLater();
+
+	if(ok)
+	{
+		_documentFormat = opener->format();
+		setCurrentFilePath(opener->path());
+		_journal->start(opener->path(), loaderFor(_documentFormat), _recoverUnsaved);
+		// recovered changes still have to be saved
+		_scene->setClean(!_recoverUnsaved);
+	}
+	else
+	{
+		_journal->stop();
+		if(!error.isEmpty())
+		{
+			QMessageBox::critical(this, tr("Open Failed"),
+			                      tr("The document could not be read.\n\n%1").arg(error));
+		}
+	}
+}
+
 void MainWindow::on_actionSave_triggered()
 {
 	save();
@@ -409,14 +623,12 @@ void MainWindow::on_actionInsert_Item_triggered()
 
 void MainWindow::exportToSVG(QString where)
 {
-	QSvgGenerator gen;
-	gen.setFileName(where);
-	gen.setSize(_scene->sceneRect().size().toSize());
-	_scene->setPrintMode(true);
-	DBScopeExit([&](){ _scene->setPrintMode(false); });
-
-	QPainter painter(&gen);
-	_scene->render(&painter);
+	auto error = exportScene(_scene, where, ExportFormat::Svg);
+	if(!error.isNull())
+	{
+		QMessageBox::critical(this, tr("Export Failed"),
+		                      tr("The drawing could not be exported.\n\n%1").arg(error));
+	}
 }
 
 void MainWindow::on_actionExport_as_SVG_triggered()
@@ -634,6 +846,73 @@ void MainWindow::on_actionExport_as_Component_triggered()
 
 }
 
+void MainWindow::on_actionCheck_Document_triggered()
+{
+	// the snapshot lists the items in the order of diagramItems()
+	auto snapshot = DocumentSnapshot::take(_scene);
+	auto items = _scene->diagramItems();
+
+	std::vector<DiagramItemRecord> records;
+	records.reserve(snapshot->items.size());
+	for(const auto &item : snapshot->items)
+	{
+		records.push_back(recordFromSnapshot(item));
+	}
+	const auto report = checkDocument(records, _ctx);
+
+	if(report.clean())
+	{
+		QMessageBox::information(this, tr("Check Document"),
+		                         tr("No problems were found in %1 items.").arg(report.itemCount));
+		return;
+	}
+
+	const size_t MaxDetails = 1000;
+	QString details;
+	for(size_t i = 0; i < report.issues.size() && i < MaxDetails; ++i)
+	{
+		details += QString::fromStdString(report.issues[i].describe()) + "\n";
+	}
+	if(report.issues.size() > MaxDetails)
+	{
+		details += tr("...and %1 more").arg(report.issues.size() - MaxDetails);
+	}
+
+	QMessageBox m{this};
+	m.setWindowFlags(Qt::Sheet);
+	m.setIcon(QMessageBox::Warning);
+	m.setText(tr("%1 problems were found in the document.").arg(report.issues.size()));
+	m.setInformativeText(tr("Repairing removes %1 items and drops the other broken references. "
+	                        "It can be undone.").arg(report.removedCount()));
+	m.setDetailedText(details);
+	auto repairButton = m.addButton(tr("Repair"), QMessageBox::AcceptRole);
+	m.addButton(QMessageBox::Cancel);
+	m.exec();
+	if(m.clickedButton() != repairButton) return;
+
+	std::vector<bool> removed(items.size(), false);
+	for(const auto &issue : report.issues)
+	{
+		if(issue.repair == DocumentIssue::RemoveItem) removed[issue.index] = true;
+	}
+
+	// dependencies are dropped first, so that deleting an item takes only
+	// the connections to it along
+	auto rootCmd = new QUndoCommand("repair document");
+	for(const auto &issue : report.issues)
+	{
+		if(issue.repair == DocumentIssue::DropDependency && !removed[issue.index])
+		{
+			new DropDependencyCommand(_scene, items[issue.index], issue.reference, rootCmd);
+		}
+	}
+	for(size_t i = 0; i < removed.size(); ++i)
+	{
+		if(removed[i]) new DeleteItemCommand(_scene, items[i], rootCmd);
+	}
+	_scene->undoStack().push(rootCmd);
+}
+
 void MainWindow::on_actionSend_to_Back_triggered()
 {
 	_scene->sendSelection(_scene->ToBack);
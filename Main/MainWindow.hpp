@@ -11,8 +11,10 @@
 #include "DiagramScene.hpp"
 #include "CoreForward.hpp"
 #include "GenericPropertyWidget.hpp"
+#include "DiagramIO/DocumentFormat.hpp"
 
 class QMdiArea;
+class QTimer;
 
 namespace Ui {
 
@@ -24,6 +26,11 @@ namespace dbuilder {
 
 class Application;
 class PreferencesDialog;
+class BinaryDiagramLoader;
+class InfoDiagramLoader;
+class DocumentOpener;
+class JournalRecorder;
+class DocumentSaver;
 
 class MainWindow: public QMainWindow
 {
@@ -34,7 +41,16 @@ class MainWindow: public QMainWindow
 	QMenu *_contextMenu;
 	DiagramView *_view;
 	DiagramScene *_scene;
-	DiagramLoader *_loader;
+	InfoDiagramLoader *_loader;
+	InfoDiagramLoader *_compressedLoader;
+	BinaryDiagramLoader *_binaryLoader;
+	DocumentFormat _documentFormat;
+	DocumentOpener *_opener;
+	JournalRecorder *_journal;
+	bool _recoverUnsaved;
+	DocumentSaver *_saver;
+	bool _autosaving;
+	QTimer *_autosaveTimer;
 	PreferencesDialog *_prefsDialog;
 	GenericPropertyWidget *_propWidget;
 public:
@@ -47,7 +63,8 @@ private:
 	bool makeNew();
 	bool save();
 	bool saveAs();
-	bool saveFile(QString where);
+	bool saveFile(QString where, bool autosave=false);
+	const DiagramLoader *loaderFor(DocumentFormat format) const;
 	void setCurrentFilePath(const QString &filename);
 	void rotateSelectedItems(qreal angle);
 	void populateToolDock(const QList<QAction*>& contextActions);
@@ -64,6 +81,10 @@ protected:
 	void closeEvent(QCloseEvent *event);
 private slots:
 	void deferredInit();
+	void documentOpened(bool ok, const QString &error);
+	void documentSaved(bool ok, const QString &error);
+	void autosave();
+	void updateAutosaveInterval();
 	void insertItemTriggered();
 	void contextMenu(QGraphicsSceneContextMenuEvent *);
 	void sceneModifiedChanged();
@@ -98,6 +119,7 @@ private slots:
 	void on_actionItalic_triggered();
 	void on_actionUnderline_triggered();
 	void on_actionExport_as_Component_triggered();
+	void on_actionCheck_Document_triggered();
 	void on_actionSend_to_Back_triggered();
 	void on_actionSend_to_Front_triggered();
 	void on_actionSend_Backward_triggered();
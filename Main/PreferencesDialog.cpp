@@ -43,6 +43,7 @@ void PreferencesDialog::updateView()
 	auto app = Application::instance();
 
 	_ui->cmbLoggingLevel->setCurrentIndex(int(log::level()));
+	_ui->spnAutosaveInterval->setValue(app->autosaveInterval());
 
 	setButtonColor(_ui->btnConnectionPointColor, app->portOutlineColor());
 	_libraries = app->libraries();
@@ -55,6 +56,7 @@ void PreferencesDialog::updateModel()
 	auto app = Application::instance();
 
 	log::setLevel(log::Level(_ui->cmbLoggingLevel->currentIndex()));
+	app->setAutosaveInterval(_ui->spnAutosaveInterval->value());
 
 	app->setPortOutlineColor(buttonColor(_ui->btnConnectionPointColor));
 	app->setLibraries(_libraries);
@@ -0,0 +1,113 @@
+/**
+ * @file   SceneExport.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "SceneExport.hpp"
+#include <QFile>
+#include <QImage>
+#include <QPainter>
+#include <QPrinter>
+#include <QSvgGenerator>
+#include <QObject>
+#include "DiagramScene.hpp"
+#include "Util/ScopeExit.hpp"
+
+namespace dbuilder {
+
+boost::optional<ExportFormat> exportFormatForName(const QString &name)
+{
+	const auto lower = name.toLower();
+	if(lower == "svg") return ExportFormat::Svg;
+	if(lower == "png") return ExportFormat::Png;
+	if(lower == "pdf") return ExportFormat::Pdf;
+	return boost::none;
+}
+
+QString exportFormatSuffix(ExportFormat format)
+{
+	switch(format)
+	{
+	case ExportFormat::Png:
+		return "png";
+	case ExportFormat::Pdf:
+		return "pdf";
+	default:
+		return "svg";
+	}
+}
+
+QString exportScene(DiagramScene *scene, const QString &path, ExportFormat format, qreal scale)
+{
+	const auto rect = scene->sceneRect();
+	scene->setPrintMode(true);
+	DBScopeExit([&](){ scene->setPrintMode(false); });
+
+	switch(format)
+	{
+	case ExportFormat::Svg:
+	{
+		QFile file(path);
+		if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			return file.errorString();
+		}
+
+		QSvgGenerator gen;
+		gen.setOutputDevice(&file);
+		gen.setSize(rect.size().toSize());
+		{
+			QPainter painter(&gen);
+			scene->render(&painter);
+		}
+		if(file.error() != QFile::NoError)
+		{
+			return file.errorString();
+		}
+		break;
+	}
+	case ExportFormat::Png:
+	{
+		QImage image((rect.size() * scale).toSize(), QImage::Format_ARGB32_Premultiplied);
+		if(image.isNull())
+		{
+			return QObject::tr("The drawing is too large to render.");
+		}
+		image.fill(Qt::white);
+		{
+			QPainter painter(&image);
+			painter.setRenderHint(QPainter::Antialiasing);
+			painter.setRenderHint(QPainter::TextAntialiasing);
+			scene->render(&painter);
+		}
+		if(!image.save(path, "PNG"))
+		{
+			return QObject::tr("The image could not be written.");
+		}
+		break;
+	}
+	case ExportFormat::Pdf:
+	{
+		QPrinter printer(QPrinter::HighResolution);
+		printer.setOutputFormat(QPrinter::PdfFormat);
+		printer.setOutputFileName(path);
+		printer.setFullPage(true);
+		printer.setPaperSize(rect.size(), QPrinter::Point);
+
+		QPainter painter;
+		if(!painter.begin(&printer))
+		{
+			return QObject::tr("The PDF could not be written.");
+		}
+		scene->render(&painter);
+		painter.end();
+		break;
+	}
+	}
+
+	return QString();
+}
+
+}  // namespace dbuilder
@@ -0,0 +1,39 @@
+#pragma once
+/**
+ * @file   SceneExport.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QString>
+#include <boost/optional.hpp>
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+
+enum class ExportFormat
+{
+	Svg,
+	Png,
+	Pdf
+};
+
+/**
+ * @return the format named by a file suffix such as "svg", in any case
+ */
+boost::optional<ExportFormat> exportFormatForName(const QString &name);
+
+/// @return the file suffix for format, without the dot
+QString exportFormatSuffix(ExportFormat format);
+
+/**
+ * Renders the scene rect of scene in print mode into a new file at path.
+ * Needs no view or window. Raster formats are drawn at scale pixels per
+ * scene unit on white.
+ *
+ * @return a description of the failure, or a null string on success
+ */
+QString exportScene(DiagramScene *scene, const QString &path, ExportFormat format, qreal scale=1);
+
+}  // namespace dbuilder
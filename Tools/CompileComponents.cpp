@@ -0,0 +1,219 @@
+/**
+ * @file   CompileComponents.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ *
+ * Build tool: compiles a component file such as components.info into C++
+ * tables for Components/BuiltinComponents.hpp, so the built-in kinds are
+ * registered without reading or parsing anything at startup.
+ *
+ * Usage: dbuilder-compile-components INPUT OUTPUT
+ *
+ * Abstract components are flattened into the components that extend them,
+ * the same way ComponentFile::component() does at run time. Built without
+ * Qt, as it runs before the application is built.
+ */
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/info_parser.hpp>
+#include <boost/optional.hpp>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace {
+
+namespace pt = boost::property_tree;
+
+struct Component
+{
+	std::string name;
+	std::string svgFile;
+	std::string svgData;
+	bool hasSvgData;
+	/// as written, so the tables hold exactly the same values
+	std::vector<std::pair<std::string, std::string>> ports;
+};
+
+/// @return str as a C++ string literal
+std::string literal(const std::string &str)
+{
+	std::ostringstream os;
+	os << '"';
+	for(unsigned char c : str)
+	{
+		switch(c)
+		{
+		case '"':  os << "\\\""; break;
+		case '\\': os << "\\\\"; break;
+		case '\n': os << "\\n"; break;
+		case '\r': os << "\\r"; break;
+		case '\t': os << "\\t"; break;
+		default:
+			if(c < 0x20 || c >= 0x7f)
+			{
+				// octal, so a following digit cannot extend the escape
+				os << '\\' << char('0' + (c >> 6)) << char('0' + ((c >> 3) & 7)) << char('0' + (c & 7));
+			}
+			else
+			{
+				os << c;
+			}
+		}
+	}
+	os << '"';
+	return os.str();
+}
+
+/// @return whether all of token reads as a double, and so is a valid C++ literal
+bool isNumber(const std::string &token)
+{
+	std::istringstream ss(token);
+	double value;
+	return (ss >> value) && ss.peek() == std::char_traits<char>::eof()
+		&& token.find_first_of("xXpP") == std::string::npos;
+}
+
+Component compile(const pt::ptree &file, const pt::ptree &entry)
+{
+	pt::ptree subtree = entry;
+
+	if(auto extends = subtree.get_optional<std::string>("extends"))
+	{
+		boost::optional<const pt::ptree &> abstract;
+		auto range = file.equal_range("abstract");
+		for(auto it = range.first; it != range.second && !abstract; ++it)
+		{
+			if(it->second.get_value<std::string>() == *extends)
+			{
+				abstract = it->second;
+			}
+		}
+
+		if(!abstract)
+		{
+			throw std::runtime_error("no such abstract component: " + *extends);
+		}
+
+		for(const auto &kv : *abstract)
+		{
+			if(!subtree.count(kv.first))
+			{
+				subtree.put_child(kv.first, kv.second);
+			}
+		}
+	}
+
+	Component result;
+	result.name = subtree.get_value<std::string>();
+	result.svgFile = subtree.get("svg-file", std::string());
+	auto svgData = subtree.get_optional<std::string>("svg-data");
+	result.hasSvgData = bool(svgData);
+	result.svgData = svgData.get_value_or(std::string());
+	if(result.svgFile.empty() == !result.hasSvgData)
+	{
+		throw std::runtime_error("component " + result.name + " needs exactly one of svg-file and svg-data");
+	}
+
+	static const pt::ptree NoPorts;
+	for(const auto &port : subtree.get_child("ports", NoPorts))
+	{
+		std::istringstream ss(port.second.get_value<std::string>());
+		std::string x, y, rest;
+		if(!(ss >> x >> y) || (ss >> rest) || !isNumber(x) || !isNumber(y))
+		{
+			throw std::runtime_error("component " + result.name + " has a malformed port: " + port.second.data());
+		}
+		result.ports.push_back({x, y});
+	}
+	return result;
+}
+
+void write(std::ostream &os, const std::string &input, const std::vector<Component> &components)
+{
+	os << "// Generated from " << input << " by dbuilder-compile-components. Do not edit.\n\n";
+	os << "#include \"Components/BuiltinComponents.hpp\"\n\n";
+	os << "namespace dbuilder {\n\nnamespace {\n\n";
+
+	for(size_t i = 0; i < components.size(); ++i)
+	{
+		if(components[i].ports.empty()) continue;
+		os << "const BuiltinPort ports" << i << "[] = {";
+		const char *sep = "";
+		for(const auto &port : components[i].ports)
+		{
+			os << sep << "{" << port.first << ", " << port.second << "}";
+			sep = ", ";
+		}
+		os << "};\n";
+	}
+
+	os << "\n}  // namespace\n\n";
+	os << "extern const BuiltinComponent BuiltinComponents[] = {\n";
+	for(size_t i = 0; i < components.size(); ++i)
+	{
+		const auto &c = components[i];
+		os << "\t{" << literal(c.name) << ", "
+		   << (c.hasSvgData? "nullptr" : literal(c.svgFile)) << ", "
+		   << (c.hasSvgData? literal(c.svgData) : "nullptr") << ", ";
+		if(c.ports.empty())
+		{
+			os << "nullptr, 0";
+		}
+		else
+		{
+			os << "ports" << i << ", " << c.ports.size();
+		}
+		os << "},\n";
+	}
+	if(components.empty())
+	{
+		os << "\t{nullptr, nullptr, nullptr, nullptr, 0}\n";
+	}
+	os << "};\n\n";
+	os << "extern const int BuiltinComponentCount = " << components.size() << ";\n\n";
+	os << "}  // namespace dbuilder\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+	if(argc != 3)
+	{
+		std::cerr << "Usage: " << argv[0] << " INPUT OUTPUT\n";
+		return 2;
+	}
+
+	std::vector<Component> components;
+	try
+	{
+		pt::ptree file;
+		pt::info_parser::read_info(argv[1], file);
+		for(const auto &kv : file)
+		{
+			if(kv.first == "component")
+			{
+				components.push_back(compile(file, kv.second));
+			}
+		}
+	}
+	catch(const std::exception &exc)
+	{
+		std::cerr << argv[1] << ": " << exc.what() << std::endl;
+		return 1;
+	}
+
+	std::ofstream out(argv[2], std::ios::binary);
+	write(out, argv[1], components);
+	if(!out.flush())
+	{
+		std::cerr << argv[2] << ": cannot write" << std::endl;
+		return 1;
+	}
+	return 0;
+}
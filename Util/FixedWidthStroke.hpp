@@ -30,4 +30,21 @@ inline QString makeFixedWidthStrokeWithData(const QString &data)
 	return doc.toString();
 }
 
+/**
+ * Like makeFixedWidthStrokeWithData(), but sets error to the parse error
+ * if data is not well-formed.
+ */
+inline QByteArray makeFixedWidthStrokeWithData(const QByteArray &data, QString &error)
+{
+	QDomDocument doc;
+	QString message;
+	int line = 0;
+	if(!doc.setContent(data, &message, &line))
+	{
+		error = QString("line %1: %2").arg(line).arg(message);
+	}
+	doc.documentElement().setAttribute("vector-effect", "non-scaling-stroke");
+	return doc.toByteArray();
+}
+
 } // namespace dbuilder
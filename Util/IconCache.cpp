@@ -0,0 +1,68 @@
+/**
+ * @file   IconCache.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include "IconCache.hpp"
+#include <QDir>
+#include <QFile>
+#include <QCryptographicHash>
+#include <QUuid>
+#include "Util/Log.hpp"
+
+namespace dbuilder {
+
+const int IconCache::Version;
+
+IconCache::IconCache(const QString &dir)
+: _dir(dir)
+{
+}
+
+QString IconCache::path(const QByteArray &source, const QSize &size) const
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(source);
+	return QString("%1/%2-%3x%4-v%5.png")
+		.arg(_dir)
+		.arg(QString::fromAscii(hash.result().toHex()))
+		.arg(size.width())
+		.arg(size.height())
+		.arg(Version);
+}
+
+QImage IconCache::find(const QByteArray &source, const QSize &size) const
+{
+	QImage result;
+	const auto file = path(source, size);
+	if(QFile::exists(file) && (!result.load(file, "PNG") || result.size() != size))
+	{
+		DBWarning("Ignoring damaged cached icon ", file);
+		return QImage();
+	}
+	return result;
+}
+
+void IconCache::insert(const QByteArray &source, const QImage &image)
+{
+	const auto file = path(source, image.size());
+
+	// written under a unique name and renamed, so no reader sees half an icon
+	const auto temp = _dir + "/" + QUuid::createUuid().toString() + ".tmp";
+	if(!QDir().mkpath(_dir) || !image.save(temp, "PNG"))
+	{
+		DBWarning("Cannot cache icon in ", _dir);
+		QFile::remove(temp);
+		return;
+	}
+
+	QFile::remove(file);
+	if(!QFile::rename(temp, file))
+	{
+		QFile::remove(temp);
+	}
+}
+
+}  // namespace dbuilder
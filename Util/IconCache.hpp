@@ -0,0 +1,51 @@
+#pragma once
+/**
+ * @file   IconCache.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QSize>
+
+namespace dbuilder {
+
+/**
+ * Icons rendered in earlier runs, kept as PNG files named by the SHA-1 of
+ * what they were rendered from and their size. Safe to use from several
+ * threads and several processes at once.
+ */
+class IconCache
+{
+	QString _dir;
+
+	QString path(const QByteArray &source, const QSize &size) const;
+public:
+	/// Changes the name of every icon, for when rendering changes.
+	static const int Version = 1;
+
+	/**
+	 * @param dir  where the icons are kept; made when the first is inserted
+	 */
+	IconCache(const QString &dir);
+
+	const QString &directory() const
+	{
+		return _dir;
+	}
+
+	/**
+	 * @return the icon rendered from source at size, or a null image
+	 */
+	QImage find(const QByteArray &source, const QSize &size) const;
+
+	/**
+	 * Keeps image as the icon rendered from source at its size.
+	 */
+	void insert(const QByteArray &source, const QImage &image);
+};
+
+}  // namespace dbuilder
@@ -0,0 +1,82 @@
+/**
+ * @file   TestComponentLoading.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+#include "Main/Application.hpp"
+#include "DiagramContext.hpp"
+#include "DiagramComponent.hpp"
+#include "Util/IconCache.hpp"
+#include "Util/Log.hpp"
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <iomanip>
+#include <memory>
+
+namespace dbuilder {
+
+/**
+ * Measures what startup costs with the configured libraries: indexing the
+ * component files and building the registry, creating every kind, and
+ * drawing every toolbox icon. A second context, as for a second window, then
+ * shares the registry and should cost next to nothing.
+ *
+ * Usage: DiagramBuilder2 [--cold]
+ *
+ * With --cold the icon cache is emptied first.
+ */
+int componentLoadingTest(int argc, char **argv)
+{
+	QApplication qapp(argc, argv);
+	log::setLevel(log::Info);
+
+	QElapsedTimer timer;
+	timer.start();
+	Application app;
+	const double appMs = timer.nsecsElapsed() / 1e6;
+
+	if(qapp.arguments().contains("--cold"))
+	{
+		QDir dir(app.iconCache()->directory());
+		for(const auto &entry : dir.entryList({"*.png"}, QDir::Files))
+		{
+			dir.remove(entry);
+		}
+	}
+
+	DBInfo(std::setw(10), "context", std::setw(8), "kinds",
+	       std::setw(14), "context ms", std::setw(14), "create ms", std::setw(14), "icons ms");
+	for(int run = 0; run < 2; ++run)
+	{
+		timer.restart();
+		std::unique_ptr<DiagramContext> ctx(app.createContext());
+		const double contextMs = timer.nsecsElapsed() / 1e6;
+
+		const auto names = ctx->kindNames();
+		timer.restart();
+		for(const auto &name : names)
+		{
+			ctx->findKind(name);
+		}
+		const double createMs = timer.nsecsElapsed() / 1e6;
+
+		timer.restart();
+		for(auto kind : ctx->kinds())
+		{
+			kind->icon().pixmap(32, 32);
+		}
+		const double iconMs = timer.nsecsElapsed() / 1e6;
+
+		DBInfo(std::setw(10), run == 0? "first" : "second", std::setw(8), names.size(),
+		       std::setw(14), contextMs, std::setw(14), createMs, std::setw(14), iconMs);
+	}
+	DBInfo("Application constructed in ", appMs, " ms");
+
+	return 0;
+}
+
+//namespace { Application::ReplaceMain r{componentLoadingTest}; }
+
+}  // namespace dbuilder
@@ -0,0 +1,141 @@
+/**
+ * @file   TestCompression.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+#include "DiagramIO/CompressedStream.hpp"
+#include "Main/Application.hpp"
+#include "Util/Log.hpp"
+#include <QUuid>
+#include <QElapsedTimer>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+namespace dbuilder {
+
+namespace {
+
+/// INFO text shaped like a saved drawing: resistors, and connectors between
+/// them, with a paragraph of text on every tenth item.
+std::string generateDocument(int items)
+{
+	std::ostringstream os;
+	std::vector<std::string> uuids;
+	for(int i = 0; i < items; ++i)
+	{
+		uuids.push_back("QUuid(" + QUuid::createUuid().toString().toStdString() + ")");
+		bool connector = i >= 2 && i % 2 == 0;
+
+		os << uuids.back() << "\n{\n";
+		os << "    kind " << (connector? "Connector" : "Resistor") << "\n";
+		os << "    scenePosX " << (i % 100) * 40 << "\n";
+		os << "    scenePosY " << (i / 100) * 40.5 << "\n";
+		os << "    rotation 0\n";
+		os << "    sceneZ 0\n";
+		os << "    dependencies";
+		if(connector)
+		{
+			os << "\n    {\n";
+			os << "        0 \"" << uuids[i - 2] << "\"\n";
+			os << "        1 \"" << uuids[i - 1] << "\"\n";
+			os << "    }\n";
+		}
+		else
+		{
+			os << " \"\"\n";
+		}
+		os << "    extraData\n    {\n";
+		os << "        label R" << i << "\n";
+		if(i % 10 == 0)
+		{
+			os << "        text \"Item " << i << " is part of the input stage and is"
+			      " rated for the full supply voltage.\"\n";
+		}
+		if(connector)
+		{
+			os << "        connection\n        {\n";
+			os << "            src \"" << uuids[i - 2] << "\"\n";
+			os << "            dst \"" << uuids[i - 1] << "\"\n";
+			os << "            srcPort 0\n";
+			os << "            dstPort 1\n";
+			os << "            center 0.5\n";
+			os << "        }\n";
+		}
+		os << "    }\n}\n";
+	}
+	return os.str();
+}
+
+}  // namespace
+
+/**
+ * Measures the size and speed of the compressed container for a clipboard
+ * sized selection and for whole documents, at several block sizes and zlib
+ * levels, and checks that every stream reads back unchanged.
+ *
+ * Usage: DiagramBuilder2 [repetitions]
+ */
+int compressionTest(int argc, char **argv)
+{
+	log::setLevel(log::Debug);
+	const int reps = argc > 1? std::max(1, atoi(argv[1])) : 3;
+
+	DBInfo(std::setw(8), "items", std::setw(10), "block KiB", std::setw(6), "level",
+	       std::setw(10), "MiB", std::setw(10), "ratio",
+	       std::setw(14), "write MiB/s", std::setw(14), "read MiB/s");
+	for(int n : {100, 10000, 100000})
+	{
+		const auto doc = generateDocument(n);
+		const double mib = doc.size() / (1024.0 * 1024.0);
+
+		for(std::size_t blockSize : {std::size_t(64 << 10), compressed::DefaultBlockSize, std::size_t(1 << 20)})
+		{
+			for(int level : {1, -1, 9})
+			{
+				double writeMs = 0, readMs = 0;
+				std::size_t packedSize = 0;
+				bool same = true;
+				QElapsedTimer timer;
+				for(int r = 0; r < reps; ++r)
+				{
+					timer.start();
+					std::ostringstream os;
+					{
+						CompressingStreamBuf compressor(os, level, blockSize);
+						std::ostream out(&compressor);
+						out.write(doc.data(), doc.size());
+					}
+					const auto packed = os.str();
+					writeMs += timer.nsecsElapsed() / 1e6;
+
+					timer.restart();
+					const auto unpacked = compressed::decompress(packed.data(), packed.size());
+					readMs += timer.nsecsElapsed() / 1e6;
+
+					packedSize = packed.size();
+					same = same && std::size_t(unpacked.size()) == doc.size()
+						&& std::equal(doc.begin(), doc.end(), unpacked.constData());
+				}
+
+				DBInfo(std::setw(8), n,
+				       std::setw(10), blockSize >> 10,
+				       std::setw(6), level,
+				       std::setw(10), mib,
+				       std::setw(10), double(doc.size()) / packedSize,
+				       std::setw(14), mib / (writeMs / reps / 1000),
+				       std::setw(14), mib / (readMs / reps / 1000),
+				       same? "" : "  (RESULTS DIFFER)");
+			}
+		}
+	}
+
+	return 0;
+}
+
+//namespace { Application::ReplaceMain r{compressionTest}; }
+
+}  // namespace dbuilder
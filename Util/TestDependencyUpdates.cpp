@@ -0,0 +1,72 @@
+/**
+ * @file   TestDependencyUpdates.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+#include "Main/Application.hpp"
+#include "DiagramContext.hpp"
+#include "DiagramComponent.hpp"
+#include "DiagramItem.hpp"
+#include "DiagramItemModel.hpp"
+#include "DiagramScene.hpp"
+#include "Util/Log.hpp"
+#include <QApplication>
+#include <memory>
+
+namespace dbuilder {
+
+/**
+ * Builds a chain of three boxes, each depending on the one before it, moves
+ * the first two several times within one event, and checks that the scene
+ * coalesced the updates of their dependents into one each.
+ *
+ * Usage: DiagramBuilder2
+ */
+int dependencyUpdatesTest(int argc, char **argv)
+{
+	QApplication qapp(argc, argv);
+	log::setLevel(log::Info);
+	Application app;
+	std::unique_ptr<DiagramContext> ctx(app.createContext());
+	DiagramScene scene(ctx.get());
+
+	DiagramItem *chain[3];
+	for(int i = 0; i < 3; ++i)
+	{
+		chain[i] = ctx->kind("box")->create(&scene);
+		if(i > 0)
+		{
+			chain[i]->model()->addDependency(chain[i - 1]->model()->uuid());
+		}
+		scene.addDiagramItem(chain[i]);
+	}
+	scene.flushDependencyUpdates();
+
+	const quint64 requestedBefore = scene.dependencyUpdatesRequested();
+	const quint64 performedBefore = scene.dependencyUpdatesPerformed();
+
+	const int moves = 5;
+	for(int i = 1; i <= moves; ++i)
+	{
+		chain[0]->setPos(10 * i, 0);
+		chain[1]->setPos(10 * i, 50);
+	}
+	qapp.processEvents();
+
+	const quint64 requested = scene.dependencyUpdatesRequested() - requestedBefore;
+	const quint64 performed = scene.dependencyUpdatesPerformed() - performedBefore;
+	DBInfo("Dependency updates: ", performed, " performed of ", requested, " requested");
+
+	if(requested != quint64(2 * moves) || performed != 2)
+	{
+		DBError("FAIL: expected 2 of ", 2 * moves);
+		return 1;
+	}
+	DBInfo("PASS");
+	return 0;
+}
+
+//namespace { Application::ReplaceMain r{dependencyUpdatesTest}; }
+
+}  // namespace dbuilder
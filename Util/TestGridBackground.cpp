@@ -0,0 +1,86 @@
+/**
+ * @file   TestGridBackground.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+#include "Main/Application.hpp"
+#include "GridBackground.hpp"
+#include "Util/Log.hpp"
+#include <QApplication>
+#include <QImage>
+#include <QPainter>
+#include <QElapsedTimer>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <iomanip>
+
+namespace dbuilder {
+
+namespace {
+
+/// the grid as DiagramScene drew it before GridBackground
+void drawLineGrid(QPainter *painter, const QRectF &rect)
+{
+	qreal gridInterval = 5;
+	painter->setPen(QColor(230, 230, 255));
+	for(qreal x = round(rect.left() / gridInterval) * gridInterval; x < rect.right(); x += gridInterval)
+	{
+		painter->drawLine(x, rect.top(), x, rect.bottom());
+	}
+
+	for(qreal y = round(rect.top() / gridInterval) * gridInterval; y < rect.bottom(); y += gridInterval)
+	{
+		painter->drawLine(rect.left(), y, rect.right(), y);
+	}
+}
+
+template <typename Draw>
+double msPerFrame(QImage &target, qreal scale, int frames, Draw draw)
+{
+	QElapsedTimer timer;
+	timer.start();
+	for(int i = 0; i < frames; ++i)
+	{
+		QPainter painter(&target);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.fillRect(target.rect(), Qt::white);
+		painter.scale(scale, scale);
+		draw(&painter, painter.worldTransform().inverted().mapRect(QRectF(target.rect())));
+	}
+	return timer.nsecsElapsed() / 1e6 / frames;
+}
+
+}  // namespace
+
+/**
+ * Times drawing the background of a 1600x1000 view at several zoom levels,
+ * with the old line-per-interval grid and with GridBackground.
+ *
+ * Usage: DiagramBuilder2 [frames]
+ */
+int gridBackgroundTest(int argc, char **argv)
+{
+	QApplication qapp(argc, argv);
+	log::setLevel(log::Info);
+
+	const int frames = argc > 1? std::max(1, atoi(argv[1])) : 20;
+	QImage target(1600, 1000, QImage::Format_ARGB32_Premultiplied);
+	GridBackground grid;
+
+	DBInfo(std::setw(8), "scale", std::setw(14), "lines ms", std::setw(14), "tile ms");
+	for(qreal scale : {0.1, 0.25, 0.5, 1.0, 2.0, 4.0})
+	{
+		const double linesMs = msPerFrame(target, scale, frames, drawLineGrid);
+		const double tileMs = msPerFrame(target, scale, frames,
+			[&](QPainter *painter, const QRectF &rect) { grid.draw(painter, rect); });
+		DBInfo(std::setw(8), scale, std::setw(14), linesMs, std::setw(14), tileMs);
+	}
+
+	return 0;
+}
+
+//namespace { Application::ReplaceMain r{gridBackgroundTest}; }
+
+}  // namespace dbuilder
@@ -0,0 +1,147 @@
+/**
+ * @file   TestInfoReader.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+#include "DiagramIO/InfoReader.hpp"
+#include "DiagramIO/DiagramItemRecord.hpp"
+#include "Main/Application.hpp"
+#include "Util/Log.hpp"
+#include <QUuid>
+#include <QElapsedTimer>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/info_parser.hpp>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+namespace dbuilder {
+
+namespace {
+
+/// A document shaped like InfoDiagramLoader's output: every other item is a
+/// connector depending on the two items before it.
+std::string generateDocument(int items)
+{
+	std::ostringstream os;
+	std::vector<std::string> uuids;
+	for(int i = 0; i < items; ++i)
+	{
+		uuids.push_back("QUuid(" + QUuid::createUuid().toString().toStdString() + ")");
+		bool connector = i >= 2 && i % 2 == 0;
+
+		os << uuids.back() << "\n{\n";
+		os << "    kind " << (connector? "Connector" : "Resistor") << "\n";
+		os << "    scenePosX " << (i % 100) * 40 << "\n";
+		os << "    scenePosY " << (i / 100) * 40.5 << "\n";
+		os << "    rotation 90\n";
+		os << "    sceneZ 0\n";
+		os << "    dependencies";
+		if(connector)
+		{
+			os << "\n    {\n";
+			os << "        0 \"" << uuids[i - 2] << "\"\n";
+			os << "        1 \"" << uuids[i - 1] << "\"\n";
+			os << "    }\n";
+		}
+		else
+		{
+			os << " \"\"\n";
+		}
+		os << "    extraData\n    {\n";
+		os << "        label \"R" << i << " \\\"main\\\"\"\n";
+		if(connector)
+		{
+			os << "        lineThickness 2\n";
+			os << "        connection\n        {\n";
+			os << "            src \"" << uuids[i - 2] << "\"\n";
+			os << "            dst \"" << uuids[i - 1] << "\"\n";
+			os << "            srcPort 0\n";
+			os << "            dstPort 1\n";
+			os << "        }\n";
+		}
+		os << "    }\n}\n";
+	}
+	return os.str();
+}
+
+}  // namespace
+
+/**
+ * Compares boost's read_info() with InfoReader, building a ptree and
+ * building DiagramItemRecords serially, in parallel and with extraData left
+ * raw, on generated documents. Also checks that all of them read the same thing.
+ *
+ * Usage: DiagramBuilder2 [repetitions]
+ */
+int infoReaderTest(int argc, char **argv)
+{
+	log::setLevel(log::Debug);
+	const int reps = argc > 1? std::max(1, atoi(argv[1])) : 3;
+
+	DBInfo(std::setw(8), "items", std::setw(12), "MiB",
+	       std::setw(14), "read_info ms", std::setw(14), "readInfo ms", std::setw(14), "records ms",
+	       std::setw(14), "parallel ms", std::setw(14), "lazy ms");
+	for(int n : {10000, 100000})
+	{
+		auto doc = generateDocument(n);
+		// doc outlives the records
+		BufferOwner owner(doc.data(), [](const void *) { });
+
+		double boostMs = 0, readerMs = 0, recordMs = 0, parallelMs = 0, lazyMs = 0;
+		std::size_t count = 0, parallelCount = 0, lazyCount = 0;
+		bool same = true;
+		QElapsedTimer timer;
+		for(int r = 0; r < reps; ++r)
+		{
+			boost::property_tree::ptree expected, actual;
+
+			timer.start();
+			std::istringstream is(doc);
+			boost::property_tree::read_info(is, expected);
+			boostMs += timer.nsecsElapsed() / 1e6;
+
+			timer.restart();
+			readInfo(doc.data(), doc.data() + doc.size(), actual);
+			readerMs += timer.nsecsElapsed() / 1e6;
+
+			timer.restart();
+			readDiagramItemRecords(doc.data(), doc.data() + doc.size(), [&](DiagramItemRecord &record) {
+				count += record.dependencies.size() + 1;
+			});
+			recordMs += timer.nsecsElapsed() / 1e6;
+
+			timer.restart();
+			readDiagramItemRecordsParallel(doc.data(), doc.data() + doc.size(), [&](DiagramItemRecord &record) {
+				parallelCount += record.dependencies.size() + 1;
+			});
+			parallelMs += timer.nsecsElapsed() / 1e6;
+
+			timer.restart();
+			readDiagramItemRecordsParallel(doc.data(), doc.data() + doc.size(), [&](DiagramItemRecord &record) {
+				lazyCount += record.dependencies.size() + 1;
+			}, owner);
+			lazyMs += timer.nsecsElapsed() / 1e6;
+
+			same = same && expected == actual && count == parallelCount && count == lazyCount;
+		}
+
+		DBInfo(std::setw(8), n,
+		       std::setw(12), doc.size() / (1024.0 * 1024.0),
+		       std::setw(14), boostMs / reps,
+		       std::setw(14), readerMs / reps,
+		       std::setw(14), recordMs / reps,
+		       std::setw(14), parallelMs / reps,
+		       std::setw(14), lazyMs / reps,
+		       "  (", count, " records+deps", same? "" : ", RESULTS DIFFER", ")");
+	}
+
+	return 0;
+}
+
+//namespace { Application::ReplaceMain r{infoReaderTest}; }
+
+}  // namespace dbuilder
@@ -0,0 +1,79 @@
+/**
+ * @file   TestUUIDIndex.cpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+#include "UUIDIndex.hpp"
+#include "Main/Application.hpp"
+#include "Util/Log.hpp"
+#include <QMap>
+#include <QElapsedTimer>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cstdlib>
+#include "CoreForward.hpp"
+
+namespace dbuilder {
+
+/**
+ * Compares item lookup by QMap<QUuid, T> (the former DiagramScene index),
+ * UUIDIndex, and by dense handle.
+ *
+ * Usage: DiagramBuilder2 [lookups]
+ */
+int uuidIndexTest(int argc, char **argv)
+{
+	log::setLevel(log::Debug);
+	const int lookups = argc > 1? std::max(1, atoi(argv[1])) : 1000000;
+	std::mt19937 rng(42);
+
+	DBInfo(std::setw(8), "items", std::setw(14), "QMap ns", std::setw(14), "UUIDIndex ns", std::setw(14), "handle ns");
+	for(int n : {1000, 10000, 100000})
+	{
+		std::vector<QUuid> uuids;
+		QMap<QUuid, ItemHandle> map;
+		UUIDIndex index;
+		std::vector<ItemHandle> items;
+		for(int i = 0; i < n; ++i)
+		{
+			uuids.push_back(QUuid::createUuid());
+			map.insert(uuids.back(), i);
+			index.insert(uuids.back(), i);
+			items.push_back(i);
+		}
+
+		std::vector<int> order(lookups);
+		std::uniform_int_distribution<int> pick(0, n - 1);
+		for(auto &o : order) o = pick(rng);
+
+		ItemHandle checksum = 0;
+		QElapsedTimer timer;
+
+		timer.start();
+		for(int o : order) checksum += map.value(uuids[o]);
+		double mapNs = double(timer.nsecsElapsed()) / lookups;
+
+		timer.restart();
+		for(int o : order) checksum += index.find(uuids[o]);
+		double indexNs = double(timer.nsecsElapsed()) / lookups;
+
+		timer.restart();
+		for(int o : order) checksum += items[o];
+		double handleNs = double(timer.nsecsElapsed()) / lookups;
+
+		DBInfo(std::setw(8), n,
+		       std::setw(14), mapNs,
+		       std::setw(14), indexNs,
+		       std::setw(14), handleNs,
+		       "  (checksum ", checksum, ")");
+	}
+
+	return 0;
+}
+
+//namespace { Application::ReplaceMain r{uuidIndexTest}; }
+
+}  // namespace dbuilder
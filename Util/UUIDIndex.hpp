@@ -0,0 +1,203 @@
+#pragma once
+#include <QUuid>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+/**
+ * @file   UUIDIndex.hpp
+ *
+ * @date   Oct 17, 2026
+ * @author Sam Roth <>
+ */
+
+namespace dbuilder {
+
+/**
+ * A flat open-addressing hash table from QUuid to a 32-bit value.
+ *
+ * Uses linear probing over a power-of-two table with tombstones. Lookups
+ * touch one contiguous array and compare at most a few keys, unlike
+ * QMap<QUuid, T>, which walks a red-black tree of 128-bit comparisons.
+ */
+class UUIDIndex
+{
+public:
+	typedef std::uint32_t value_type;
+	static const value_type NotFound = 0xffffffffu;
+
+private:
+	enum State: std::uint8_t { Empty, Occupied, Deleted };
+
+	struct Entry
+	{
+		QUuid key;
+		value_type value;
+		State state;
+
+		Entry()
+		: value(NotFound)
+		, state(Empty)
+		{ }
+	};
+
+	std::vector<Entry> _entries;
+	size_t _size;
+	size_t _used; // occupied + deleted
+
+	static std::uint32_t hash(const QUuid &uuid)
+	{
+		std::uint32_t words[4];
+		words[0] = uuid.data1;
+		words[1] = std::uint32_t(uuid.data2) << 16 | uuid.data3;
+		std::memcpy(&words[2], uuid.data4, 8);
+
+		// murmur3 finalizer over the xor-folded words
+		std::uint32_t h = words[0] ^ words[1] * 0x9e3779b9u ^ words[2] * 0x85ebca6bu ^ words[3];
+		h ^= h >> 16;
+		h *= 0x85ebca6bu;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	size_t mask() const
+	{
+		return _entries.size() - 1;
+	}
+
+	/**
+	 * @return the index of the entry holding key, or of the slot where it
+	 * should be inserted (the first tombstone along the probe sequence, if any)
+	 */
+	size_t probe(const QUuid &key, bool &found) const
+	{
+		size_t i = hash(key) & mask();
+		size_t firstDeleted = size_t(-1);
+		for(;;)
+		{
+			const Entry &e = _entries[i];
+			if(e.state == Empty)
+			{
+				found = false;
+				return firstDeleted != size_t(-1)? firstDeleted : i;
+			}
+			else if(e.state == Deleted)
+			{
+				if(firstDeleted == size_t(-1)) firstDeleted = i;
+			}
+			else if(e.key == key)
+			{
+				found = true;
+				return i;
+			}
+
+			i = (i + 1) & mask();
+		}
+	}
+
+	void rehash(size_t capacity)
+	{
+		std::vector<Entry> old;
+		old.swap(_entries);
+		_entries.resize(capacity);
+		_size = _used = 0;
+		for(const Entry &e : old)
+		{
+			if(e.state == Occupied)
+			{
+				insert(e.key, e.value);
+			}
+		}
+	}
+
+public:
+	UUIDIndex()
+	: _entries(16)
+	, _size(0)
+	, _used(0)
+	{ }
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return _size == 0;
+	}
+
+	void clear()
+	{
+		std::vector<Entry>(16).swap(_entries);
+		_size = _used = 0;
+	}
+
+	void reserve(size_t n)
+	{
+		size_t capacity = _entries.size();
+		while(capacity * 3 < n * 4 + 4) capacity *= 2;
+		if(capacity != _entries.size())
+		{
+			rehash(capacity);
+		}
+	}
+
+	/**
+	 * Inserts or replaces the value associated with key.
+	 */
+	void insert(const QUuid &key, value_type value)
+	{
+		// keep the load factor (including tombstones) under 3/4
+		if((_used + 1) * 4 > _entries.size() * 3)
+		{
+			rehash(_size * 2 + 2 > _entries.size()? _entries.size() * 2 : _entries.size());
+		}
+
+		bool found;
+		Entry &e = _entries[probe(key, found)];
+		if(!found)
+		{
+			if(e.state == Empty) ++_used;
+			++_size;
+			e.key = key;
+			e.state = Occupied;
+		}
+		e.value = value;
+	}
+
+	/**
+	 * @return true if key was present
+	 */
+	bool remove(const QUuid &key)
+	{
+		bool found;
+		Entry &e = _entries[probe(key, found)];
+		if(found)
+		{
+			e.state = Deleted;
+			e.value = NotFound;
+			--_size;
+		}
+		return found;
+	}
+
+	/**
+	 * @return the value associated with key, or NotFound
+	 */
+	value_type find(const QUuid &key) const
+	{
+		bool found;
+		size_t i = probe(key, found);
+		return found? _entries[i].value : NotFound;
+	}
+
+	bool contains(const QUuid &key) const
+	{
+		return find(key) != NotFound;
+	}
+};
+
+}  // namespace dbuilder